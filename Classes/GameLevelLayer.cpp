@@ -49,6 +49,8 @@ bool GameLevelLayer::init()
     _eventDispatcher->addEventListenerWithSceneGraphPriority(touchListener, this);
     
     // Autio
+    CocosDenshion::SimpleAudioEngine::getInstance()->preloadEffect("jump.wav");
+    CocosDenshion::SimpleAudioEngine::getInstance()->preloadEffect("hurt.wav");
     CocosDenshion::SimpleAudioEngine::getInstance()->playBackgroundMusic("level1.mp3");
     
     // Run update
@@ -37,6 +37,9 @@ DEPENDS+=' libsqlite3-dev'
 DEPENDS+=' libglew-dev'
 DEPENDS+=' libssl-dev'
 DEPENDS+=' libgtk-3-dev'
+DEPENDS+=' libasound2-dev'
+DEPENDS+=' libvorbis-dev'
+DEPENDS+=' libmpg123-dev'
 DEPENDS+=' binutils'
 
 MISSING=
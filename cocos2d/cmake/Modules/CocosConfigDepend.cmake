@@ -16,6 +16,9 @@ macro(cocos2dx_depend)
         cocos_find_package(OpenGL OPENGL REQUIRED)
         cocos_find_package(CURL CURL REQUIRED)
         cocos_find_package(SQLite3 SQLITE3 REQUIRED)
+        cocos_find_package(ALSA ALSA REQUIRED)
+        cocos_find_package(Vorbis VORBIS REQUIRED)
+        cocos_find_package(MPG123 MPG123 REQUIRED)
         set(CMAKE_THREAD_PREFER_PTHREAD TRUE)	
         find_package(Threads REQUIRED)	
         set(THREADS_LIBRARIES ${CMAKE_THREAD_LIBS_INIT})
@@ -103,6 +106,9 @@ macro(use_cocos2dx_libs_depend target)
         cocos_use_pkg(${target} CURL)
         cocos_use_pkg(${target} THREADS)
         cocos_use_pkg(${target} SQLITE3)
+        cocos_use_pkg(${target} ALSA)
+        cocos_use_pkg(${target} VORBIS)
+        cocos_use_pkg(${target} MPG123)
     endif()
 endmacro()
 
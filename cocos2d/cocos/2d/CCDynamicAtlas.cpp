@@ -0,0 +1,337 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCDynamicAtlas.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "2d/CCSpriteFrame.h"
+#include "base/CCConfiguration.h"
+#include "base/CCNinePatchImageParser.h"
+#include "base/ccMacros.h"
+#include "base/ccUTF8.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCGL.h"
+#include "platform/CCImage.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/CCTextureCache.h"
+
+NS_CC_BEGIN
+
+// transparent border around each image, filled with its edge pixels to avoid bleeding with linear filtering
+static const int PADDING = 1;
+
+static DynamicAtlas* s_sharedDynamicAtlas = nullptr;
+
+DynamicAtlas* DynamicAtlas::getInstance()
+{
+    if (!s_sharedDynamicAtlas)
+    {
+        s_sharedDynamicAtlas = new (std::nothrow) DynamicAtlas();
+    }
+    return s_sharedDynamicAtlas;
+}
+
+void DynamicAtlas::destroyInstance()
+{
+    CC_SAFE_RELEASE_NULL(s_sharedDynamicAtlas);
+}
+
+DynamicAtlas::DynamicAtlas()
+: _enabled(false)
+, _pageSize(2048)
+, _maxImageSize(256)
+{
+}
+
+DynamicAtlas::~DynamicAtlas()
+{
+    removeAllPages();
+}
+
+void DynamicAtlas::removeAllPages()
+{
+    for (auto& frame : _frames)
+    {
+        CC_SAFE_RELEASE(frame.second);
+    }
+    _frames.clear();
+
+    for (auto& page : _pages)
+    {
+        page.texture->release();
+        CC_SAFE_RELEASE(page.image);
+    }
+    _pages.clear();
+}
+
+std::string DynamicAtlas::getDescription() const
+{
+    size_t packed = 0;
+    for (auto& frame : _frames)
+    {
+        if (frame.second)
+            ++packed;
+    }
+    return StringUtils::format("<DynamicAtlas | pages = %d, packed images = %d>", static_cast<int>(_pages.size()), static_cast<int>(packed));
+}
+
+SpriteFrame* DynamicAtlas::getSpriteFrame(const std::string& filename)
+{
+    if (!_enabled)
+    {
+        return nullptr;
+    }
+
+    std::string fullpath = FileUtils::getInstance()->fullPathForFilename(filename);
+    if (fullpath.empty())
+    {
+        return nullptr;
+    }
+
+    auto it = _frames.find(fullpath);
+    if (it != _frames.end())
+    {
+        return it->second;
+    }
+
+    // remember the images which can't be packed, so they are only decoded once
+    _frames[fullpath] = nullptr;
+
+    if (NinePatchImageParser::isNinePatchImage(fullpath))
+    {
+        return nullptr;
+    }
+
+    Image image;
+    if (!image.initWithImageFile(fullpath) || image.isCompressed() || image.getNumberOfMipmaps() > 1)
+    {
+        return nullptr;
+    }
+
+    // pages are premultiplied RGBA8888
+    int bytesPerPixel = 0;
+    if (image.getRenderFormat() == Texture2D::PixelFormat::RGBA8888 && image.hasPremultipliedAlpha())
+    {
+        bytesPerPixel = 4;
+    }
+    else if (image.getRenderFormat() == Texture2D::PixelFormat::RGB888)
+    {
+        bytesPerPixel = 3;
+    }
+
+    int width = image.getWidth();
+    int height = image.getHeight();
+    if (0 == bytesPerPixel || width <= 0 || height <= 0 || width > _maxImageSize || height > _maxImageSize)
+    {
+        return nullptr;
+    }
+
+    int paddedWidth = width + 2 * PADDING;
+    int paddedHeight = height + 2 * PADDING;
+
+    int x = 0;
+    int y = 0;
+    int index = -1;
+    size_t pageIndex = 0;
+    for (; pageIndex < _pages.size(); ++pageIndex)
+    {
+        index = findPosition(_pages[pageIndex], paddedWidth, paddedHeight, &x, &y);
+        if (index >= 0)
+            break;
+    }
+
+    if (index < 0)
+    {
+        if (!addPage())
+        {
+            return nullptr;
+        }
+        pageIndex = _pages.size() - 1;
+        index = findPosition(_pages[pageIndex], paddedWidth, paddedHeight, &x, &y);
+        if (index < 0)
+        {
+            return nullptr;
+        }
+    }
+
+    Page& page = _pages[pageIndex];
+    addSkylineSegment(page, index, x, y, paddedWidth, paddedHeight);
+
+    // copy the image into the padded block, repeating the edge pixels in the padding
+    std::vector<unsigned char> block(paddedWidth * paddedHeight * 4);
+    const unsigned char* src = image.getData();
+    for (int row = 0; row < paddedHeight; ++row)
+    {
+        int srcRow = std::min(std::max(row - PADDING, 0), height - 1);
+        unsigned char* dst = block.data() + row * paddedWidth * 4;
+        for (int col = 0; col < paddedWidth; ++col)
+        {
+            int srcCol = std::min(std::max(col - PADDING, 0), width - 1);
+            const unsigned char* pixel = src + (srcRow * width + srcCol) * bytesPerPixel;
+            dst[col * 4] = pixel[0];
+            dst[col * 4 + 1] = pixel[1];
+            dst[col * 4 + 2] = pixel[2];
+            dst[col * 4 + 3] = (bytesPerPixel == 4) ? pixel[3] : 0xFF;
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    page.texture->updateWithData(block.data(), x, y, paddedWidth, paddedHeight);
+
+    if (page.image)
+    {
+        for (int row = 0; row < paddedHeight; ++row)
+        {
+            memcpy(page.image->getData() + ((y + row) * page.size + x) * 4, block.data() + row * paddedWidth * 4, paddedWidth * 4);
+        }
+    }
+
+    Rect rect(x + PADDING, y + PADDING, width, height);
+    auto frame = SpriteFrame::createWithTexture(page.texture, CC_RECT_PIXELS_TO_POINTS(rect));
+    frame->retain();
+    _frames[fullpath] = frame;
+
+    return frame;
+}
+
+bool DynamicAtlas::addPage()
+{
+    int size = std::min(_pageSize, Configuration::getInstance()->getMaxTextureSize());
+    if (size <= 0)
+    {
+        return false;
+    }
+
+    ssize_t dataLen = static_cast<ssize_t>(size) * size * 4;
+    std::vector<unsigned char> pixels(dataLen, 0);
+    auto image = new (std::nothrow) Image();
+    if (image == nullptr || !image->initWithRawData(pixels.data(), dataLen, size, size, 8, true))
+    {
+        CC_SAFE_RELEASE(image);
+        return false;
+    }
+
+    auto texture = new (std::nothrow) Texture2D();
+    if (texture == nullptr || !texture->initWithImage(image, Texture2D::PixelFormat::RGBA8888))
+    {
+        CC_SAFE_RELEASE(texture);
+        image->release();
+        return false;
+    }
+
+    Page page;
+    page.texture = texture;
+    page.size = size;
+    page.skyline.push_back({ 0, 0, size });
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+    // the texture is restored from the image, which is kept up to date
+    VolatileTextureMgr::addImage(texture, image);
+    page.image = image;
+#else
+    page.image = nullptr;
+    image->release();
+#endif
+    _pages.push_back(page);
+
+    return true;
+}
+
+int DynamicAtlas::findPosition(const Page& page, int width, int height, int* outX, int* outY) const
+{
+    // bottom-left skyline: pick the position with the lowest bottom edge, then the leftmost one
+    int bestIndex = -1;
+    int bestBottom = page.size + 1;
+    int bestX = page.size + 1;
+
+    for (size_t i = 0; i < page.skyline.size(); ++i)
+    {
+        int x = page.skyline[i].x;
+        if (x + width > page.size)
+        {
+            break;
+        }
+
+        int y = 0;
+        int widthLeft = width;
+        for (size_t j = i; widthLeft > 0; ++j)
+        {
+            y = std::max(y, page.skyline[j].y);
+            widthLeft -= page.skyline[j].width;
+        }
+
+        if (y + height <= page.size && (y + height < bestBottom || (y + height == bestBottom && x < bestX)))
+        {
+            bestIndex = static_cast<int>(i);
+            bestBottom = y + height;
+            bestX = x;
+            *outX = x;
+            *outY = y;
+        }
+    }
+
+    return bestIndex;
+}
+
+void DynamicAtlas::addSkylineSegment(Page& page, int index, int x, int y, int width, int height)
+{
+    auto& skyline = page.skyline;
+    skyline.insert(skyline.begin() + index, { x, y + height, width });
+
+    // shrink or remove the segments covered by the new one
+    for (size_t i = index + 1; i < skyline.size(); )
+    {
+        int previousEnd = skyline[i - 1].x + skyline[i - 1].width;
+        if (skyline[i].x >= previousEnd)
+        {
+            break;
+        }
+
+        int shrink = previousEnd - skyline[i].x;
+        skyline[i].x += shrink;
+        skyline[i].width -= shrink;
+        if (skyline[i].width > 0)
+        {
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+
+    // merge the neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size(); )
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+        {
+            ++i;
+        }
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,132 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CCDYNAMICATLAS_H__
+#define __CCDYNAMICATLAS_H__
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/CCRef.h"
+
+NS_CC_BEGIN
+
+class Image;
+class SpriteFrame;
+class Texture2D;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * Packs small loose images into shared texture pages at load time.
+ * Sprites created from the packed images share a texture, so the renderer can
+ * batch them into a few draw calls without an offline TexturePacker step.
+ *
+ * It is disabled by default. Once enabled, Sprite::create(filename) and
+ * SpriteFrameCache::addSpriteFrameWithFile() pack the images that fit.
+ * Packed images don't have a texture of their own, so don't enable it for images
+ * that are used with repeat wrapping, mipmaps or custom texture parameters.
+ */
+class CC_DLL DynamicAtlas : public Ref
+{
+public:
+    /** Returns the shared instance of the dynamic atlas. */
+    static DynamicAtlas* getInstance();
+
+    /** Destroys the shared instance, the pages are released once no sprite uses them. */
+    static void destroyInstance();
+
+    /** Enables or disables packing, disabled by default. */
+    void setEnabled(bool enabled) { _enabled = enabled; }
+    bool isEnabled() const { return _enabled; }
+
+    /** Sets the size in pixels of the pages created from now on, 2048 by default.
+     * It is clamped to the maximum texture size of the device.
+     */
+    void setPageSize(int pixels) { _pageSize = pixels; }
+    int getPageSize() const { return _pageSize; }
+
+    /** Sets the maximum width and height in pixels of the images to pack, 256 by default.
+     * Bigger images keep their own texture.
+     */
+    void setMaxImageSize(int pixels) { _maxImageSize = pixels; }
+    int getMaxImageSize() const { return _maxImageSize; }
+
+    /** Returns the sprite frame of an image packed into a page, packing it first if needed.
+     * @param filename The related/absolute path of the image.
+     * @return The sprite frame, or nullptr if packing is disabled or the image can't be packed.
+     */
+    SpriteFrame* getSpriteFrame(const std::string& filename);
+
+    /** Forgets all pages and packed images.
+     * Sprites already using a page keep it alive.
+     */
+    void removeAllPages();
+
+    /** Returns the number of pages and packed images, for debugging. */
+    std::string getDescription() const;
+
+CC_CONSTRUCTOR_ACCESS:
+    DynamicAtlas();
+    virtual ~DynamicAtlas();
+
+protected:
+    struct SkylineSegment
+    {
+        int x;
+        int y;
+        int width;
+    };
+
+    struct Page
+    {
+        Texture2D* texture;
+        int size;
+        std::vector<SkylineSegment> skyline;
+        // pixels of the page, kept to restore the texture when the GL context is lost
+        Image* image;
+    };
+
+    bool addPage();
+    int findPosition(const Page& page, int width, int height, int* outX, int* outY) const;
+    void addSkylineSegment(Page& page, int index, int x, int y, int width, int height);
+
+    bool _enabled;
+    int _pageSize;
+    int _maxImageSize;
+    std::vector<Page> _pages;
+    // packed frames keyed by full path, or the path of images which can't be packed with a nullptr frame
+    std::unordered_map<std::string, SpriteFrame*> _frames;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CCDYNAMICATLAS_H__
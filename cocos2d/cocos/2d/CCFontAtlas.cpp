@@ -36,9 +36,45 @@
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventType.h"
+#include "base/CCScheduler.h"
+#include "base/CCAsyncTaskPool.h"
+#include "platform/CCFileUtils.h"
 
 NS_CC_BEGIN
 
+namespace
+{
+    struct PrewarmedGlyph
+    {
+        char32_t utf32Char;
+        unsigned int charCode;
+        unsigned char* bitmap;
+        long width;
+        long height;
+        Rect rect;
+        int xAdvance;
+    };
+
+    const char FONT_ATLAS_FILE_MAGIC[4] = { 'C', 'C', 'F', 'A' };
+    const uint32_t FONT_ATLAS_FILE_VERSION = 1;
+
+    // followed by letterCount (char32, FontLetterDefinition) pairs and pageCount page bitmaps
+    struct FontAtlasFileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t letterDefinitionSize;
+        uint32_t pageWidth;
+        uint32_t pageHeight;
+        uint32_t pageDataSize;
+        uint32_t pageCount;
+        uint32_t letterCount;
+        float currentPageOrigX;
+        float currentPageOrigY;
+        int32_t currLineHeight;
+    };
+}
+
 const int FontAtlas::CacheTextureWidth = 512;
 const int FontAtlas::CacheTextureHeight = 512;
 const char* FontAtlas::CMD_PURGE_FONTATLAS = "__cc_PURGE_FONTATLAS";
@@ -53,6 +89,10 @@ FontAtlas::FontAtlas(Font &theFont)
 , _rendererRecreatedListener(nullptr)
 , _antialiasEnabled(true)
 , _currLineHeight(0)
+, _persistentCacheDirty(false)
+, _maxPageCount(0)
+, _evictionScheduled(false)
+, _lastEvictionFrame(0)
 {
     _font->retain();
 
@@ -147,6 +187,10 @@ void FontAtlas::reset()
     _currentPageOrigX = 0;
     _currentPageOrigY = 0;
     _letterDefinitions.clear();
+    _completedPageData.clear();
+    _persistentCacheDirty = true;
+    // reinit() adds the outline to the line height again
+    _lineHeight = _font->getFontMaxHeight();
     
     reinit();
 }
@@ -351,109 +395,135 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
         return false;
     }
 
-    int adjustForDistanceMap = _letterPadding / 2;
-    int adjustForExtend = _letterEdgeExtend / 2;
     long bitmapWidth;
     long bitmapHeight;
-    int glyphHeight;
     Rect tempRect;
+    int xAdvance;
+
+    float startY = _currentPageOrigY;
+
+    for (auto&& it : codeMapOfNewChar)
+    {
+        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, xAdvance);
+        addGlyph(it.first, bitmap, bitmapWidth, bitmapHeight, tempRect, xAdvance, startY);
+    }
+
+    updateTextureContent(startY);
+
+    return true;
+}
+
+void FontAtlas::addGlyph(char32_t utf32Char, unsigned char* bitmap, long bitmapWidth, long bitmapHeight,
+                         const Rect& tempRect, int xAdvance, float& startY)
+{
+    int adjustForDistanceMap = _letterPadding / 2;
+    int adjustForExtend = _letterEdgeExtend / 2;
+    int glyphHeight;
     FontLetterDefinition tempDef;
+    tempDef.xAdvance = xAdvance;
 
     auto scaleFactor = CC_CONTENT_SCALE_FACTOR();
     auto  pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
 
-    float startY = _currentPageOrigY;
-
-    for (auto&& it : codeMapOfNewChar)
+    if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
     {
-        auto bitmap = _fontFreeType->getGlyphBitmap(it.second, bitmapWidth, bitmapHeight, tempRect, tempDef.xAdvance);
-        if (bitmap && bitmapWidth > 0 && bitmapHeight > 0)
-        {
-            tempDef.validDefinition = true;
-            tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
-            tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
-            tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
-            tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
+        tempDef.validDefinition = true;
+        tempDef.width = tempRect.size.width + _letterPadding + _letterEdgeExtend;
+        tempDef.height = tempRect.size.height + _letterPadding + _letterEdgeExtend;
+        tempDef.offsetX = tempRect.origin.x - adjustForDistanceMap - adjustForExtend;
+        tempDef.offsetY = _fontAscender + tempRect.origin.y - adjustForDistanceMap - adjustForExtend;
 
-            if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+        if (_currentPageOrigX + tempDef.width > CacheTextureWidth)
+        {
+            _currentPageOrigY += _currLineHeight;
+            _currLineHeight = 0;
+            _currentPageOrigX = 0;
+            if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
             {
-                _currentPageOrigY += _currLineHeight;
-                _currLineHeight = 0;
-                _currentPageOrigX = 0;
-                if (_currentPageOrigY + _lineHeight + _letterPadding + _letterEdgeExtend >= CacheTextureHeight)
+                unsigned char *data = nullptr;
+                if (pixelFormat == Texture2D::PixelFormat::AI88)
                 {
-                    unsigned char *data = nullptr;
-                    if (pixelFormat == Texture2D::PixelFormat::AI88)
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY * 2;
-                    }
-                    else
-                    {
-                        data = _currentPageData + CacheTextureWidth * (int)startY;
-                    }
-                    _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
-                        CacheTextureWidth, CacheTextureHeight - startY);
-
-                    startY = 0.0f;
-
-                    _currentPageOrigY = 0;
-                    memset(_currentPageData, 0, _currentPageDataSize);
-                    _currentPage++;
-                    auto tex = new (std::nothrow) Texture2D;
-                    if (_antialiasEnabled)
-                    {
-                        tex->setAntiAliasTexParameters();
-                    }
-                    else
-                    {
-                        tex->setAliasTexParameters();
-                    }
-                    tex->initWithData(_currentPageData, _currentPageDataSize,
-                        pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
-                    addTexture(tex, _currentPage);
-                    tex->release();
+                    data = _currentPageData + CacheTextureWidth * (int)startY * 2;
+                }
+                else
+                {
+                    data = _currentPageData + CacheTextureWidth * (int)startY;
+                }
+                _atlasTextures[_currentPage]->updateWithData(data, 0, startY,
+                    CacheTextureWidth, CacheTextureHeight - startY);
+
+                if (!_persistentCacheFile.empty())
+                {
+                    _completedPageData.emplace_back(_currentPageData, _currentPageData + _currentPageDataSize);
+                }
+
+                startY = 0.0f;
+
+                _currentPageOrigY = 0;
+                memset(_currentPageData, 0, _currentPageDataSize);
+                _currentPage++;
+                auto tex = new (std::nothrow) Texture2D;
+                if (_antialiasEnabled)
+                {
+                    tex->setAntiAliasTexParameters();
+                }
+                else
+                {
+                    tex->setAliasTexParameters();
+                }
+                tex->initWithData(_currentPageData, _currentPageDataSize,
+                    pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+                addTexture(tex, _currentPage);
+                tex->release();
+
+                if (_maxPageCount > 0 && _currentPage >= _maxPageCount)
+                {
+                    scheduleEviction();
                 }
             }
-            glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
-            if (glyphHeight > _currLineHeight)
-            {
-                _currLineHeight = glyphHeight;
-            }
-            _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
-
-            tempDef.U = _currentPageOrigX;
-            tempDef.V = _currentPageOrigY;
-            tempDef.textureID = _currentPage;
-            _currentPageOrigX += tempDef.width + 1;
-            // take from pixels to points
-            tempDef.width = tempDef.width / scaleFactor;
-            tempDef.height = tempDef.height / scaleFactor;
-            tempDef.U = tempDef.U / scaleFactor;
-            tempDef.V = tempDef.V / scaleFactor;
         }
-        else{
-            if(bitmap)
-                delete[] bitmap;
-            if (tempDef.xAdvance)
-                tempDef.validDefinition = true;
-            else
-                tempDef.validDefinition = false;
-
-            tempDef.width = 0;
-            tempDef.height = 0;
-            tempDef.U = 0;
-            tempDef.V = 0;
-            tempDef.offsetX = 0;
-            tempDef.offsetY = 0;
-            tempDef.textureID = 0;
-            _currentPageOrigX += 1;
+        glyphHeight = static_cast<int>(bitmapHeight) + _letterPadding + _letterEdgeExtend;
+        if (glyphHeight > _currLineHeight)
+        {
+            _currLineHeight = glyphHeight;
         }
-
-        _letterDefinitions[it.first] = tempDef;
+        _fontFreeType->renderCharAt(_currentPageData, _currentPageOrigX + adjustForExtend, _currentPageOrigY + adjustForExtend, bitmap, bitmapWidth, bitmapHeight);
+
+        tempDef.U = _currentPageOrigX;
+        tempDef.V = _currentPageOrigY;
+        tempDef.textureID = _currentPage;
+        _currentPageOrigX += tempDef.width + 1;
+        // take from pixels to points
+        tempDef.width = tempDef.width / scaleFactor;
+        tempDef.height = tempDef.height / scaleFactor;
+        tempDef.U = tempDef.U / scaleFactor;
+        tempDef.V = tempDef.V / scaleFactor;
     }
+    else{
+        if(bitmap)
+            delete[] bitmap;
+        if (tempDef.xAdvance)
+            tempDef.validDefinition = true;
+        else
+            tempDef.validDefinition = false;
+
+        tempDef.width = 0;
+        tempDef.height = 0;
+        tempDef.U = 0;
+        tempDef.V = 0;
+        tempDef.offsetX = 0;
+        tempDef.offsetY = 0;
+        tempDef.textureID = 0;
+        _currentPageOrigX += 1;
+    }
+
+    _letterDefinitions[utf32Char] = tempDef;
+}
 
+void FontAtlas::updateTextureContent(float startY)
+{
     unsigned char *data = nullptr;
-    if (pixelFormat == Texture2D::PixelFormat::AI88)
+    if (_fontFreeType->getOutlineSize() > 0)
     {
         data = _currentPageData + CacheTextureWidth * (int)startY * 2;
     }
@@ -463,9 +533,273 @@ bool FontAtlas::prepareLetterDefinitions(const std::u32string& utf32Text)
     }
     _atlasTextures[_currentPage]->updateWithData(data, 0, startY, CacheTextureWidth, _currentPageOrigY - startY + _currLineHeight);
 
+    _persistentCacheDirty = true;
+}
+
+void FontAtlas::prepareLetterDefinitionsAsync(const std::u32string& utf32Text, const std::function<void()>& callback)
+{
+    std::unordered_map<unsigned int, unsigned int> codeMapOfNewChar;
+    if (_fontFreeType)
+    {
+        findNewCharacters(utf32Text, codeMapOfNewChar);
+    }
+    if (codeMapOfNewChar.empty())
+    {
+        if (callback)
+            callback();
+        return;
+    }
+
+    // a FT_Face can't be used by two threads, the worker rasterizes with its own face of the same font
+    auto font = FontFreeType::create(_fontFreeType->getFontName(), _fontFreeType->getFontSize(), GlyphCollection::DYNAMIC, nullptr,
+                                     _fontFreeType->isDistanceFieldEnabled(), _fontFreeType->getOutlineSize() / CC_CONTENT_SCALE_FACTOR());
+    if (font == nullptr)
+    {
+        prepareLetterDefinitions(utf32Text);
+        if (callback)
+            callback();
+        return;
+    }
+    font->retain();
+    this->retain();
+
+    auto glyphs = std::make_shared<std::vector<PrewarmedGlyph>>();
+    glyphs->reserve(codeMapOfNewChar.size());
+    for (auto&& it : codeMapOfNewChar)
+    {
+        PrewarmedGlyph glyph = { it.first, it.second, nullptr, 0, 0, Rect::ZERO, 0 };
+        glyphs->push_back(glyph);
+    }
+
+    AsyncTaskPool::getInstance()->enqueue(AsyncTaskPool::TaskType::TASK_OTHER, [this, font, glyphs, callback](void*) {
+        bool outline = _fontFreeType->getOutlineSize() > 0;
+        float startY = _currentPageOrigY;
+        bool added = false;
+
+        for (auto&& glyph : *glyphs)
+        {
+            // labels may have added some of the characters while the worker was busy
+            if (_letterDefinitions.find(glyph.utf32Char) != _letterDefinitions.end())
+            {
+                delete[] glyph.bitmap;
+                continue;
+            }
+
+            addGlyph(glyph.utf32Char, glyph.bitmap, glyph.width, glyph.height, glyph.rect, glyph.xAdvance, startY);
+            added = true;
+
+            // renderCharAt() deletes the outline bitmaps
+            if (!outline)
+                delete[] glyph.bitmap;
+        }
+
+        if (added)
+        {
+            updateTextureContent(startY);
+        }
+
+        font->release();
+        if (callback)
+            callback();
+        this->release();
+    }, nullptr, [font, glyphs]() {
+        bool outline = font->getOutlineSize() > 0;
+        for (auto&& glyph : *glyphs)
+        {
+            auto bitmap = font->getGlyphBitmap(glyph.charCode, glyph.width, glyph.height, glyph.rect, glyph.xAdvance);
+            if (bitmap == nullptr)
+                continue;
+
+            if (outline)
+            {
+                // already a copy owned by the caller, addGlyph() deletes it also when it is empty
+                glyph.bitmap = bitmap;
+            }
+            else if (glyph.width > 0 && glyph.height > 0)
+            {
+                // the buffer belongs to the glyph slot of the face and is overwritten by the next glyph
+                glyph.bitmap = new (std::nothrow) unsigned char[glyph.width * glyph.height];
+                memcpy(glyph.bitmap, bitmap, glyph.width * glyph.height);
+            }
+        }
+    });
+}
+
+bool FontAtlas::saveToFile(const std::string& fullPath) const
+{
+    if (_fontFreeType == nullptr)
+    {
+        return false;
+    }
+    if ((int)_completedPageData.size() != _currentPage)
+    {
+        CCLOG("FontAtlas::saveToFile: the full pages of %s were not kept", getFontName().c_str());
+        return false;
+    }
+
+    FontAtlasFileHeader header;
+    memcpy(header.magic, FONT_ATLAS_FILE_MAGIC, sizeof(header.magic));
+    header.version = FONT_ATLAS_FILE_VERSION;
+    header.letterDefinitionSize = sizeof(FontLetterDefinition);
+    header.pageWidth = CacheTextureWidth;
+    header.pageHeight = CacheTextureHeight;
+    header.pageDataSize = _currentPageDataSize;
+    header.pageCount = _currentPage + 1;
+    header.letterCount = (uint32_t)_letterDefinitions.size();
+    header.currentPageOrigX = _currentPageOrigX;
+    header.currentPageOrigY = _currentPageOrigY;
+    header.currLineHeight = _currLineHeight;
+
+    ssize_t letterSize = sizeof(uint32_t) + sizeof(FontLetterDefinition);
+    ssize_t size = sizeof(header) + header.letterCount * letterSize + header.pageCount * (ssize_t)_currentPageDataSize;
+    auto bytes = (unsigned char*)malloc(size);
+    if (bytes == nullptr)
+    {
+        return false;
+    }
+
+    auto dest = bytes;
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    for (auto&& it : _letterDefinitions)
+    {
+        uint32_t utf32Char = it.first;
+        memcpy(dest, &utf32Char, sizeof(utf32Char));
+        memcpy(dest + sizeof(utf32Char), &it.second, sizeof(FontLetterDefinition));
+        dest += letterSize;
+    }
+    for (auto&& page : _completedPageData)
+    {
+        memcpy(dest, page.data(), _currentPageDataSize);
+        dest += _currentPageDataSize;
+    }
+    memcpy(dest, _currentPageData, _currentPageDataSize);
+
+    Data data;
+    data.fastSet(bytes, size);
+
+    // write to a temporary file first so an interrupted write never leaves a truncated atlas behind
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempFile = fullPath + ".tmp";
+    if (!fileUtils->writeDataToFile(data, tempFile))
+    {
+        return false;
+    }
+    if (!fileUtils->renameFile(tempFile, fullPath))
+    {
+        fileUtils->removeFile(tempFile);
+        return false;
+    }
     return true;
 }
 
+bool FontAtlas::loadFromFile(const std::string& fullPath)
+{
+    if (_fontFreeType == nullptr)
+    {
+        return false;
+    }
+
+    Data data = FileUtils::getInstance()->getDataFromFile(fullPath);
+    FontAtlasFileHeader header;
+    if (data.getSize() < (ssize_t)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, data.getBytes(), sizeof(header));
+
+    ssize_t letterSize = sizeof(uint32_t) + sizeof(FontLetterDefinition);
+    if (memcmp(header.magic, FONT_ATLAS_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != FONT_ATLAS_FILE_VERSION
+        || header.letterDefinitionSize != sizeof(FontLetterDefinition)
+        || header.pageWidth != (uint32_t)CacheTextureWidth
+        || header.pageHeight != (uint32_t)CacheTextureHeight
+        || header.pageDataSize != (uint32_t)_currentPageDataSize
+        || header.pageCount == 0
+        || data.getSize() != (ssize_t)sizeof(header) + header.letterCount * letterSize + header.pageCount * (ssize_t)_currentPageDataSize)
+    {
+        CCLOG("FontAtlas::loadFromFile: %s is not a valid atlas of %s", fullPath.c_str(), getFontName().c_str());
+        return false;
+    }
+
+    releaseTextures();
+    _letterDefinitions.clear();
+    _completedPageData.clear();
+
+    auto src = data.getBytes() + sizeof(header);
+    for (uint32_t i = 0; i < header.letterCount; ++i)
+    {
+        uint32_t utf32Char;
+        FontLetterDefinition letterDefinition;
+        memcpy(&utf32Char, src, sizeof(utf32Char));
+        memcpy(&letterDefinition, src + sizeof(utf32Char), sizeof(FontLetterDefinition));
+        _letterDefinitions[utf32Char] = letterDefinition;
+        src += letterSize;
+    }
+
+    auto pixelFormat = _fontFreeType->getOutlineSize() > 0 ? Texture2D::PixelFormat::AI88 : Texture2D::PixelFormat::A8;
+    for (uint32_t page = 0; page < header.pageCount; ++page)
+    {
+        if (page + 1 < header.pageCount)
+        {
+            _completedPageData.emplace_back(src, src + _currentPageDataSize);
+        }
+        else
+        {
+            memcpy(_currentPageData, src, _currentPageDataSize);
+        }
+
+        auto tex = new (std::nothrow) Texture2D;
+        if (_antialiasEnabled)
+        {
+            tex->setAntiAliasTexParameters();
+        }
+        else
+        {
+            tex->setAliasTexParameters();
+        }
+        tex->initWithData(src, _currentPageDataSize,
+            pixelFormat, CacheTextureWidth, CacheTextureHeight, Size(CacheTextureWidth, CacheTextureHeight));
+        addTexture(tex, page);
+        tex->release();
+
+        src += _currentPageDataSize;
+    }
+
+    _currentPage = header.pageCount - 1;
+    _currentPageOrigX = header.currentPageOrigX;
+    _currentPageOrigY = header.currentPageOrigY;
+    _currLineHeight = header.currLineHeight;
+    _persistentCacheDirty = false;
+
+    return true;
+}
+
+void FontAtlas::scheduleEviction()
+{
+    auto director = Director::getInstance();
+    if (_evictionScheduled)
+    {
+        return;
+    }
+    if (_lastEvictionFrame != 0 && director->getTotalFrames() <= _lastEvictionFrame + 1)
+    {
+        // the text on screen alone needs more pages, purging again would only thrash
+        return;
+    }
+
+    // labels may be in the middle of their layout, purge once the current frame is done with them
+    _evictionScheduled = true;
+    this->retain();
+    director->getScheduler()->performFunctionInCocosThread([this]() {
+        CCLOG("FontAtlas: %s has more than %d pages, purging it", getFontName().c_str(), _maxPageCount);
+        _evictionScheduled = false;
+        _lastEvictionFrame = Director::getInstance()->getTotalFrames();
+        purgeTexturesAtlas();
+        this->release();
+    });
+}
+
 void FontAtlas::addTexture(Texture2D *texture, int slot)
 {
     texture->retain();
@@ -31,9 +31,12 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <functional>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/CCRef.h"
+#include "math/CCGeometry.h"
 #include "platform/CCStdC.h" // ssize_t on windows
 
 NS_CC_BEGIN
@@ -79,6 +82,29 @@ public:
     
     bool prepareLetterDefinitions(const std::u32string& utf16String);
 
+    /** Rasterizes the glyphs of utf32Text on a background thread and adds them to the atlas
+     on the cocos thread, so labels showing these characters later don't stall on FreeType.
+     @param callback Called on the cocos thread once the glyphs are in the atlas.
+     */
+    void prepareLetterDefinitionsAsync(const std::u32string& utf32Text, const std::function<void()>& callback = nullptr);
+
+    /** Writes the atlas pages and letter definitions to a file that loadFromFile can restore.
+     Only works for TTF atlases whose page bitmaps were kept, see FontAtlasCache::setPersistentCacheEnabled.
+     */
+    bool saveToFile(const std::string& fullPath) const;
+
+    /** Replaces the atlas content with a file written by saveToFile.
+     Must be called before labels use the atlas, their letters keep the old texture coordinates.
+     */
+    bool loadFromFile(const std::string& fullPath);
+
+    /** Sets the maximum number of texture pages of a TTF atlas, 0 (the default) means unlimited.
+     When the atlas grows past it, the atlas is purged at the beginning of the next frame and
+     the labels using it re-add only the characters they still display.
+     */
+    void setMaxPageCount(int count) { _maxPageCount = count; }
+    int getMaxPageCount() const { return _maxPageCount; }
+
     const std::unordered_map<ssize_t, Texture2D*>& getTextures() const { return _atlasTextures; }
     void  addTexture(Texture2D *texture, int slot);
     float getLineHeight() const { return _lineHeight; }
@@ -118,6 +144,13 @@ protected:
     
     void releaseTextures();
 
+    void addGlyph(char32_t utf32Char, unsigned char* bitmap, long bitmapWidth, long bitmapHeight,
+                  const Rect& glyphRect, int xAdvance, float& startY);
+
+    void updateTextureContent(float startY);
+
+    void scheduleEviction();
+
     void findNewCharacters(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
 
     void conversionU32TOGB2312(const std::u32string& u32Text, std::unordered_map<unsigned int, unsigned int>& charCodeMap);
@@ -150,7 +183,16 @@ protected:
     bool _antialiasEnabled;
     int _currLineHeight;
 
+    // persistent cache related stuff, the bitmaps of the full pages are kept to be saved
+    std::string _persistentCacheFile;
+    bool _persistentCacheDirty;
+    std::vector<std::vector<unsigned char>> _completedPageData;
+    int _maxPageCount;
+    bool _evictionScheduled;
+    unsigned int _lastEvictionFrame;
+
     friend class Label;
+    friend class FontAtlasCache;
 };
 
 NS_CC_END
@@ -32,12 +32,33 @@
 #include "2d/CCFontCharMap.h"
 #include "2d/CCLabel.h"
 #include "platform/CCFileUtils.h"
+#include "base/ccUTF8.h"
+#include "md5/md5.h"
 
 NS_CC_BEGIN
 
 std::unordered_map<std::string, FontAtlas *> FontAtlasCache::_atlasMap;
+bool FontAtlasCache::_persistentCacheEnabled = false;
+std::string FontAtlasCache::_persistentCachePath;
+int FontAtlasCache::_maxPageCountTTF = 0;
+std::unordered_map<std::string, std::string> FontAtlasCache::_fontFileDigests;
 #define ATLAS_MAP_KEY_BUFFER 255
 
+static std::string md5Hex(const void* data, size_t size)
+{
+    md5_state_t state;
+    md5_byte_t digest[16];
+    char hexOutput[33] = { 0 };
+
+    md5_init(&state);
+    md5_append(&state, (const md5_byte_t *)data, (int)size);
+    md5_finish(&state, digest);
+
+    for (int di = 0; di < 16; ++di)
+        sprintf(hexOutput + di * 2, "%02x", digest[di]);
+    return hexOutput;
+}
+
 void FontAtlasCache::purgeCachedData()
 {
     auto atlasMapCopy = _atlasMap;
@@ -81,6 +102,15 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
             auto tempAtlas = font->createFontAtlas();
             if (tempAtlas)
             {
+                tempAtlas->setMaxPageCount(_maxPageCountTTF);
+                if (_persistentCacheEnabled)
+                {
+                    tempAtlas->_persistentCacheFile = getPersistentCacheFile(atlasName, realFontFilename);
+                    if (FileUtils::getInstance()->isFileExist(tempAtlas->_persistentCacheFile))
+                    {
+                        tempAtlas->loadFromFile(tempAtlas->_persistentCacheFile);
+                    }
+                }
                 _atlasMap[atlasName] = tempAtlas;
                 return _atlasMap[atlasName];
             }
@@ -92,6 +122,77 @@ FontAtlas* FontAtlasCache::getFontAtlasTTF(const _ttfConfig* config)
     return nullptr;
 }
 
+FontAtlas* FontAtlasCache::prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& characters,
+                                               const std::function<void(FontAtlas*)>& callback /* = nullptr */)
+{
+    auto atlas = getFontAtlasTTF(config);
+    if (atlas == nullptr)
+    {
+        return nullptr;
+    }
+
+    std::u32string utf32Characters;
+    if (!StringUtils::UTF8ToUTF32(characters, utf32Characters))
+    {
+        CCLOG("FontAtlasCache::prewarmFontAtlasTTF: characters are not valid UTF-8");
+    }
+
+    if (callback)
+    {
+        atlas->prepareLetterDefinitionsAsync(utf32Characters, [atlas, callback]() { callback(atlas); });
+    }
+    else
+    {
+        atlas->prepareLetterDefinitionsAsync(utf32Characters);
+    }
+    return atlas;
+}
+
+std::string FontAtlasCache::getPersistentCachePath()
+{
+    if (_persistentCachePath.empty())
+    {
+        _persistentCachePath = FileUtils::getInstance()->getWritablePath() + "fontatlas/";
+    }
+    return _persistentCachePath;
+}
+
+std::string FontAtlasCache::getPersistentCacheFile(const std::string& atlasName, const std::string& fontFile)
+{
+    // hashing a large font takes a while, so each font file is hashed once per run
+    auto fontDigest = _fontFileDigests.find(fontFile);
+    if (fontDigest == _fontFileDigests.end())
+    {
+        Data fontData = FileUtils::getInstance()->getDataFromFile(fontFile);
+        fontDigest = _fontFileDigests.emplace(fontFile, md5Hex(fontData.getBytes(), fontData.getSize())).first;
+    }
+
+    // an edited font file or another content scale factor invalidates the saved atlas
+    auto key = StringUtils::format("%s|%.2f|%s", atlasName.c_str(), CC_CONTENT_SCALE_FACTOR(), fontDigest->second.c_str());
+    return getPersistentCachePath() + md5Hex(key.c_str(), key.size()) + ".fontatlas";
+}
+
+void FontAtlasCache::saveFontAtlases()
+{
+    bool directoryCreated = false;
+    for (auto&& item : _atlasMap)
+    {
+        auto atlas = item.second;
+        if (atlas->_persistentCacheFile.empty() || !atlas->_persistentCacheDirty)
+            continue;
+
+        if (!directoryCreated)
+        {
+            FileUtils::getInstance()->createDirectory(getPersistentCachePath());
+            directoryCreated = true;
+        }
+        if (atlas->saveToFile(atlas->_persistentCacheFile))
+        {
+            atlas->_persistentCacheDirty = false;
+        }
+    }
+}
+
 FontAtlas* FontAtlasCache::getFontAtlasFNT(const std::string& fontFileName, const Vec2& imageOffset /* = Vec2::ZERO */)
 {
     auto realFontFilename = FileUtils::getInstance()->getNewFilename(fontFileName);  // resolves real file path, to prevent storing multiple atlases for the same file.
@@ -260,6 +361,16 @@ void FontAtlasCache::unloadFontAtlasTTF(const std::string& fontFileName)
         else
             item++;
     }
+
+    // the font file may be replaced before it is loaded again
+    auto digest = _fontFileDigests.begin();
+    while (digest != _fontFileDigests.end())
+    {
+        if (digest->first.find(fontFileName) != std::string::npos)
+            digest = _fontFileDigests.erase(digest);
+        else
+            digest++;
+    }
 }
 
 NS_CC_END
@@ -30,6 +30,7 @@
 /// @cond DO_NOT_SHOW
 
 #include <unordered_map>
+#include <functional>
 #include "base/ccTypes.h"
 
 NS_CC_BEGIN
@@ -50,6 +51,39 @@ public:
     
     static bool releaseFontAtlas(FontAtlas *atlas);
 
+    /** Gets the TTF atlas of config and rasterizes the given characters into it on a background thread.
+     Use it during loading screens for the character sets a scene is going to display.
+     @param characters UTF-8 text containing the characters to prepare.
+     @param callback Called on the cocos thread once the characters are in the atlas.
+     @return The atlas, owned by the cache, or nullptr if the font can't be loaded.
+     */
+    static FontAtlas* prewarmFontAtlasTTF(const _ttfConfig* config, const std::string& characters,
+                                          const std::function<void(FontAtlas*)>& callback = nullptr);
+
+    /** Enables saving TTF atlases to disk, later launches load them instead of rasterizing the glyphs again.
+     Only atlases created after enabling it are saved, so enable it before creating any TTF label.
+     */
+    static void setPersistentCacheEnabled(bool enabled) { _persistentCacheEnabled = enabled; }
+    static bool isPersistentCacheEnabled() { return _persistentCacheEnabled; }
+
+    /** Sets the directory of the saved atlases.
+     By default it is FileUtils::getWritablePath() + "fontatlas/".
+     @param path The absolute directory path, ending with '/'.
+     */
+    static void setPersistentCachePath(const std::string& path) { _persistentCachePath = path; }
+    static std::string getPersistentCachePath();
+
+    /** Saves the TTF atlases which got new characters since they were loaded or saved.
+     Call it when the application enters the background, purgeCachedData() drops the unsaved characters.
+     */
+    static void saveFontAtlases();
+
+    /** Sets the page limit given to TTF atlases created from now on, 0 (the default) means unlimited.
+     @see FontAtlas::setMaxPageCount
+     */
+    static void setMaxPageCountTTF(int count) { _maxPageCountTTF = count; }
+    static int getMaxPageCountTTF() { return _maxPageCountTTF; }
+
     /** Removes cached data.
      It will purge the textures atlas and if multiple texture exist in one FontAtlas.
      */
@@ -68,7 +102,13 @@ public:
     static void unloadFontAtlasTTF(const std::string& fontFileName);
 
 private:
+    static std::string getPersistentCacheFile(const std::string& atlasName, const std::string& fontFile);
+
     static std::unordered_map<std::string, FontAtlas *> _atlasMap;
+    static bool _persistentCacheEnabled;
+    static std::string _persistentCachePath;
+    static int _maxPageCountTTF;
+    static std::unordered_map<std::string, std::string> _fontFileDigests;  // font file -> md5 of its content
 };
 
 NS_CC_END
@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCFontFreeType.h"
+#include <mutex>
 #include FT_BBOX_H
 #include "edtaa3func.h"
 #include "2d/CCFontAtlas.h"
@@ -50,6 +51,10 @@ typedef struct _DataRef
 
 static std::unordered_map<std::string, DataRef> s_cacheFontData;
 
+// All faces render through the raster pool of the shared FT_Library, and glyphs
+// may also be rasterized by FontAtlas::prepareLetterDefinitionsAsync on a worker thread.
+static std::mutex s_glyphRenderMutex;
+
 FontFreeType * FontFreeType::create(const std::string &fontName, float fontSize, GlyphCollection glyphs, const char *customGlyphs,bool distanceFieldEnabled /* = false */,float outline /* = 0 */)
 {
     FontFreeType *tempFont =  new (std::nothrow) FontFreeType(distanceFieldEnabled,outline);
@@ -102,6 +107,7 @@ FontFreeType::FontFreeType(bool distanceFieldEnabled /* = false */, float outlin
 : _fontRef(nullptr)
 , _stroker(nullptr)
 , _encoding(FT_ENCODING_UNICODE)
+, _fontSize(0.0f)
 , _distanceFieldEnabled(distanceFieldEnabled)
 , _outlineSize(0.0f)
 , _lineHeight(0)
@@ -125,6 +131,7 @@ bool FontFreeType::createFontObject(const std::string &fontName, float fontSize)
     FT_Face face;
     // save font name locally
     _fontName = fontName;
+    _fontSize = fontSize;
 
     auto it = s_cacheFontData.find(fontName);
     if (it != s_cacheFontData.end())
@@ -293,6 +300,7 @@ unsigned char* FontFreeType::getGlyphBitmap(uint64_t theChar, long &outWidth, lo
 {
     bool invalidChar = true;
     unsigned char* ret = nullptr;
+    std::lock_guard<std::mutex> lock(s_glyphRenderMutex);
 
     do
     {
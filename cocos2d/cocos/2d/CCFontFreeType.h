@@ -63,6 +63,9 @@ public:
 
     float getOutlineSize() const { return _outlineSize; }
 
+    /** Returns the font size in points this font was created with. */
+    float getFontSize() const { return _fontSize; }
+
     void renderCharAt(unsigned char *dest,int posX, int posY, unsigned char* bitmap,long bitmapWidth,long bitmapHeight); 
 
     FT_Encoding getEncoding() const { return _encoding; }
@@ -105,6 +108,7 @@ private:
     FT_Encoding _encoding;
 
     std::string _fontName;
+    float _fontSize;
     bool _distanceFieldEnabled;
     float _outlineSize;
     int _lineHeight;
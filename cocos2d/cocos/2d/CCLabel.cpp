@@ -473,6 +473,10 @@ void Label::reset()
     _currentLabelType = LabelType::STRING_TEXTURE;
     _currLabelEffect = LabelEffect::NORMAL;
     _contentDirty = false;
+    _textDirty = false;
+    _textChangeIndex = 0;
+    _textLengthChanged = false;
+    _linesStartInfo.clear();
     _numberOfLines = 0;
     _lengthOfString = 0;
     _utf32Text.clear();
@@ -524,6 +528,8 @@ void Label::reset()
     _isOpacityModifyRGB = false;
     _insideBounds = true;
     _enableWrap = true;
+    _monospacedDigits = false;
+    _digitAdvance = 0;
     _bmFontSize = -1;
     _bmfontScale = 1.0f;
     _overflow = Overflow::NONE;
@@ -538,6 +544,11 @@ void Label::reset()
     setRotationSkewX(0);        // reverse italics
 }
 
+static bool isDigit(char32_t character)
+{
+    return character >= U'0' && character <= U'9';
+}
+
 //  ETC1 ALPHA supports, for LabelType::BMFONT & LabelType::CHARMAP
 static Texture2D* _getTexture(Label* label)
 {
@@ -670,13 +681,32 @@ void Label::setString(const std::string& text)
     if (text.compare(_utf8Text))
     {
         _utf8Text = text;
-        _contentDirty = true;
 
         std::u32string utf32String;
         if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
         {
+            // remember where the text starts to differ from the laid out one, see updateContentIncrementally()
+            size_t length = std::min(_utf32Text.length(), utf32String.length());
+            size_t changeIndex = 0;
+            while (changeIndex < length && _utf32Text[changeIndex] == utf32String[changeIndex])
+            {
+                ++changeIndex;
+            }
+            if (!_textDirty)
+            {
+                _textChangeIndex = static_cast<int>(changeIndex);
+                _textLengthChanged = false;
+            }
+            _textChangeIndex = std::min(_textChangeIndex, static_cast<int>(changeIndex));
+            _textLengthChanged |= _utf32Text.length() != utf32String.length();
+
             _utf32Text  = utf32String;
         }
+        else
+        {
+            _contentDirty = true;
+        }
+        _textDirty = true;
 
         CCASSERT(_utf32Text.length() <= CC_LABEL_MAX_LENGTH, "Length of text should be less then 16384");
         if (_utf32Text.length() > CC_LABEL_MAX_LENGTH)
@@ -810,34 +840,46 @@ void Label::updateLabelLetters()
     }
 }
 
+void Label::prepareLetters()
+{
+    _fontAtlas->prepareLetterDefinitions(_utf32Text);
+    if (_monospacedDigits)
+    {
+        // the widest digit decides the advance of all of them
+        _fontAtlas->prepareLetterDefinitions(U"0123456789");
+    }
+
+    auto& textures = _fontAtlas->getTextures();
+    auto size = textures.size();
+    if (size > static_cast<size_t>(_batchNodes.size()))
+    {
+        for (auto index = static_cast<size_t>(_batchNodes.size()); index < size; ++index)
+        {
+            auto batchNode = SpriteBatchNode::createWithTexture(textures.at(index));
+            if (batchNode)
+            {
+                _isOpacityModifyRGB = batchNode->getTexture()->hasPremultipliedAlpha();
+                _blendFunc = batchNode->getBlendFunc();
+                batchNode->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
+                batchNode->setPosition(Vec2::ZERO);
+                _batchNodes.pushBack(batchNode);
+            }
+        }
+    }
+}
+
 bool Label::alignText()
 {
     if (_fontAtlas == nullptr || _utf32Text.empty())
     {
+        _linesStartInfo.clear();
         setContentSize(Size::ZERO);
         return true;
     }
 
     bool ret = true;
     do {
-        _fontAtlas->prepareLetterDefinitions(_utf32Text);
-        auto& textures = _fontAtlas->getTextures();
-        auto size = textures.size();
-        if (size > static_cast<size_t>(_batchNodes.size()))
-        {
-            for (auto index = static_cast<size_t>(_batchNodes.size()); index < size; ++index)
-            {
-                auto batchNode = SpriteBatchNode::createWithTexture(textures.at(index));
-                if (batchNode)
-                {
-                    _isOpacityModifyRGB = batchNode->getTexture()->hasPremultipliedAlpha();
-                    _blendFunc = batchNode->getBlendFunc();
-                    batchNode->setAnchorPoint(Vec2::ANCHOR_TOP_LEFT);
-                    batchNode->setPosition(Vec2::ZERO);
-                    _batchNodes.pushBack(batchNode);
-                }
-            }
-        }
+        prepareLetters();
         if (_batchNodes.empty())
         {
             return true;
@@ -887,6 +929,175 @@ bool Label::alignText()
     return ret;
 }
 
+bool Label::updateContentIncrementally()
+{
+    // only the lines from the first changed letter on are laid out again, which requires
+    // that lines break at new line characters only
+    if (_utf32Text.empty() || _linesStartInfo.empty() || _batchNodes.empty() || _reusedLetter == nullptr
+        || _overflow == Overflow::SHRINK || (_enableWrap && _maxLineWidth > 0.f))
+    {
+        return false;
+    }
+
+    if (_monospacedDigits && !_textLengthChanged && updateChangedDigits())
+    {
+        return true;
+    }
+
+    computeHorizontalKernings(_utf32Text);
+    prepareLetters();
+    _reusedLetter->setBatchNode(_batchNodes.at(0));
+
+    int startLine = 0;
+    auto linesCount = static_cast<int>(_linesStartInfo.size());
+    while (startLine + 1 < linesCount && _linesStartInfo[startLine + 1].letterIndex <= _textChangeIndex)
+    {
+        ++startLine;
+    }
+    int startLetter = _linesStartInfo[startLine].letterIndex;
+
+    auto letterOffsetY = _letterOffsetY;
+    auto tailoredTopY = _tailoredTopY;
+    auto tailoredBottomY = _tailoredBottomY;
+    std::vector<float> linesOffsetX(_linesOffsetX.begin(), _linesOffsetX.begin() + std::min(startLine, (int)_linesOffsetX.size()));
+
+    _lengthOfString = 0;
+    _textDesiredHeight = 0.f;
+    if (_maxLineWidth > 0.f && !_lineBreakWithoutSpaces)
+    {
+        multilineTextWrapByWord(startLine);
+    }
+    else
+    {
+        multilineTextWrapByChar(startLine);
+    }
+    computeAlignmentOffset();
+
+    // the quads of the unchanged lines stay valid unless the label moved its lines
+    bool unchangedLinesMoved = letterOffsetY != _letterOffsetY
+        || tailoredTopY != _tailoredTopY
+        || tailoredBottomY != _tailoredBottomY
+        || !std::equal(linesOffsetX.begin(), linesOffsetX.end(), _linesOffsetX.begin());
+    if (unchangedLinesMoved)
+    {
+        updateQuads();
+        updateLabelLetters();
+        updateColor();
+        return true;
+    }
+
+    // the quads of each batch node are in letter order, drop the ones of the changed lines
+    std::vector<ssize_t> firstQuads(_batchNodes.size(), 0);
+    for (int ctr = 0; ctr < startLetter; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        if (letterInfo.valid && letterInfo.atlasIndex >= 0)
+        {
+            auto textureID = _fontAtlas->_letterDefinitions[letterInfo.utf32Char].textureID;
+            firstQuads[textureID] = std::max(firstQuads[textureID], static_cast<ssize_t>(letterInfo.atlasIndex + 1));
+        }
+    }
+    for (ssize_t index = 0, count = _batchNodes.size(); index < count; ++index)
+    {
+        auto textureAtlas = _batchNodes.at(index)->getTextureAtlas();
+        auto totalQuads = textureAtlas->getTotalQuads();
+        if (totalQuads > firstQuads[index])
+        {
+            textureAtlas->removeQuadsAtIndex(firstQuads[index], totalQuads - firstQuads[index]);
+        }
+    }
+
+    insertQuads(startLetter);
+    updateLabelLetters();
+    updateQuadsColor(firstQuads);
+
+    return true;
+}
+
+bool Label::updateChangedDigits()
+{
+    // with monospaced digits, changing a digit doesn't move the other letters, only its own quad changes.
+    // The line widths, and with them the alignment offsets and the content size, add up the advances of
+    // the letters, so they stay valid as long as the new digit advances as much as the old one
+    if (_labelHeight > 0.f || (_labelWidth > 0.f && _overflow != Overflow::NONE))
+    {
+        return false;
+    }
+
+    std::vector<int> changedLetters;
+    FontLetterDefinition oldLetterDef;
+    FontLetterDefinition newLetterDef;
+    auto length = static_cast<int>(_utf32Text.length());
+    if (static_cast<int>(_lettersInfo.size()) < length)
+    {
+        return false;
+    }
+
+    // digits are prepared with the text, so their definitions exist and no page is added
+    for (int ctr = _textChangeIndex; ctr < length; ++ctr)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        char32_t character = _utf32Text[ctr];
+        if (character == letterInfo.utf32Char)
+        {
+            continue;
+        }
+
+        if (!isDigit(character) || !isDigit(letterInfo.utf32Char)
+            || !letterInfo.valid || letterInfo.atlasIndex < 0
+            || !getFontLetterDef(letterInfo.utf32Char, oldLetterDef) || !getFontLetterDef(character, newLetterDef)
+            || newLetterDef.width <= 0.f || newLetterDef.height <= 0.f
+            || newLetterDef.xAdvance != oldLetterDef.xAdvance
+            || newLetterDef.textureID != oldLetterDef.textureID)
+        {
+            return false;
+        }
+        changedLetters.push_back(ctr);
+    }
+
+    auto contentScaleFactor = CC_CONTENT_SCALE_FACTOR();
+    auto color = getQuadColor();
+    for (auto ctr : changedLetters)
+    {
+        auto& letterInfo = _lettersInfo[ctr];
+        getFontLetterDef(letterInfo.utf32Char, oldLetterDef);
+        getFontLetterDef(_utf32Text[ctr], newLetterDef);
+
+        letterInfo.positionX += (newLetterDef.offsetX - oldLetterDef.offsetX) * _bmfontScale / contentScaleFactor;
+        letterInfo.positionY -= (newLetterDef.offsetY - oldLetterDef.offsetY) * _bmfontScale / contentScaleFactor;
+        letterInfo.utf32Char = _utf32Text[ctr];
+
+        _reusedRect.size.height = newLetterDef.height;
+        _reusedRect.size.width  = newLetterDef.width;
+        _reusedRect.origin.x    = newLetterDef.U;
+        _reusedRect.origin.y    = newLetterDef.V;
+        _reusedLetter->setTextureRect(_reusedRect, false, _reusedRect.size);
+        _reusedLetter->setPosition(letterInfo.positionX + _linesOffsetX[letterInfo.lineIndex], letterInfo.positionY + _letterOffsetY);
+        this->updateLetterSpriteScale(_reusedLetter);
+
+        // updateTransform() writes the quad at the atlas index of the sprite
+        auto batchNode = _batchNodes.at(newLetterDef.textureID);
+        _reusedLetter->setBatchNode(batchNode);
+        _reusedLetter->setAtlasIndex(letterInfo.atlasIndex);
+        _reusedLetter->setDirty(true);
+        _reusedLetter->updateTransform();
+
+        auto textureAtlas = batchNode->getTextureAtlas();
+        auto& quad = textureAtlas->getQuads()[letterInfo.atlasIndex];
+        quad.bl.colors = color;
+        quad.br.colors = color;
+        quad.tl.colors = color;
+        quad.tr.colors = color;
+        textureAtlas->updateQuad(&quad, letterInfo.atlasIndex);
+    }
+
+    if (!changedLetters.empty())
+    {
+        updateLabelLetters();
+    }
+    return true;
+}
+
 bool Label::computeHorizontalKernings(const std::u32string& stringToRender)
 {
     if (_horizontalKernings)
@@ -900,8 +1111,17 @@ bool Label::computeHorizontalKernings(const std::u32string& stringToRender)
 
     if(!_horizontalKernings)
         return false;
-    else
-        return true;
+
+    if (_monospacedDigits)
+    {
+        // kerning would move the digits, _horizontalKernings[i] is the kerning of letter i-1 and i
+        for (int index = 1; index < letterCount; ++index)
+        {
+            if (isDigit(stringToRender[index]) || isDigit(stringToRender[index - 1]))
+                _horizontalKernings[index] = 0;
+        }
+    }
+    return true;
 }
 
 bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
@@ -917,13 +1137,18 @@ bool Label::isHorizontalClamped(float letterPositionX, int lineIndex)
 
 bool Label::updateQuads()
 {
-    bool ret = true;
     for (auto&& batchNode : _batchNodes)
     {
         batchNode->getTextureAtlas()->removeAllQuads();
     }
-    
-    for (int ctr = 0; ctr < _lengthOfString; ++ctr)
+
+    return insertQuads(0);
+}
+
+bool Label::insertQuads(int startLetter)
+{
+    bool ret = true;
+    for (int ctr = startLetter; ctr < _lengthOfString; ++ctr)
     {
         if (_lettersInfo[ctr].valid)
         {
@@ -1128,7 +1353,7 @@ void Label::enableShadow(const Color4B& shadowColor /* = Color4B::BLACK */,
     _shadowColor3B.b = shadowColor.b;
     _shadowOpacity = shadowColor.a;
 
-    if (!_systemFontDirty && !_contentDirty && _textSprite)
+    if (!_systemFontDirty && !_contentDirty && !_textDirty && _textSprite)
     {
         auto fontDef = _getFontDefinition();
         if (_shadowNode)
@@ -1406,14 +1631,17 @@ void Label::updateContent()
 
     if (_fontAtlas)
     {
-        std::u32string utf32String;
-        if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
+        if (_contentDirty || !_textDirty || !updateContentIncrementally())
         {
-            _utf32Text = utf32String;
-        }
+            std::u32string utf32String;
+            if (StringUtils::UTF8ToUTF32(_utf8Text, utf32String))
+            {
+                _utf32Text = utf32String;
+            }
 
-        computeHorizontalKernings(_utf32Text);
-        updateFinished = alignText();
+            computeHorizontalKernings(_utf32Text);
+            updateFinished = alignText();
+        }
     }
     else
     {
@@ -1467,6 +1695,7 @@ void Label::updateContent()
     if(updateFinished){
         _contentDirty = false;
     }
+    _textDirty = false;
 
 #if CC_LABEL_DEBUG_DRAW
     _debugDrawNode->clear();
@@ -1649,7 +1878,7 @@ void Label::visit(Renderer *renderer, const Mat4 &parentTransform, uint32_t pare
         return;
     }
     
-    if (_systemFontDirty || _contentDirty)
+    if (_systemFontDirty || _contentDirty || _textDirty)
     {
         updateContent();
     }
@@ -1763,7 +1992,7 @@ Sprite* Label::getLetter(int letterIndex)
             break;
         }
 
-        auto contentDirty = _contentDirty;
+        auto contentDirty = _contentDirty || _textDirty;
         if (contentDirty)
         {
             updateContent();
@@ -1896,7 +2125,7 @@ void Label::computeStringNumLines()
 
 int Label::getStringNumLines()
 {
-    if (_contentDirty)
+    if (_contentDirty || _textDirty)
     {
         updateContent();
     }
@@ -2000,6 +2229,11 @@ void Label::updateColor()
         return;
     }
 
+    updateQuadsColor(std::vector<ssize_t>());
+}
+
+Color4B Label::getQuadColor() const
+{
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
     // special opacity for premultiplied textures
@@ -2009,16 +2243,23 @@ void Label::updateColor()
         color4.g *= _displayedOpacity/255.0f;
         color4.b *= _displayedOpacity/255.0f;
     }
+    return color4;
+}
+
+void Label::updateQuadsColor(const std::vector<ssize_t>& firstQuads)
+{
+    auto color4 = getQuadColor();
 
     cocos2d::TextureAtlas* textureAtlas;
     V3F_C4B_T2F_Quad *quads;
-    for (auto&& batchNode:_batchNodes)
+    for (ssize_t batchIndex = 0, batchCount = _batchNodes.size(); batchIndex < batchCount; ++batchIndex)
     {
-        textureAtlas = batchNode->getTextureAtlas();
+        textureAtlas = _batchNodes.at(batchIndex)->getTextureAtlas();
         quads = textureAtlas->getQuads();
         auto count = textureAtlas->getTotalQuads();
+        auto first = firstQuads.empty() ? 0 : firstQuads[batchIndex];
 
-        for (int index = 0; index < count; ++index)
+        for (auto index = first; index < count; ++index)
         {
             quads[index].bl.colors = color4;
             quads[index].br.colors = color4;
@@ -2041,7 +2282,7 @@ std::string Label::getDescription() const
 
 const Size& Label::getContentSize() const
 {
-    if (_systemFontDirty || _contentDirty)
+    if (_systemFontDirty || _contentDirty || _textDirty)
     {
         const_cast<Label*>(this)->updateContent();
     }
@@ -2181,6 +2422,17 @@ bool Label::isWrapEnabled()const
     return this->_enableWrap;
 }
 
+void Label::enableMonospacedDigits(bool enable)
+{
+    if (enable == _monospacedDigits)
+    {
+        return;
+    }
+
+    _monospacedDigits = enable;
+    _contentDirty = true;
+}
+
 void Label::setOverflow(Overflow overflow)
 {
     if(_overflow == overflow){
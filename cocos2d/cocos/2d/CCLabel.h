@@ -488,6 +488,20 @@ public:
      */
     bool isWrapEnabled()const;
 
+    /**
+     * Makes the digits 0-9 advance by the same width, like tabular figures, so counters and timers don't jitter.
+     * Changing only digits of the string then updates their quads in place instead of laying out the label again.
+     * Note: System font doesn't support it.
+     *
+     * @param enable Set true to give all digits the advance of the widest one.
+     */
+    void enableMonospacedDigits(bool enable);
+
+    /**
+     * Query the digits are monospaced or not.
+     */
+    bool isMonospacedDigitsEnabled() const { return _monospacedDigits; }
+
     /**
      * Change the label's Overflow type, currently only TTF and BMFont support all the valid Overflow type.
      * Char Map font supports all the Overflow type except for SHRINK, because we can't measure it's font size.
@@ -648,6 +662,17 @@ protected:
         int lineIndex;
     };
 
+    // layout state at the first letter of a line, multilineTextWrap() can resume from it
+    struct LineStartInfo
+    {
+        int letterIndex;
+        float nextTokenY;
+        float nextWhitespaceWidth;
+        float highestY;
+        float lowestY;
+        bool nextChangeSize;
+    };
+
     virtual void setFontAtlas(FontAtlas* atlas, bool distanceFieldEnabled = false, bool useA8Shader = false);
     bool getFontLetterDef(char32_t character, FontLetterDefinition& letterDef) const;
 
@@ -657,16 +682,19 @@ protected:
     void onDrawShadow(GLProgram* glProgram, const Color4F& shadowColor);
     void drawSelf(bool visibleByCamera, Renderer* renderer, uint32_t flags);
 
-    bool multilineTextWrapByChar();
-    bool multilineTextWrapByWord();
-    bool multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& lambda);
+    bool multilineTextWrapByChar(int startLine = 0);
+    bool multilineTextWrapByWord(int startLine = 0);
+    bool multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& lambda, int startLine = 0);
     void shrinkLabelToContentSize(const std::function<bool(void)>& lambda);
     bool isHorizontalClamp();
     bool isVerticalClamp();
     void rescaleWithOriginalFontSize();
 
     void updateLabelLetters();
+    void prepareLetters();
     virtual bool alignText();
+    bool updateContentIncrementally();
+    bool updateChangedDigits();
     void computeAlignmentOffset();
     bool computeHorizontalKernings(const std::u32string& stringToRender);
 
@@ -674,12 +702,16 @@ protected:
     void recordPlaceholderInfo(int letterIndex, char32_t utf16Char);
     
     bool updateQuads();
+    bool insertQuads(int startLetter);
+    void updateQuadsColor(const std::vector<ssize_t>& firstQuads);
+    Color4B getQuadColor() const;
 
     void createSpriteForSystemFont(const FontDefinition& fontDef);
     void createShadowSpriteForSystemFont(const FontDefinition& fontDef);
 
     virtual void updateShaderProgram();
     void updateBMFontScale();
+    void updateDigitAdvance();
     void scaleFontSizeDown(float fontSize);
     bool setTTFConfigInternal(const TTFConfig& ttfConfig);
     void setBMFontSizeInternal(float fontSize);
@@ -697,6 +729,10 @@ protected:
 
     LabelType _currentLabelType;
     bool _contentDirty;
+    // only the string changed since the last layout, from _textChangeIndex on
+    bool _textDirty;
+    int _textChangeIndex;
+    bool _textLengthChanged;
     std::u32string _utf32Text;
     std::string _utf8Text;
     int _numberOfLines;
@@ -736,6 +772,7 @@ protected:
     float _textDesiredHeight;
     std::vector<float> _linesWidth;
     std::vector<float> _linesOffsetX;
+    std::vector<LineStartInfo> _linesStartInfo;
     float _letterOffsetY;
     float _tailoredTopY;
     float _tailoredBottomY;
@@ -782,6 +819,8 @@ protected:
 #endif
 
     bool _enableWrap;
+    bool _monospacedDigits;
+    int _digitAdvance;
     float _bmFontSize;
     float _bmfontScale;
     Overflow _overflow;
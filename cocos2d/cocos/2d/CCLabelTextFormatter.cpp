@@ -132,7 +132,32 @@ bool Label::getFontLetterDef(char32_t character, FontLetterDefinition& letterDef
         character = StringUtils::UnicodeCharacters::Space;
     }
 
-    return _fontAtlas->getLetterDefinitionForChar(character, letterDef);
+    if (!_fontAtlas->getLetterDefinitionForChar(character, letterDef))
+    {
+        return false;
+    }
+
+    if (_monospacedDigits && _digitAdvance > 0 && character >= U'0' && character <= U'9')
+    {
+        // center the digit in the advance of the widest one
+        letterDef.offsetX += (_digitAdvance - letterDef.xAdvance) / 2.f;
+        letterDef.xAdvance = _digitAdvance;
+    }
+    return true;
+}
+
+void Label::updateDigitAdvance()
+{
+    _digitAdvance = 0;
+    if (_monospacedDigits)
+    {
+        FontLetterDefinition letterDef;
+        for (char32_t digit = U'0'; digit <= U'9'; ++digit)
+        {
+            if (_fontAtlas->getLetterDefinitionForChar(digit, letterDef) && letterDef.xAdvance > _digitAdvance)
+                _digitAdvance = letterDef.xAdvance;
+        }
+    }
 }
 
 void Label::updateBMFontScale()
@@ -147,7 +172,7 @@ void Label::updateBMFontScale()
     }
 }
 
-bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& nextTokenLen)
+bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int, int)>& nextTokenLen, int startLine /* = 0 */)
 {
     int textLen = getStringLength();
     int lineIndex = 0;
@@ -164,10 +189,33 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
     FontLetterDefinition letterDef;
     Vec2 letterPosition;
     bool nextChangeSize = true;
+    int index = 0;
 
     this->updateBMFontScale();
+    this->updateDigitAdvance();
+
+    if (startLine > 0)
+    {
+        // the lines before startLine are laid out already
+        const auto& lineStart = _linesStartInfo[startLine];
+        index = lineStart.letterIndex;
+        lineIndex = startLine;
+        nextTokenY = lineStart.nextTokenY;
+        nextWhitespaceWidth = lineStart.nextWhitespaceWidth;
+        highestY = lineStart.highestY;
+        lowestY = lineStart.lowestY;
+        nextChangeSize = lineStart.nextChangeSize;
+        _linesWidth.resize(startLine);
+    }
+    _linesStartInfo.resize(startLine);
+
+    auto recordLineStart = [&]() {
+        LineStartInfo lineStart = { index, nextTokenY, nextWhitespaceWidth, highestY, lowestY, nextChangeSize };
+        _linesStartInfo.push_back(lineStart);
+    };
+    recordLineStart();
 
-    for (int index = 0; index < textLen; )
+    while (index < textLen)
     {
         char32_t character = _utf32Text[index];
         if (character == StringUtils::UnicodeCharacters::NewLine)
@@ -179,6 +227,7 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
             nextTokenY -= _lineHeight*_bmfontScale + lineSpacing;
             recordPlaceholderInfo(index, character);
             index++;
+            recordLineStart();
             continue;
         }
 
@@ -263,6 +312,7 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
 
         if (newLine)
         {
+            recordLineStart();
             continue;
         }
 
@@ -312,14 +362,14 @@ bool Label::multilineTextWrap(const std::function<int(const std::u32string&, int
     return true;
 }
 
-bool Label::multilineTextWrapByWord()
+bool Label::multilineTextWrapByWord(int startLine /* = 0 */)
 {
-    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstWordLen, this));
+    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstWordLen, this), startLine);
 }
 
-bool Label::multilineTextWrapByChar()
+bool Label::multilineTextWrapByChar(int startLine /* = 0 */)
 {
-    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstCharLen, this));
+    return multilineTextWrap(CC_CALLBACK_3(Label::getFirstCharLen, this), startLine);
 }
 
 bool Label::isVerticalClamp()
@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "2d/CCActionManager.h"
 #include "2d/CCScene.h"
 #include "2d/CCComponent.h"
+#include "2d/CCNodePool.h"
 #include "renderer/CCGLProgram.h"
 #include "renderer/CCGLProgramState.h"
 #include "renderer/CCMaterial.h"
@@ -116,6 +117,8 @@ Node::Node()
 , _onExitCallback(nullptr)
 , _onEnterTransitionDidFinishCallback(nullptr)
 , _onExitTransitionDidStartCallback(nullptr)
+, _nodePool(nullptr)
+, _nodePoolSlot(0)
 #if CC_USE_PHYSICS
 , _physicsBody(nullptr)
 #endif
@@ -1030,6 +1033,12 @@ void Node::removeFromParentAndCleanup(bool cleanup)
     {
         _parent->removeChild(this,cleanup);
     } 
+
+    // Pooled nodes are given back to their pool instead of being released
+    if (cleanup && _nodePool != nullptr)
+    {
+        _nodePool->recycle(this);
+    }
 }
 
 /* "remove" logic MUST only be on this method
@@ -1172,6 +1181,8 @@ void Node::reorderChild(Node *child, int zOrder)
     _reorderChildDirty = true;
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
+    // Only the moved child changes its position relative to the other nodes
+    _eventDispatcher->setDirtyForNode(child);
 }
 
 void Node::sortAllChildren()
@@ -1180,7 +1191,6 @@ void Node::sortAllChildren()
     {
         sortNodes(_children);
         _reorderChildDirty = false;
-        _eventDispatcher->setDirtyForNode(this);
     }
 }
 
@@ -63,6 +63,7 @@ class GLProgramState;
 class Material;
 class Camera;
 class PhysicsBody;
+class NodePoolBase;
 
 /**
  * @addtogroup _2d
@@ -878,6 +879,7 @@ public:
     /**
      * Removes this node itself from its parent node.
      * If the node orphan, then nothing happens.
+     * If the node was acquired from a NodePool and cleanup is true, it is given back to its pool.
      * @param cleanup   true if all actions and callbacks on this node should be removed, false otherwise.
      * @js removeFromParent
      * @lua removeFromParent
@@ -2016,6 +2018,11 @@ protected:
     std::function<void()> _onEnterTransitionDidFinishCallback;
     std::function<void()> _onExitTransitionDidStartCallback;
 
+    NodePoolBase* _nodePool;        ///< the pool which owns this node, nullptr if it isn't pooled
+    std::uint32_t _nodePoolSlot;    ///< slot of this node in its pool
+
+    friend class NodePoolBase;
+
 //Physics:remaining backwardly compatible  
 #if CC_USE_PHYSICS
     PhysicsBody* _physicsBody;
@@ -2034,6 +2041,8 @@ public:
     friend class PhysicsBody;
 #endif
 
+    friend class EventDispatcher;
+
     static int __attachedNodeCount;
     
 private:
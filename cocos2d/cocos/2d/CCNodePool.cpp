@@ -0,0 +1,77 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCNodePool.h"
+
+#include <algorithm>
+
+#include "base/ccUTF8.h"
+
+NS_CC_BEGIN
+
+NodePoolBase::NodePoolBase(const std::string& name)
+: _name(name)
+, _hitCount(0)
+, _missCount(0)
+, _recycleCount(0)
+{
+    getPools().push_back(this);
+}
+
+NodePoolBase::~NodePoolBase()
+{
+    auto& pools = getPools();
+    pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+}
+
+std::vector<NodePoolBase*>& NodePoolBase::getPools()
+{
+    static std::vector<NodePoolBase*> pools;
+    return pools;
+}
+
+void NodePoolBase::setNodePool(Node* node, NodePoolBase* pool, std::uint32_t slot)
+{
+    node->_nodePool = pool;
+    node->_nodePoolSlot = slot;
+}
+
+std::string NodePoolBase::diagnostics() const
+{
+    return StringUtils::format("%s size:%d free:%d hits:%u misses:%u recycled:%u\n",
+                               _name.c_str(), (int)getSize(), (int)getFreeCount(),
+                               _hitCount, _missCount, _recycleCount);
+}
+
+std::string NodePoolBase::getAllDiagnostics()
+{
+    std::string data;
+    for (const auto& pool : getPools())
+    {
+        data += pool->diagnostics();
+    }
+    return data;
+}
+
+NS_CC_END
@@ -0,0 +1,289 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_NODE_POOL_H__
+#define __CC_NODE_POOL_H__
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "2d/CCNode.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/**
+ * A generational reference to a node owned by a NodePool.
+ * A handle becomes stale once its node is recycled, so it is safe to keep it
+ * around: NodePool::get() returns nullptr instead of a node reused by somebody else.
+ */
+struct CC_DLL NodePoolHandle
+{
+    std::uint32_t index;
+    std::uint32_t generation;
+
+    NodePoolHandle() : index(0), generation(0) {}
+    NodePoolHandle(std::uint32_t i, std::uint32_t g) : index(i), generation(g) {}
+
+    /** Whether the handle was never assigned. */
+    bool isNull() const { return generation == 0; }
+
+    bool operator==(const NodePoolHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const NodePoolHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * Base class of all node pools. Keeps the hit/miss statistics and the list of
+ * living pools, which is displayed by the `allocator` command of the Console.
+ */
+class CC_DLL NodePoolBase
+{
+public:
+    /** Gives a node acquired from this pool back, removing it from its parent first. */
+    virtual void recycle(Node* node) = 0;
+
+    /** Number of nodes owned by the pool, in use or not. */
+    virtual ssize_t getSize() const = 0;
+
+    /** Number of nodes waiting to be acquired. */
+    virtual ssize_t getFreeCount() const = 0;
+
+    const std::string& getName() const { return _name; }
+
+    /** Number of acquisitions served by a recycled node. */
+    unsigned int getHitCount() const { return _hitCount; }
+
+    /** Number of acquisitions which had to create a new node. */
+    unsigned int getMissCount() const { return _missCount; }
+
+    /** Number of nodes given back to the pool. */
+    unsigned int getRecycleCount() const { return _recycleCount; }
+
+    /** Returns a one line summary of the pool statistics. */
+    std::string diagnostics() const;
+
+    /** Returns the statistics of all living pools, one line per pool. */
+    static std::string getAllDiagnostics();
+
+    virtual ~NodePoolBase();
+
+protected:
+    explicit NodePoolBase(const std::string& name);
+
+    /** Marks node as owned by pool at the specified slot, pool can be nullptr to detach it. */
+    static void setNodePool(Node* node, NodePoolBase* pool, std::uint32_t slot);
+    static NodePoolBase* getNodePool(const Node* node) { return node->_nodePool; }
+    static std::uint32_t getNodePoolSlot(const Node* node) { return node->_nodePoolSlot; }
+
+    std::string _name;
+    unsigned int _hitCount;
+    unsigned int _missCount;
+    unsigned int _recycleCount;
+
+private:
+    static std::vector<NodePoolBase*>& getPools();
+
+    CC_DISALLOW_COPY_AND_ASSIGN(NodePoolBase);
+};
+
+/**
+ * Recycles nodes of type T instead of creating and releasing them, useful for
+ * entities spawned and removed every frame such as bullets, coins or sprites used as particles.
+ *
+ * The pool keeps a reference on every node it created. A node given back with
+ * Node::removeFromParent() or NodePool::recycle() is cleaned up, reset with the reset
+ * callback and handed out again by the next acquire().
+ *
+ * @code
+ * NodePool<Sprite> coins("coins", [](){ return Sprite::create("coin.png"); },
+ *                        [](Sprite* coin){ coin->setOpacity(255); });
+ * NodePoolHandle handle;
+ * auto coin = coins.acquire(&handle);
+ * layer->addChild(coin);
+ * ...
+ * coin->removeFromParent(); // back to the pool, handle is stale from now on
+ * @endcode
+ *
+ * @note Not thread safe, use it from the cocos thread only.
+ */
+template <typename T>
+class NodePool : public NodePoolBase
+{
+    static_assert(std::is_base_of<Node, T>::value, "NodePool: Only accept derived of Node!");
+
+public:
+    /** Creates a new node, it may be autoreleased since the pool retains it. */
+    typedef std::function<T*()> CreateCallback;
+    /** Restores a recycled node to its initial state. */
+    typedef std::function<void(T*)> ResetCallback;
+
+    NodePool(const std::string& name, const CreateCallback& createCallback, const ResetCallback& resetCallback = nullptr)
+    : NodePoolBase(name)
+    , _createCallback(createCallback)
+    , _resetCallback(resetCallback)
+    {
+        CCASSERT(_createCallback, "NodePool needs a create callback");
+    }
+
+    virtual ~NodePool()
+    {
+        for (auto& slot : _slots)
+        {
+            setNodePool(slot.node, nullptr, 0);
+            slot.node->release();
+        }
+    }
+
+    /** Creates nodes ahead of time so that the next count acquisitions are hits. */
+    void reserve(ssize_t count)
+    {
+        while (getFreeCount() < count)
+        {
+            auto node = createNode();
+            if (node == nullptr)
+                break;
+            _freeSlots.push_back(getNodePoolSlot(node));
+        }
+    }
+
+    /**
+     * Gets a node from the pool, creating one if none is free.
+     * @param handle Optional, receives a generational handle of the returned node.
+     * @return The node, or nullptr if the create callback failed.
+     */
+    T* acquire(NodePoolHandle* handle = nullptr)
+    {
+        T* node = nullptr;
+        if (!_freeSlots.empty())
+        {
+            node = _slots[_freeSlots.back()].node;
+            _freeSlots.pop_back();
+            ++_hitCount;
+        }
+        else
+        {
+            node = createNode();
+            ++_missCount;
+            if (node == nullptr)
+                return nullptr;
+        }
+
+        auto& slot = _slots[getNodePoolSlot(node)];
+        slot.inUse = true;
+        if (handle)
+        {
+            *handle = NodePoolHandle(getNodePoolSlot(node), slot.generation);
+        }
+        return node;
+    }
+
+    /** Returns the node referenced by handle, or nullptr if it was recycled since. */
+    T* get(const NodePoolHandle& handle) const
+    {
+        if (handle.index >= _slots.size())
+            return nullptr;
+        const auto& slot = _slots[handle.index];
+        return (slot.inUse && slot.generation == handle.generation) ? slot.node : nullptr;
+    }
+
+    /** Returns the handle of a node currently acquired from this pool, or a null handle. */
+    NodePoolHandle getHandle(const T* node) const
+    {
+        if (node == nullptr || getNodePool(node) != this)
+            return NodePoolHandle();
+        const auto& slot = _slots[getNodePoolSlot(node)];
+        return slot.inUse ? NodePoolHandle(getNodePoolSlot(node), slot.generation) : NodePoolHandle();
+    }
+
+    virtual void recycle(Node* node) override
+    {
+        CCASSERT(node && getNodePool(node) == this, "Node doesn't belong to this pool");
+        auto index = getNodePoolSlot(node);
+        auto& slot = _slots[index];
+        if (!slot.inUse)
+            return;
+
+        // Mark it free first, so that a nested recycle of the same node does nothing
+        slot.inUse = false;
+        if (++slot.generation == 0)
+        {
+            slot.generation = 1;
+        }
+
+        if (node->getParent() != nullptr)
+        {
+            node->getParent()->removeChild(node, true);
+        }
+        if (_resetCallback)
+        {
+            _resetCallback(slot.node);
+        }
+
+        _freeSlots.push_back(index);
+        ++_recycleCount;
+    }
+
+    virtual ssize_t getSize() const override { return _slots.size(); }
+    virtual ssize_t getFreeCount() const override { return _freeSlots.size(); }
+
+protected:
+    struct Slot
+    {
+        T* node;
+        std::uint32_t generation;
+        bool inUse;
+    };
+
+    T* createNode()
+    {
+        T* node = _createCallback();
+        if (node == nullptr)
+            return nullptr;
+
+        CCASSERT(getNodePool(node) == nullptr, "Node already belongs to a pool");
+        node->retain();
+        setNodePool(node, this, static_cast<std::uint32_t>(_slots.size()));
+        _slots.push_back({node, 1, false});
+        return node;
+    }
+
+    CreateCallback _createCallback;
+    ResetCallback _resetCallback;
+    std::vector<Slot> _slots;
+    std::vector<std::uint32_t> _freeSlots;
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_NODE_POOL_H__
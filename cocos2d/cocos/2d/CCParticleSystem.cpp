@@ -47,12 +47,18 @@ THE SOFTWARE.
 
 #include <string>
 
+#if defined (__SSE__)
+#define USE_SSE
+#include <xmmintrin.h>
+#endif
+
 #include "2d/CCParticleBatchNode.h"
 #include "renderer/CCTextureAtlas.h"
 #include "base/base64.h"
 #include "base/ZipUtils.h"
 #include "base/CCDirector.h"
 #include "base/CCProfiling.h"
+#include "base/CCJobSystem.h"
 #include "base/ccUTF8.h"
 #include "renderer/CCTextureCache.h"
 #include "platform/CCFileUtils.h"
@@ -96,6 +102,68 @@ inline void normalize_point(float x, float y, particle_point* out)
     out->y = y * n;
 }
 
+// value[i] += delta[i] * dt
+static void integrateParticleValues(float* value, const float* delta, float dt, int count)
+{
+    int i = 0;
+#ifdef USE_SSE
+    __m128 dt4 = _mm_set1_ps(dt);
+    for (; i + 4 <= count; i += 4)
+    {
+        _mm_storeu_ps(value + i, _mm_add_ps(_mm_loadu_ps(value + i), _mm_mul_ps(_mm_loadu_ps(delta + i), dt4)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        value[i] += delta[i] * dt;
+    }
+}
+
+// same as the scalar loop of ParticleSystem::update in gravity mode, 4 particles at a time
+static int updateGravityModeParticles(ParticleData& data, const Vec2& gravity, float dt, int yCoordFlipped, int count)
+{
+    int i = 0;
+#ifdef USE_SSE
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 tolerance = _mm_set1_ps(MATH_TOLERANCE);
+    const __m128 gravityX = _mm_set1_ps(gravity.x);
+    const __m128 gravityY = _mm_set1_ps(gravity.y);
+    const __m128 dt4 = _mm_set1_ps(dt);
+    const __m128 flip = _mm_set1_ps(static_cast<float>(yCoordFlipped));
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x = _mm_loadu_ps(data.posx + i);
+        __m128 y = _mm_loadu_ps(data.posy + i);
+
+        // radial direction, left to zero like normalize_point() does for unit and tiny vectors
+        __m128 n = _mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y));
+        __m128 length = _mm_sqrt_ps(n);
+        __m128 valid = _mm_and_ps(_mm_cmpneq_ps(n, one), _mm_cmpge_ps(length, tolerance));
+        __m128 inverse = _mm_div_ps(one, length);
+        __m128 normalX = _mm_and_ps(valid, _mm_mul_ps(x, inverse));
+        __m128 normalY = _mm_and_ps(valid, _mm_mul_ps(y, inverse));
+
+        __m128 radialAccel = _mm_loadu_ps(data.modeA.radialAccel + i);
+        __m128 tangentialAccel = _mm_loadu_ps(data.modeA.tangentialAccel + i);
+        __m128 radialX = _mm_mul_ps(normalX, radialAccel);
+        __m128 radialY = _mm_mul_ps(normalY, radialAccel);
+        __m128 tangentialX = _mm_mul_ps(normalY, _mm_xor_ps(tangentialAccel, signMask));
+        __m128 tangentialY = _mm_mul_ps(normalX, tangentialAccel);
+
+        __m128 dirX = _mm_add_ps(_mm_loadu_ps(data.modeA.dirX + i), _mm_mul_ps(_mm_add_ps(_mm_add_ps(radialX, tangentialX), gravityX), dt4));
+        __m128 dirY = _mm_add_ps(_mm_loadu_ps(data.modeA.dirY + i), _mm_mul_ps(_mm_add_ps(_mm_add_ps(radialY, tangentialY), gravityY), dt4));
+        _mm_storeu_ps(data.modeA.dirX + i, dirX);
+        _mm_storeu_ps(data.modeA.dirY + i, dirY);
+
+        _mm_storeu_ps(data.posx + i, _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(dirX, dt4), flip)));
+        _mm_storeu_ps(data.posy + i, _mm_add_ps(y, _mm_mul_ps(_mm_mul_ps(dirY, dt4), flip)));
+    }
+#endif
+    // the remaining particles are left to the scalar loop
+    return i;
+}
+
 /**
  A more effect random number getter function, get from ejoy2d.
  */
@@ -188,6 +256,8 @@ void ParticleData::release()
 
 Vector<ParticleSystem*> ParticleSystem::__allInstances;
 float ParticleSystem::__totalParticleCountFactor = 1.0f;
+Vector<ParticleSystem*> ParticleSystem::__pendingUpdates;
+bool ParticleSystem::__parallelUpdateEnabled = false;
 
 ParticleSystem::ParticleSystem()
 : _isBlendAdditive(false)
@@ -222,9 +292,12 @@ ParticleSystem::ParticleSystem()
 , _blendFunc(BlendFunc::ALPHA_PREMULTIPLIED)
 , _opacityModifyRGB(false)
 , _yCoordFlipped(1)
+, _randomSeed(rand())
 , _positionType(PositionType::FREE)
 , _paused(false)
 , _sourcePositionCompatible(true) // In the furture this member's default value maybe false or be removed.
+, _updatePending(false)
+, _pendingUpdateDt(0)
 {
     modeA.gravity.setZero();
     modeA.speed = 0;
@@ -278,6 +351,68 @@ void ParticleSystem::setTotalParticleCountFactor(float factor)
     __totalParticleCountFactor = factor;
 }
 
+void ParticleSystem::setParallelUpdateEnabled(bool enabled)
+{
+    if (!enabled)
+    {
+        finishParallelUpdates();
+    }
+    __parallelUpdateEnabled = enabled;
+}
+
+bool ParticleSystem::isParallelUpdateEnabled()
+{
+    return __parallelUpdateEnabled;
+}
+
+void ParticleSystem::finishParallelUpdates()
+{
+    if (__pendingUpdates.empty())
+        return;
+
+    CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - finishParallelUpdates");
+
+    // Node transforms are cached lazily and are not safe to compute from several threads,
+    // so everything the quads need from the node graph is read here first.
+    const int count = static_cast<int>(__pendingUpdates.size());
+    std::vector<char> fillInJob(count);
+    for (int i = 0; i < count; ++i)
+    {
+        fillInJob[i] = __pendingUpdates.at(i)->prepareParticleQuads();
+    }
+
+    // Each job only writes its own particle data and its own quads. Systems sharing a
+    // ParticleBatchNode own disjoint ranges of the atlas, starting at their _atlasIndex.
+    JobSystem::getInstance()->parallelFor(count, [&fillInJob](int i) {
+        auto system = __pendingUpdates.at(i);
+        system->simulateParticles(system->_pendingUpdateDt);
+        if (fillInJob[i])
+        {
+            system->fillParticleQuads();
+        }
+    });
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto system = __pendingUpdates.at(i);
+        if (!fillInJob[i])
+        {
+            system->updateParticleQuads();
+        }
+        system->_transformSystemDirty = false;
+        system->_updatePending = false;
+
+        // only update gl buffer when visible
+        if (system->_visible && ! system->_batchNode)
+        {
+            system->postStep();
+        }
+    }
+    __pendingUpdates.clear();
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - finishParallelUpdates");
+}
+
 bool ParticleSystem::init()
 {
     return initWithTotalParticles(150);
@@ -612,7 +747,7 @@ void ParticleSystem::addParticles(int count)
 {
     if (_paused)
         return;
-    uint32_t RANDSEED = rand();
+    uint32_t RANDSEED = _randomSeed;
 
     int start = _particleCount;
     _particleCount += count;
@@ -798,6 +933,8 @@ dc[i] = (dc[i] - c[i]) / _particleData.timeToLive[i];\
             }
         }
     }
+
+    _randomSeed = RANDSEED;
 }
 
 void ParticleSystem::onEnter()
@@ -862,6 +999,11 @@ bool ParticleSystem::isFull()
 
 // ParticleSystem - MainLoop
 void ParticleSystem::update(float dt)
+{
+    updateParticles(dt, __parallelUpdateEnabled);
+}
+
+void ParticleSystem::updateParticles(float dt, bool allowParallel)
 {
     CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
 
@@ -926,121 +1068,127 @@ void ParticleSystem::update(float dt)
             }
         }
         
-        if (_emitterMode == Mode::GRAVITY)
+        if (allowParallel && _particleCount > 0)
         {
-            for (int i = 0 ; i < _particleCount; ++i)
+            if (_updatePending)
             {
-                particle_point tmp, radial = {0.0f, 0.0f}, tangential;
-                
-                // radial acceleration
-                if (_particleData.posx[i] || _particleData.posy[i])
-                {
-                    normalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
-                }
-                tangential = radial;
-                radial.x *= _particleData.modeA.radialAccel[i];
-                radial.y *= _particleData.modeA.radialAccel[i];
-                
-                // tangential acceleration
-                std::swap(tangential.x, tangential.y);
-                tangential.x *= - _particleData.modeA.tangentialAccel[i];
-                tangential.y *= _particleData.modeA.tangentialAccel[i];
-                
-                // (gravity + radial + tangential) * dt
-                tmp.x = radial.x + tangential.x + modeA.gravity.x;
-                tmp.y = radial.y + tangential.y + modeA.gravity.y;
-                tmp.x *= dt;
-                tmp.y *= dt;
-                
-                _particleData.modeA.dirX[i] += tmp.x;
-                _particleData.modeA.dirY[i] += tmp.y;
-                
-                // this is cocos2d-x v3.0
-                // if (_configName.length()>0 && _yCoordFlipped != -1)
-                
-                // this is cocos2d-x v3.0
-                tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
-                tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
-                _particleData.posx[i] += tmp.x;
-                _particleData.posy[i] += tmp.y;
+                // ticked twice before the jobs ran, catch up with the previous step now
+                simulateParticles(_pendingUpdateDt);
             }
-        }
-        else
-        {
-            //Why use so many for-loop separately instead of putting them together?
-            //When the processor needs to read from or write to a location in memory,
-            //it first checks whether a copy of that data is in the cache.
-            //And every property's memory of the particle system is continuous,
-            //for the purpose of improving cache hit rate, we should process only one property in one for-loop AFAP.
-            //It was proved to be effective especially for low-end machine. 
-            for (int i = 0; i < _particleCount; ++i)
+            else
             {
-                _particleData.modeB.angle[i] += _particleData.modeB.degreesPerSecond[i] * dt;
+                _updatePending = true;
+                __pendingUpdates.pushBack(this);
             }
+            _pendingUpdateDt = dt;
+
+            CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+            return;
+        }
+
+        simulateParticles(dt);
+        updateParticleQuads();
+        _transformSystemDirty = false;
+    }
+
+    // only update gl buffer when visible
+    if (_visible && ! _batchNode)
+    {
+        postStep();
+    }
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+}
+
+void ParticleSystem::simulateParticles(float dt)
+{
+    if (_emitterMode == Mode::GRAVITY)
+    {
+        int vectorized = updateGravityModeParticles(_particleData, modeA.gravity, dt, _yCoordFlipped, _particleCount);
+        for (int i = vectorized ; i < _particleCount; ++i)
+        {
+            particle_point tmp, radial = {0.0f, 0.0f}, tangential;
             
-            for (int i = 0; i < _particleCount; ++i)
+            // radial acceleration
+            if (_particleData.posx[i] || _particleData.posy[i])
             {
-                _particleData.modeB.radius[i] += _particleData.modeB.deltaRadius[i] * dt;
+                normalize_point(_particleData.posx[i], _particleData.posy[i], &radial);
             }
+            tangential = radial;
+            radial.x *= _particleData.modeA.radialAccel[i];
+            radial.y *= _particleData.modeA.radialAccel[i];
             
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
-            }
-            for (int i = 0; i < _particleCount; ++i)
-            {
-                _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
-            }
-        }
-        
-        //color r,g,b,a
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorR[i] += _particleData.deltaColorR[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorG[i] += _particleData.deltaColorG[i] * dt;
-        }
-        
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorB[i] += _particleData.deltaColorB[i] * dt;
+            // tangential acceleration
+            std::swap(tangential.x, tangential.y);
+            tangential.x *= - _particleData.modeA.tangentialAccel[i];
+            tangential.y *= _particleData.modeA.tangentialAccel[i];
+            
+            // (gravity + radial + tangential) * dt
+            tmp.x = radial.x + tangential.x + modeA.gravity.x;
+            tmp.y = radial.y + tangential.y + modeA.gravity.y;
+            tmp.x *= dt;
+            tmp.y *= dt;
+            
+            _particleData.modeA.dirX[i] += tmp.x;
+            _particleData.modeA.dirY[i] += tmp.y;
+            
+            // this is cocos2d-x v3.0
+            // if (_configName.length()>0 && _yCoordFlipped != -1)
+            
+            // this is cocos2d-x v3.0
+            tmp.x = _particleData.modeA.dirX[i] * dt * _yCoordFlipped;
+            tmp.y = _particleData.modeA.dirY[i] * dt * _yCoordFlipped;
+            _particleData.posx[i] += tmp.x;
+            _particleData.posy[i] += tmp.y;
         }
+    }
+    else
+    {
+        //Why use so many for-loop separately instead of putting them together?
+        //When the processor needs to read from or write to a location in memory,
+        //it first checks whether a copy of that data is in the cache.
+        //And every property's memory of the particle system is continuous,
+        //for the purpose of improving cache hit rate, we should process only one property in one for-loop AFAP.
+        //It was proved to be effective especially for low-end machine. 
+        integrateParticleValues(_particleData.modeB.angle, _particleData.modeB.degreesPerSecond, dt, _particleCount);
+        integrateParticleValues(_particleData.modeB.radius, _particleData.modeB.deltaRadius, dt, _particleCount);
         
-        for (int i = 0 ; i < _particleCount; ++i)
-        {
-            _particleData.colorA[i] += _particleData.deltaColorA[i] * dt;
-        }
-        //size
-        for (int i = 0 ; i < _particleCount; ++i)
+        for (int i = 0; i < _particleCount; ++i)
         {
-            _particleData.size[i] += (_particleData.deltaSize[i] * dt);
-            _particleData.size[i] = MAX(0, _particleData.size[i]);
+            _particleData.posx[i] = - cosf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i];
         }
-        //angle
-        for (int i = 0 ; i < _particleCount; ++i)
+        for (int i = 0; i < _particleCount; ++i)
         {
-            _particleData.rotation[i] += _particleData.deltaRotation[i] * dt;
+            _particleData.posy[i] = - sinf(_particleData.modeB.angle[i]) * _particleData.modeB.radius[i] * _yCoordFlipped;
         }
-        
-        updateParticleQuads();
-        _transformSystemDirty = false;
     }
-
-    // only update gl buffer when visible
-    if (_visible && ! _batchNode)
+    
+    //color r,g,b,a
+    integrateParticleValues(_particleData.colorR, _particleData.deltaColorR, dt, _particleCount);
+    integrateParticleValues(_particleData.colorG, _particleData.deltaColorG, dt, _particleCount);
+    integrateParticleValues(_particleData.colorB, _particleData.deltaColorB, dt, _particleCount);
+    integrateParticleValues(_particleData.colorA, _particleData.deltaColorA, dt, _particleCount);
+    //size
+    integrateParticleValues(_particleData.size, _particleData.deltaSize, dt, _particleCount);
+    for (int i = 0 ; i < _particleCount; ++i)
     {
-        postStep();
+        _particleData.size[i] = MAX(0, _particleData.size[i]);
     }
-
-    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystem - update");
+    //angle
+    integrateParticleValues(_particleData.rotation, _particleData.deltaRotation, dt, _particleCount);
 }
 
 void ParticleSystem::updateWithNoTime(void)
 {
-    this->update(0.0f);
+    if (__parallelUpdateEnabled)
+    {
+        // the quads are expected to be up to date on return, never defer this one
+        updateParticles(0.0f, false);
+    }
+    else
+    {
+        this->update(0.0f);
+    }
 }
 
 void ParticleSystem::updateParticleQuads()
@@ -1048,6 +1196,15 @@ void ParticleSystem::updateParticleQuads()
     //should be overridden
 }
 
+bool ParticleSystem::prepareParticleQuads()
+{
+    return false;
+}
+
+void ParticleSystem::fillParticleQuads()
+{
+}
+
 void ParticleSystem::postStep()
 {
     // should be overridden
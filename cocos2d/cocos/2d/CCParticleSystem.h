@@ -261,7 +261,7 @@ public:
     void stopSystem();
     /** Kill all living particles.
      */
-    void resetSystem();
+    virtual void resetSystem();
     /** Whether or not the system is full.
      *
      * @return True if the system is full.
@@ -272,6 +272,14 @@ public:
      should be overridden by subclasses. 
      */
     virtual void updateParticleQuads();
+    /** First half of updateParticleQuads() for parallel updates. Runs on the cocos thread and
+     reads whatever node state the quads depend on. Returns false when the subclass can not
+     fill its quads from another thread, in which case updateParticleQuads() is used instead.
+     */
+    virtual bool prepareParticleQuads();
+    /** Second half of updateParticleQuads(), may run on a worker thread after prepareParticleQuads().
+     */
+    virtual void fillParticleQuads();
     /** Update the VBO verts buffer which does not use batch node,
      should be overridden by subclasses. */
     virtual void postStep();
@@ -292,6 +300,26 @@ public:
      */
     virtual void setAutoRemoveOnFinish(bool var);
 
+    /** Sets the seed of the random numbers used to emit particles.
+     * Each particle system has its own random sequence, seeded with rand() when it is created,
+     * so an effect can be replayed identically by setting the same seed.
+     * @since v3.17
+     */
+    void setRandomSeed(unsigned int seed) { _randomSeed = seed; }
+    unsigned int getRandomSeed() const { return _randomSeed; }
+
+    /** Whether particle systems integrate their particles and fill their quads as parallel jobs.
+     * When enabled, update() only emits and retires particles; the rest of the work for every
+     * system ticked this frame is run on the JobSystem by finishParallelUpdates(). Default false.
+     */
+    static void setParallelUpdateEnabled(bool enabled);
+    static bool isParallelUpdateEnabled();
+
+    /** Runs the work deferred by update() when parallel updates are enabled, and waits for it.
+     * Director calls it right after the scheduler tick.
+     */
+    static void finishParallelUpdates();
+
     // mode A
     /** Gets the gravity.
      *
@@ -823,6 +851,11 @@ CC_CONSTRUCTOR_ACCESS:
 
 protected:
     virtual void updateBlendFunc();
+
+    /** Emits and retires particles, then integrates them now or defers that to finishParallelUpdates(). */
+    void updateParticles(float dt, bool allowParallel);
+    /** Moves, colors, resizes and rotates the living particles. Touches nothing but the particle data. */
+    void simulateParticles(float dt);
     
 private:
     friend class EngineDataManager;
@@ -980,6 +1013,9 @@ protected:
     /** does FlippedY variance of each particle */
     int _yCoordFlipped;
 
+    /** state of the random numbers of addParticles */
+    unsigned int _randomSeed;
+
 
     /** particles movement type: Free or Grouped
      @since v0.8
@@ -992,7 +1028,13 @@ protected:
     /** is sourcePosition compatible */
     bool _sourcePositionCompatible;
 
+    /** whether the system waits in __pendingUpdates, and the delta it will be simulated with */
+    bool _updatePending;
+    float _pendingUpdateDt;
+
     static Vector<ParticleSystem*> __allInstances;
+    static Vector<ParticleSystem*> __pendingUpdates;
+    static bool __parallelUpdateEnabled;
     
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystem);
@@ -0,0 +1,615 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "2d/CCParticleSystemGPU.h"
+
+#include <stddef.h>
+
+#include "renderer/CCGLProgram.h"
+#include "renderer/CCGLProgramCache.h"
+#include "renderer/CCRenderer.h"
+#include "renderer/CCTexture2D.h"
+#include "renderer/ccGLStateCache.h"
+#include "renderer/ccShaders.h"
+#include "base/CCDirector.h"
+#include "base/CCProfiling.h"
+#include "base/ccUTF8.h"
+
+// Transform feedback and instancing come from GL 3.x entry points, which are only
+// loaded on the platforms that use GLEW.
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_LINUX || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#define PARTICLE_GPU_TRANSFORM_FEEDBACK 1
+#else
+#define PARTICLE_GPU_TRANSFORM_FEEDBACK 0
+#endif
+
+NS_CC_BEGIN
+
+namespace {
+    // One particle as stored in the state buffers, the same order as the varyings of ccParticleGPU_Update_vert.
+    struct GPUParticle
+    {
+        GLfloat posDir[4];      // position, then direction (gravity) or angle and radius (radius mode)
+        GLfloat color[4];
+        GLfloat deltaColor[4];
+        GLfloat sizeRot[4];     // size, delta size, rotation, delta rotation
+        GLfloat life[4];        // time to live, then radial and tangential acceleration or degrees per second and delta radius
+        GLfloat start[2];
+    };
+
+    const struct {
+        const char* name;
+        GLint size;
+        size_t offset;
+        GLuint updateLocation;
+        GLint renderLocation;   // -1: not used for drawing
+    } s_particleAttributes[] = {
+        {"a_particlePosDir",     4, offsetof(GPUParticle, posDir),     0, 1},
+        {"a_particleColor",      4, offsetof(GPUParticle, color),      1, 2},
+        {"a_particleDeltaColor", 4, offsetof(GPUParticle, deltaColor), 2, -1},
+        {"a_particleSizeRot",    4, offsetof(GPUParticle, sizeRot),    3, 3},
+        {"a_particleLife",       4, offsetof(GPUParticle, life),       4, 4},
+        {"a_particleStart",      2, offsetof(GPUParticle, start),      5, 5},
+    };
+
+    const char* s_particleVaryings[] = {"v_posDir", "v_color", "v_deltaColor", "v_sizeRot", "v_life", "v_start"};
+
+    const char* SHADER_NAME_PARTICLE_GPU_UPDATE = "ShaderParticleGPU_Update";
+    const char* SHADER_NAME_PARTICLE_GPU = "ShaderParticleGPU";
+    const char* SHADER_HEADER_GLSL_140 = "#version 140\n";
+}
+
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+static GLProgram* getParticleProgram(bool updateProgram)
+{
+    auto cache = GLProgramCache::getInstance();
+    const char* key = updateProgram ? SHADER_NAME_PARTICLE_GPU_UPDATE : SHADER_NAME_PARTICLE_GPU;
+    GLProgram* program = cache->getGLProgram(key);
+    if (program)
+        return program;
+
+    program = new (std::nothrow) GLProgram();
+    bool initialized = false;
+    if (updateProgram)
+    {
+        // no fragment shader, the pass runs with GL_RASTERIZER_DISCARD
+        initialized = program->initWithByteArrays(ccParticleGPU_Update_vert, nullptr, SHADER_HEADER_GLSL_140, "");
+        if (initialized)
+        {
+            for (const auto& attribute : s_particleAttributes)
+            {
+                glBindAttribLocation(program->getProgram(), attribute.updateLocation, attribute.name);
+            }
+            glTransformFeedbackVaryings(program->getProgram(), sizeof(s_particleVaryings) / sizeof(s_particleVaryings[0]), s_particleVaryings, GL_INTERLEAVED_ATTRIBS);
+        }
+    }
+    else
+    {
+        initialized = program->initWithByteArrays(ccParticleGPU_vert, ccParticleGPU_frag, SHADER_HEADER_GLSL_140, "");
+        if (initialized)
+        {
+            for (const auto& attribute : s_particleAttributes)
+            {
+                if (attribute.renderLocation >= 0)
+                {
+                    glBindAttribLocation(program->getProgram(), attribute.renderLocation, attribute.name);
+                }
+            }
+        }
+    }
+
+    if (initialized && program->link())
+    {
+        program->updateUniforms();
+        cache->addGLProgram(program, key);
+        program->release();
+        return program;
+    }
+
+    CCLOG("cocos2d: ParticleSystemGPU: failed to build %s", key);
+    CC_SAFE_RELEASE(program);
+    return nullptr;
+}
+#endif
+
+ParticleSystemGPU::ParticleSystemGPU()
+: _gpuSimulated(false)
+, _updateProgram(nullptr)
+, _renderProgram(nullptr)
+, _cornerBuffer(0)
+, _currentBuffer(0)
+, _slotsInUse(0)
+{
+    memset(_stateBuffers, 0, sizeof(_stateBuffers));
+    memset(_updateVAOs, 0, sizeof(_updateVAOs));
+    memset(_renderVAOs, 0, sizeof(_renderVAOs));
+}
+
+ParticleSystemGPU::~ParticleSystemGPU()
+{
+    releaseGPUSimulation();
+}
+
+ParticleSystemGPU * ParticleSystemGPU::create()
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->init())
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::createWithTotalParticles(int numberOfParticles)
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->initWithTotalParticles(numberOfParticles))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::create(const std::string& filename)
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->initWithFile(filename))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+ParticleSystemGPU * ParticleSystemGPU::create(ValueMap &dictionary)
+{
+    ParticleSystemGPU *ret = new (std::nothrow) ParticleSystemGPU();
+    if (ret && ret->initWithDictionary(dictionary))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool ParticleSystemGPU::isTransformFeedbackSupported()
+{
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    // transform feedback is 3.0, instanced drawing 3.1 and instanced attributes 3.3
+    static const bool supported = glewIsSupported("GL_VERSION_3_3") != 0;
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool ParticleSystemGPU::initWithTotalParticles(int numberOfParticles)
+{
+    if (!ParticleSystemQuad::initWithTotalParticles(numberOfParticles))
+        return false;
+
+    releaseGPUSimulation();
+    if (!setupGPUSimulation())
+    {
+        CCLOG("cocos2d: ParticleSystemGPU: transform feedback unavailable, simulating on the CPU");
+    }
+    return true;
+}
+
+bool ParticleSystemGPU::setupGPUSimulation()
+{
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    if (_batchNode || !isTransformFeedbackSupported())
+        return false;
+
+    _updateProgram = getParticleProgram(true);
+    _renderProgram = getParticleProgram(false);
+    if (!_updateProgram || !_renderProgram)
+    {
+        _updateProgram = _renderProgram = nullptr;
+        return false;
+    }
+    _updateProgram->retain();
+    _renderProgram->retain();
+
+    // zeroed state means every slot starts out dead
+    std::vector<GPUParticle> zeros(_totalParticles);
+    glGenBuffers(2, &_stateBuffers[0]);
+    for (int i = 0; i < 2; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, _stateBuffers[i]);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(GPUParticle) * _totalParticles, zeros.data(), GL_DYNAMIC_COPY);
+    }
+
+    static const GLfloat corners[] = {
+        -0.5f, -0.5f,
+         0.5f, -0.5f,
+        -0.5f,  0.5f,
+         0.5f,  0.5f,
+    };
+    glGenBuffers(1, &_cornerBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, _cornerBuffer);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+
+    glGenVertexArrays(2, &_updateVAOs[0]);
+    glGenVertexArrays(2, &_renderVAOs[0]);
+    for (int i = 0; i < 2; ++i)
+    {
+        GL::bindVAO(_updateVAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, _stateBuffers[i]);
+        for (const auto& attribute : s_particleAttributes)
+        {
+            glEnableVertexAttribArray(attribute.updateLocation);
+            glVertexAttribPointer(attribute.updateLocation, attribute.size, GL_FLOAT, GL_FALSE, sizeof(GPUParticle), (GLvoid*)attribute.offset);
+        }
+
+        GL::bindVAO(_renderVAOs[i]);
+        glBindBuffer(GL_ARRAY_BUFFER, _cornerBuffer);
+        glEnableVertexAttribArray(GLProgram::VERTEX_ATTRIB_POSITION);
+        glVertexAttribPointer(GLProgram::VERTEX_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid*)0);
+        glBindBuffer(GL_ARRAY_BUFFER, _stateBuffers[i]);
+        for (const auto& attribute : s_particleAttributes)
+        {
+            if (attribute.renderLocation < 0)
+                continue;
+            glEnableVertexAttribArray(attribute.renderLocation);
+            glVertexAttribPointer(attribute.renderLocation, attribute.size, GL_FLOAT, GL_FALSE, sizeof(GPUParticle), (GLvoid*)attribute.offset);
+            glVertexAttribDivisor(attribute.renderLocation, 1);
+        }
+    }
+    GL::bindVAO(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CHECK_GL_ERROR_DEBUG();
+
+    _slotTimeToLive.assign(_totalParticles, 0.0f);
+    _emittedSlots.clear();
+    _emittedSlots.reserve(_totalParticles);
+    _slotsInUse = 0;
+    _currentBuffer = 0;
+    _particleCount = 0;
+    _gpuSimulated = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ParticleSystemGPU::releaseGPUSimulation()
+{
+    if (!_gpuSimulated)
+        return;
+
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    glDeleteVertexArrays(2, &_updateVAOs[0]);
+    glDeleteVertexArrays(2, &_renderVAOs[0]);
+    GL::bindVAO(0);
+    glDeleteBuffers(2, &_stateBuffers[0]);
+    glDeleteBuffers(1, &_cornerBuffer);
+#endif
+    memset(_stateBuffers, 0, sizeof(_stateBuffers));
+    memset(_updateVAOs, 0, sizeof(_updateVAOs));
+    memset(_renderVAOs, 0, sizeof(_renderVAOs));
+    _cornerBuffer = 0;
+
+    CC_SAFE_RELEASE_NULL(_updateProgram);
+    CC_SAFE_RELEASE_NULL(_renderProgram);
+
+    // _particleData only held staging data, there is nothing to hand over to the CPU path
+    _slotTimeToLive.clear();
+    _slotsInUse = 0;
+    _particleCount = 0;
+    _gpuSimulated = false;
+}
+
+void ParticleSystemGPU::update(float dt)
+{
+    if (!_gpuSimulated)
+    {
+        ParticleSystemQuad::update(dt);
+        return;
+    }
+
+    CC_PROFILER_START_CATEGORY(kProfilerCategoryParticles , "CCParticleSystemGPU - update");
+
+    // Same emission rules as ParticleSystem::updateParticles(). _particleCount is the number of
+    // living slots; addParticles() fills _particleData from index 0, used as a staging area.
+    const int living = _particleCount;
+    _particleCount = 0;
+    if (_isActive && _emissionRate)
+    {
+        float rate = 1.0f / _emissionRate;
+        int totalParticles = static_cast<int>(_totalParticles * __totalParticleCountFactor);
+
+        if (living < totalParticles)
+        {
+            _emitCounter += dt;
+            if (_emitCounter < 0.f)
+                _emitCounter = 0.f;
+        }
+
+        int emitCount = MIN(totalParticles - living, _emitCounter / rate);
+        addParticles(MAX(0, emitCount));
+        _emitCounter -= rate * emitCount;
+
+        _elapsed += dt;
+        if (_elapsed < 0.f)
+            _elapsed = 0.f;
+        if (_duration != DURATION_INFINITY && _duration < _elapsed)
+        {
+            this->stopSystem();
+        }
+    }
+
+    uploadEmittedParticles(_particleCount);
+    if (living > 0 || !_emittedSlots.empty())
+    {
+        stepGPUParticles(dt);
+    }
+
+    // same arithmetic as the shader, so the CPU knows which slots are alive without reading back
+    bool died = false;
+    int alive = 0;
+    _slotsInUse = 0;
+    for (int i = 0; i < _totalParticles; ++i)
+    {
+        float& timeToLive = _slotTimeToLive[i];
+        if (timeToLive > 0.0f)
+        {
+            timeToLive -= dt;
+            if (timeToLive > 0.0f)
+            {
+                ++alive;
+                _slotsInUse = i + 1;
+            }
+            else
+            {
+                died = true;
+            }
+        }
+    }
+    _particleCount = alive;
+
+    CC_PROFILER_STOP_CATEGORY(kProfilerCategoryParticles , "CCParticleSystemGPU - update");
+
+    if (died && _particleCount == 0 && _isAutoRemoveOnFinish)
+    {
+        this->unscheduleUpdate();
+        _parent->removeChild(this, true);
+    }
+}
+
+void ParticleSystemGPU::uploadEmittedParticles(int emitted)
+{
+    _emittedSlots.clear();
+    if (emitted <= 0)
+        return;
+
+    // the emission count is capped by the dead slots, so this always finds enough of them
+    for (int i = 0; i < _totalParticles && (int)_emittedSlots.size() < emitted; ++i)
+    {
+        if (_slotTimeToLive[i] <= 0.0f)
+        {
+            _emittedSlots.push_back(i);
+        }
+    }
+    emitted = (int)_emittedSlots.size();
+
+    std::vector<GPUParticle> staging(emitted);
+    const bool gravityMode = (_emitterMode == Mode::GRAVITY);
+    for (int i = 0; i < emitted; ++i)
+    {
+        GPUParticle& particle = staging[i];
+        particle.posDir[0] = _particleData.posx[i];
+        particle.posDir[1] = _particleData.posy[i];
+        particle.posDir[2] = gravityMode ? _particleData.modeA.dirX[i] : _particleData.modeB.angle[i];
+        particle.posDir[3] = gravityMode ? _particleData.modeA.dirY[i] : _particleData.modeB.radius[i];
+        particle.color[0] = _particleData.colorR[i];
+        particle.color[1] = _particleData.colorG[i];
+        particle.color[2] = _particleData.colorB[i];
+        particle.color[3] = _particleData.colorA[i];
+        particle.deltaColor[0] = _particleData.deltaColorR[i];
+        particle.deltaColor[1] = _particleData.deltaColorG[i];
+        particle.deltaColor[2] = _particleData.deltaColorB[i];
+        particle.deltaColor[3] = _particleData.deltaColorA[i];
+        particle.sizeRot[0] = _particleData.size[i];
+        particle.sizeRot[1] = _particleData.deltaSize[i];
+        particle.sizeRot[2] = _particleData.rotation[i];
+        particle.sizeRot[3] = _particleData.deltaRotation[i];
+        particle.life[0] = _particleData.timeToLive[i];
+        particle.life[1] = gravityMode ? _particleData.modeA.radialAccel[i] : _particleData.modeB.degreesPerSecond[i];
+        particle.life[2] = gravityMode ? _particleData.modeA.tangentialAccel[i] : _particleData.modeB.deltaRadius[i];
+        particle.life[3] = 0.0f;
+        particle.start[0] = _particleData.startPosX[i];
+        particle.start[1] = _particleData.startPosY[i];
+
+        _slotTimeToLive[_emittedSlots[i]] = _particleData.timeToLive[i];
+    }
+
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    // one upload per run of consecutive slots
+    glBindBuffer(GL_ARRAY_BUFFER, _stateBuffers[_currentBuffer]);
+    for (int first = 0; first < emitted; )
+    {
+        int last = first;
+        while (last + 1 < emitted && _emittedSlots[last + 1] == _emittedSlots[last] + 1)
+        {
+            ++last;
+        }
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(GPUParticle) * _emittedSlots[first], sizeof(GPUParticle) * (last - first + 1), &staging[first]);
+        first = last + 1;
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    CHECK_GL_ERROR_DEBUG();
+#endif
+}
+
+void ParticleSystemGPU::stepGPUParticles(float dt)
+{
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    _updateProgram->use();
+    _updateProgram->setUniformLocationWith1f(_updateProgram->getUniformLocation("u_dt"), dt);
+    _updateProgram->setUniformLocationWith2f(_updateProgram->getUniformLocation("u_gravity"), modeA.gravity.x, modeA.gravity.y);
+    _updateProgram->setUniformLocationWith1f(_updateProgram->getUniformLocation("u_yCoordFlipped"), (GLfloat)_yCoordFlipped);
+    _updateProgram->setUniformLocationWith1i(_updateProgram->getUniformLocation("u_radiusMode"), _emitterMode == Mode::RADIUS ? 1 : 0);
+
+    // every slot is stepped, so the target buffer never keeps stale particles around
+    const int next = 1 - _currentBuffer;
+    GL::bindVAO(_updateVAOs[_currentBuffer]);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _stateBuffers[next]);
+    glEnable(GL_RASTERIZER_DISCARD);
+    glBeginTransformFeedback(GL_POINTS);
+    glDrawArrays(GL_POINTS, 0, _totalParticles);
+    glEndTransformFeedback();
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    GL::bindVAO(0);
+    _currentBuffer = next;
+
+    CHECK_GL_ERROR_DEBUG();
+#else
+    (void)dt;
+#endif
+}
+
+void ParticleSystemGPU::resetSystem()
+{
+    ParticleSystemQuad::resetSystem();
+    if (!_gpuSimulated)
+        return;
+
+    std::fill(_slotTimeToLive.begin(), _slotTimeToLive.end(), 0.0f);
+    _slotsInUse = 0;
+    _particleCount = 0;
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    // the next step reads this buffer and rewrites the other one entirely
+    std::vector<GPUParticle> zeros(_totalParticles);
+    glBindBuffer(GL_ARRAY_BUFFER, _stateBuffers[_currentBuffer]);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GPUParticle) * _totalParticles, zeros.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+}
+
+void ParticleSystemGPU::setTotalParticles(int tp)
+{
+    const bool gpuSimulated = _gpuSimulated;
+    releaseGPUSimulation();
+    ParticleSystemQuad::setTotalParticles(tp);
+    if (gpuSimulated)
+    {
+        setupGPUSimulation();
+    }
+}
+
+void ParticleSystemGPU::setBatchNode(ParticleBatchNode* batchNode)
+{
+    if (batchNode)
+    {
+        // batched particles are filled into the batch node's atlas, which only the CPU path does
+        releaseGPUSimulation();
+        ParticleSystemQuad::setBatchNode(batchNode);
+    }
+    else
+    {
+        ParticleSystemQuad::setBatchNode(batchNode);
+        if (!_gpuSimulated && _quads)
+        {
+            setupGPUSimulation();
+        }
+    }
+}
+
+void ParticleSystemGPU::draw(Renderer *renderer, const Mat4 &transform, uint32_t flags)
+{
+    if (!_gpuSimulated)
+    {
+        ParticleSystemQuad::draw(renderer, transform, flags);
+        return;
+    }
+    if (_slotsInUse == 0 || !_texture)
+        return;
+
+    // the shader applies the same offsets as ParticleSystemQuad::fillParticleQuads()
+    if (_positionType == PositionType::FREE)
+    {
+        Vec2 currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        _drawStartTransform = getWorldToNodeTransform();
+        Vec3 origin(currentPosition.x, currentPosition.y, 0);
+        _drawStartTransform.transformPoint(&origin);
+        _drawOrigin.set(origin.x, origin.y);
+    }
+    else if (_positionType == PositionType::RELATIVE)
+    {
+        _drawStartTransform = Mat4::IDENTITY;
+        _drawOrigin = _position;
+    }
+    else
+    {
+        _drawStartTransform = Mat4::ZERO;
+        _drawOrigin = Vec2::ZERO;
+    }
+
+    _customCommand.init(_globalZOrder, transform, flags);
+    _customCommand.func = CC_CALLBACK_0(ParticleSystemGPU::onDraw, this, transform, flags);
+    renderer->addCommand(&_customCommand);
+}
+
+void ParticleSystemGPU::onDraw(const Mat4 &transform, uint32_t /*flags*/)
+{
+#if PARTICLE_GPU_TRANSFORM_FEEDBACK
+    _renderProgram->use();
+    _renderProgram->setUniformsForBuiltins(transform);
+    _renderProgram->setUniformLocationWith2f(_renderProgram->getUniformLocation("u_origin"), _drawOrigin.x, _drawOrigin.y);
+    _renderProgram->setUniformLocationWithMatrix4fv(_renderProgram->getUniformLocation("u_startTransform"), _drawStartTransform.m, 1);
+    // every quad shares the texture coordinates set by initTexCoordsWithRect()
+    const auto& quad = _quads[0];
+    _renderProgram->setUniformLocationWith4f(_renderProgram->getUniformLocation("u_texRect"),
+                                             quad.bl.texCoords.u, quad.bl.texCoords.v, quad.tr.texCoords.u, quad.tr.texCoords.v);
+    _renderProgram->setUniformLocationWith1f(_renderProgram->getUniformLocation("u_opacityModifyRGB"), _opacityModifyRGB ? 1.0f : 0.0f);
+
+    GL::bindTexture2D(_texture);
+    GL::blendFunc(_blendFunc.src, _blendFunc.dst);
+
+    GL::bindVAO(_renderVAOs[_currentBuffer]);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, _slotsInUse);
+    GL::bindVAO(0);
+
+    CC_INCREMENT_GL_DRAWN_BATCHES_AND_VERTICES(1, 4 * _slotsInUse);
+    CHECK_GL_ERROR_DEBUG();
+#else
+    (void)transform;
+#endif
+}
+
+std::string ParticleSystemGPU::getDescription() const
+{
+    return StringUtils::format("<ParticleSystemGPU | Tag = %d, Total Particles = %d, GPU = %d>", _tag, _totalParticles, _gpuSimulated ? 1 : 0);
+}
+
+NS_CC_END
@@ -0,0 +1,129 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_PARTICLE_SYSTEM_GPU_H__
+#define __CC_PARTICLE_SYSTEM_GPU_H__
+
+#include "2d/CCParticleSystemQuad.h"
+#include "renderer/CCCustomCommand.h"
+#include <vector>
+
+NS_CC_BEGIN
+
+class GLProgram;
+
+/**
+ * @addtogroup _2d
+ * @{
+ */
+
+/** @class ParticleSystemGPU
+ * @brief A ParticleSystemQuad that keeps its particles in GPU buffers.
+
+Particles are emitted on the CPU exactly like ParticleSystem does, uploaded once, then
+stepped by a vertex shader whose output is captured with transform feedback, and drawn as
+one instanced quad per particle. Nothing is rebuilt or uploaded per particle per frame,
+which is what limits ParticleSystemQuad for very large effects.
+
+It accepts the same plist files and properties as ParticleSystemQuad. It needs desktop
+OpenGL 3.3 (available on Linux and Windows builds, including Mesa's llvmpipe with
+LIBGL_ALWAYS_SOFTWARE=1); everywhere else, or inside a ParticleBatchNode, it silently
+behaves like a ParticleSystemQuad.
+
+Limitations of the GPU path:
+- Particles are never read back, getParticleCount() is tracked on the CPU.
+- Particles may be drawn in a different order than ParticleSystemQuad draws them.
+@js NA
+*/
+class CC_DLL ParticleSystemGPU : public ParticleSystemQuad
+{
+public:
+    /** Creates a Particle Emitter. */
+    static ParticleSystemGPU * create();
+    /** Creates a Particle Emitter with a number of particles. */
+    static ParticleSystemGPU * createWithTotalParticles(int numberOfParticles);
+    /** Creates and initializes a ParticleSystemGPU from a plist file. */
+    static ParticleSystemGPU * create(const std::string& filename);
+    /** Creates a Particle Emitter with a dictionary. */
+    static ParticleSystemGPU * create(ValueMap &dictionary);
+
+    /** Whether the current GL context can run the GPU path. */
+    static bool isTransformFeedbackSupported();
+
+    /** Whether this emitter is simulated on the GPU, false when it fell back to ParticleSystemQuad. */
+    bool isGPUSimulated() const { return _gpuSimulated; }
+
+    virtual void update(float dt) override;
+    virtual void resetSystem() override;
+    virtual void setTotalParticles(int tp) override;
+    virtual void setBatchNode(ParticleBatchNode* batchNode) override;
+    virtual void draw(Renderer *renderer, const Mat4 &transform, uint32_t flags) override;
+    virtual std::string getDescription() const override;
+
+CC_CONSTRUCTOR_ACCESS:
+    ParticleSystemGPU();
+    virtual ~ParticleSystemGPU();
+
+    virtual bool initWithTotalParticles(int numberOfParticles) override;
+
+protected:
+    bool setupGPUSimulation();
+    void releaseGPUSimulation();
+    void uploadEmittedParticles(int emitted);
+    void stepGPUParticles(float dt);
+    void onDraw(const Mat4 &transform, uint32_t flags);
+
+    bool _gpuSimulated;
+
+    GLProgram* _updateProgram;
+    GLProgram* _renderProgram;
+
+    GLuint _stateBuffers[2];    // ping-pong particle state
+    GLuint _updateVAOs[2];      // reads _stateBuffers[i] for the transform feedback pass
+    GLuint _renderVAOs[2];      // reads _stateBuffers[i] as instance data
+    GLuint _cornerBuffer;
+    int _currentBuffer;         // the buffer holding the latest state
+
+    /** CPU copy of each slot's time to live, stepped with the same arithmetic as the shader */
+    std::vector<float> _slotTimeToLive;
+    /** slots written by the current update, ascending */
+    std::vector<int> _emittedSlots;
+    /** one past the highest living slot, the number of instances to draw */
+    int _slotsInUse;
+
+    // computed in draw() for onDraw()
+    Vec2 _drawOrigin;
+    Mat4 _drawStartTransform;
+    CustomCommand _customCommand;
+
+private:
+    CC_DISALLOW_COPY_AND_ASSIGN(ParticleSystemGPU);
+};
+
+// end of _2d group
+/// @}
+
+NS_CC_END
+
+#endif //__CC_PARTICLE_SYSTEM_GPU_H__
@@ -31,6 +31,12 @@ THE SOFTWARE.
 #include "2d/CCParticleSystemQuad.h"
 
 #include <algorithm>
+#include <string.h>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
 
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCParticleBatchNode.h"
@@ -50,6 +56,7 @@ ParticleSystemQuad::ParticleSystemQuad()
 :_quads(nullptr)
 ,_indices(nullptr)
 ,_VAOname(0)
+,_startQuad(nullptr)
 {
     memset(_buffersVBO, 0, sizeof(_buffersVBO));
 }
@@ -259,6 +266,60 @@ void ParticleSystemQuad::initIndices()
     }
 }
 
+// same clamping as updateParticleQuadColors, for the particles it leaves
+static inline GLubyte particleColorToByte(float value)
+{
+    return static_cast<GLubyte>(clampf(value * 255, 0.0f, 255.0f));
+}
+
+// fill the colors of the 4 vertices of the quads, the components are clamped to [0, 255]
+static int updateParticleQuadColors(V3F_C4B_T2F_Quad* quad, const ParticleData& data, bool opacityModifyRGB, int count)
+{
+    int i = 0;
+#ifdef USE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 4 <= count; i += 4, quad += 4)
+    {
+        __m128 a = _mm_loadu_ps(data.colorA + i);
+        __m128 r = _mm_loadu_ps(data.colorR + i);
+        __m128 g = _mm_loadu_ps(data.colorG + i);
+        __m128 b = _mm_loadu_ps(data.colorB + i);
+        if (opacityModifyRGB)
+        {
+            r = _mm_mul_ps(r, a);
+            g = _mm_mul_ps(g, a);
+            b = _mm_mul_ps(b, a);
+        }
+
+        __m128i r8 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(r, scale), zero), scale));
+        __m128i g8 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(g, scale), zero), scale));
+        __m128i b8 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(b, scale), zero), scale));
+        __m128i a8 = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_mul_ps(a, scale), zero), scale));
+        __m128i rgba = _mm_or_si128(_mm_or_si128(r8, _mm_slli_epi32(g8, 8)),
+                                    _mm_or_si128(_mm_slli_epi32(b8, 16), _mm_slli_epi32(a8, 24)));
+
+        // Color4B is laid out as r, g, b, a
+        uint32_t colors[4];
+        _mm_storeu_si128((__m128i*)colors, rgba);
+        for (int k = 0; k < 4; ++k)
+        {
+            memcpy(&quad[k].bl.colors, &colors[k], sizeof(Color4B));
+            memcpy(&quad[k].br.colors, &colors[k], sizeof(Color4B));
+            memcpy(&quad[k].tl.colors, &colors[k], sizeof(Color4B));
+            memcpy(&quad[k].tr.colors, &colors[k], sizeof(Color4B));
+        }
+    }
+#else
+    (void)quad;
+    (void)data;
+    (void)opacityModifyRGB;
+    (void)count;
+#endif
+    // the remaining particles are left to the scalar loop
+    return i;
+}
+
 inline void updatePosWithParticle(V3F_C4B_T2F_Quad *quad, const Vec2& newPosition,float size,float rotation)
 {
     // vertices
@@ -306,33 +367,50 @@ void ParticleSystemQuad::updateParticleQuads()
         return;
     }
  
-    Vec2 currentPosition;
+    prepareParticleQuads();
+    fillParticleQuads();
+}
+
+bool ParticleSystemQuad::prepareParticleQuads()
+{
     if (_positionType == PositionType::FREE)
     {
-        currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        _currentPosition = this->convertToWorldSpace(Vec2::ZERO);
+        _worldToNodeTransform = getWorldToNodeTransform();
     }
     else if (_positionType == PositionType::RELATIVE)
     {
-        currentPosition = _position;
+        _currentPosition = _position;
     }
     
-    V3F_C4B_T2F_Quad *startQuad;
-    Vec2 pos = Vec2::ZERO;
+    _quadsOffset = Vec2::ZERO;
     if (_batchNode)
     {
         V3F_C4B_T2F_Quad *batchQuads = _batchNode->getTextureAtlas()->getQuads();
-        startQuad = &(batchQuads[_atlasIndex]);
-        pos = _position;
+        _startQuad = &(batchQuads[_atlasIndex]);
+        _quadsOffset = _position;
     }
     else
     {
-        startQuad = &(_quads[0]);
+        _startQuad = _quads;
+    }
+    return true;
+}
+
+void ParticleSystemQuad::fillParticleQuads()
+{
+    if (_particleCount <= 0) {
+        return;
     }
+
+    const Vec2& currentPosition = _currentPosition;
+    const Vec2& pos = _quadsOffset;
+    V3F_C4B_T2F_Quad *startQuad = _startQuad;
     
     if( _positionType == PositionType::FREE )
     {
         Vec3 p1(currentPosition.x, currentPosition.y, 0);
-        Mat4 worldToNodeTM = getWorldToNodeTransform();
+        const Mat4& worldToNodeTM = _worldToNodeTransform;
         worldToNodeTM.transformPoint(&p1);
         Vec3 p2;
         Vec2 newPos;
@@ -391,20 +469,21 @@ void ParticleSystemQuad::updateParticleQuads()
     }
     
     //set color
+    int vectorized = updateParticleQuadColors(startQuad, _particleData, _opacityModifyRGB, _particleCount);
     if(_opacityModifyRGB)
     {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
+        V3F_C4B_T2F_Quad* quad = startQuad + vectorized;
+        float* r = _particleData.colorR + vectorized;
+        float* g = _particleData.colorG + vectorized;
+        float* b = _particleData.colorB + vectorized;
+        float* a = _particleData.colorA + vectorized;
         
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
+        for (int i = vectorized; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
         {
-            GLubyte colorR = *r * *a * 255;
-            GLubyte colorG = *g * *a * 255;
-            GLubyte colorB = *b * *a * 255;
-            GLubyte colorA = *a * 255;
+            GLubyte colorR = particleColorToByte(*r * *a);
+            GLubyte colorG = particleColorToByte(*g * *a);
+            GLubyte colorB = particleColorToByte(*b * *a);
+            GLubyte colorA = particleColorToByte(*a);
             quad->bl.colors.set(colorR, colorG, colorB, colorA);
             quad->br.colors.set(colorR, colorG, colorB, colorA);
             quad->tl.colors.set(colorR, colorG, colorB, colorA);
@@ -413,18 +492,18 @@ void ParticleSystemQuad::updateParticleQuads()
     }
     else
     {
-        V3F_C4B_T2F_Quad* quad = startQuad;
-        float* r = _particleData.colorR;
-        float* g = _particleData.colorG;
-        float* b = _particleData.colorB;
-        float* a = _particleData.colorA;
+        V3F_C4B_T2F_Quad* quad = startQuad + vectorized;
+        float* r = _particleData.colorR + vectorized;
+        float* g = _particleData.colorG + vectorized;
+        float* b = _particleData.colorB + vectorized;
+        float* a = _particleData.colorA + vectorized;
         
-        for (int i = 0; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
+        for (int i = vectorized; i < _particleCount; ++i,++quad,++r,++g,++b,++a)
         {
-            GLubyte colorR = *r * 255;
-            GLubyte colorG = *g * 255;
-            GLubyte colorB = *b * 255;
-            GLubyte colorA = *a * 255;
+            GLubyte colorR = particleColorToByte(*r);
+            GLubyte colorG = particleColorToByte(*g);
+            GLubyte colorB = particleColorToByte(*b);
+            GLubyte colorA = particleColorToByte(*a);
             quad->bl.colors.set(colorR, colorG, colorB, colorA);
             quad->br.colors.set(colorR, colorG, colorB, colorA);
             quad->tl.colors.set(colorR, colorG, colorB, colorA);
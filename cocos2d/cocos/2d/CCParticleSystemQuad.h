@@ -121,6 +121,16 @@ public:
      * @lua NA
      */    
     virtual void updateParticleQuads() override;
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual bool prepareParticleQuads() override;
+    /**
+     * @js NA
+     * @lua NA
+     */
+    virtual void fillParticleQuads() override;
     /**
      * @js NA
      * @lua NA
@@ -185,6 +195,12 @@ protected:
     GLuint              _buffersVBO[2]; //0: vertex  1: indices
 
     QuadCommand _quadCommand;           // quad command
+
+    // computed by prepareParticleQuads() for fillParticleQuads()
+    V3F_C4B_T2F_Quad    *_startQuad;
+    Vec2                _quadsOffset;
+    Vec2                _currentPosition;
+    Mat4                _worldToNodeTransform;
     
 
 
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "2d/CCAnimationCache.h"
 #include "2d/CCSpriteFrame.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCDynamicAtlas.h"
 #include "renderer/CCTextureCache.h"
 #include "renderer/CCTexture2D.h"
 #include "renderer/CCRenderer.h"
@@ -176,6 +177,13 @@ bool Sprite::initWithFile(const std::string& filename)
     _fileName = filename;
     _fileType = 0;
 
+    // small images may share a page of the dynamic atlas
+    SpriteFrame *spriteFrame = DynamicAtlas::getInstance()->getSpriteFrame(filename);
+    if (spriteFrame)
+    {
+        return initWithSpriteFrame(spriteFrame);
+    }
+
     Texture2D *texture = _director->getTextureCache()->addImage(filename);
     if (texture)
     {
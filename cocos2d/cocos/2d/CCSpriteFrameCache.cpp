@@ -35,6 +35,7 @@ THE SOFTWARE.
 
 #include "2d/CCSprite.h"
 #include "2d/CCAutoPolygon.h"
+#include "2d/CCDynamicAtlas.h"
 #include "platform/CCFileUtils.h"
 #include "base/CCNS.h"
 #include "base/ccMacros.h"
@@ -427,6 +428,27 @@ void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& fra
     _spriteFramesCache.insertFrame("by#addSpriteFrame()", frameName, frame);
 }
 
+bool SpriteFrameCache::addSpriteFrameWithFile(const std::string& filename)
+{
+    SpriteFrame* frame = DynamicAtlas::getInstance()->getSpriteFrame(filename);
+    if (!frame)
+    {
+        Texture2D* texture = Director::getInstance()->getTextureCache()->addImage(filename);
+        if (!texture)
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture %s", filename.c_str());
+            return false;
+        }
+
+        Rect rect = Rect::ZERO;
+        rect.size = texture->getContentSize();
+        frame = SpriteFrame::createWithTexture(texture, rect);
+    }
+
+    _spriteFramesCache.insertFrame("by#addSpriteFrameWithFile()", filename, frame);
+    return true;
+}
+
 void SpriteFrameCache::removeSpriteFrames()
 {
     _spriteFramesAliases.clear();
@@ -215,6 +215,16 @@ public:
      */
     void addSpriteFrame(SpriteFrame *frame, const std::string& frameName);
 
+    /** Adds a sprite frame for a loose image file, named after the file.
+     If the DynamicAtlas is enabled the image is packed into a shared page, otherwise the frame
+     covers the whole texture of the image.
+     *
+     * @param filename The image file name, also used as the name of the sprite frame.
+     * @return True if the image was loaded.
+     * @since v3.17
+     */
+    bool addSpriteFrameWithFile(const std::string& filename);
+
     /** Check if multiple Sprite Frames from a plist file have been loaded.
     * @js NA
     * @lua NA
@@ -616,6 +616,12 @@ void TMXLayer::setTileGID(uint32_t gid, const Vec2& pos, TMXTileFlags flags)
                 updateTileForGID(gidAndFlags, pos);
             }
         }
+
+        // removeTileAt() already notified the change
+        if (gid != 0 && _tileChangedCallback)
+        {
+            _tileChangedCallback(this, pos);
+        }
     }
 }
 
@@ -640,6 +646,11 @@ void TMXLayer::removeChild(Node* node, bool cleanup)
     _tiles[zz] = 0;
     ccCArrayRemoveValueAtIndex(_atlasIndexArray, atlasIndex);
     SpriteBatchNode::removeChild(sprite, cleanup);
+
+    if (_tileChangedCallback)
+    {
+        _tileChangedCallback(this, Vec2(zz % (int)_layerSize.width, zz / (int)_layerSize.width));
+    }
 }
 
 void TMXLayer::removeTileAt(const Vec2& pos)
@@ -680,6 +691,11 @@ void TMXLayer::removeTileAt(const Vec2& pos)
                 }
             }
         }
+
+        if (_tileChangedCallback)
+        {
+            _tileChangedCallback(this, pos);
+        }
     }
 }
 
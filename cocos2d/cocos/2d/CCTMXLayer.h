@@ -181,6 +181,19 @@ public:
 
     /** Creates the tiles. */
     void setupTiles();
+
+    /** Callback invoked after a tile has changed. */
+    typedef std::function<void(TMXLayer* layer, const Vec2& tileCoordinate)> TileChangedCallback;
+
+    /** Set the callback invoked after a tile changed through setTileGID(), removeTileAt() or removeChild().
+     * Used by PhysicsTMXLayerBaker to rebuild the colliders of the changed tiles.
+     *
+     * @param callback The callback, nullptr to remove it.
+     */
+    void setTileChangedCallback(const TileChangedCallback& callback) { _tileChangedCallback = callback; }
+
+    /** Get the callback invoked after a tile changed. */
+    const TileChangedCallback& getTileChangedCallback() const { return _tileChangedCallback; }
     
     /** Get the layer name. 
      *
@@ -353,6 +366,8 @@ protected:
     int _hexSideLength;
     /** properties from the layer. They can be added using Tiled */
     ValueMap _properties;
+    /** invoked after a tile has changed */
+    TileChangedCallback _tileChangedCallback;
 };
 
 // end of tilemap_parallax_nodes group
@@ -63,11 +63,14 @@ cocos2d.cpp \
 2d/CCMotionStreak.cpp \
 2d/CCNode.cpp \
 2d/CCNodeGrid.cpp \
+2d/CCNodePool.cpp \
+2d/CCDynamicAtlas.cpp \
 2d/CCParallaxNode.cpp \
 2d/CCParticleBatchNode.cpp \
 2d/CCParticleExamples.cpp \
 2d/CCParticleSystem.cpp \
 2d/CCParticleSystemQuad.cpp \
+2d/CCParticleSystemGPU.cpp \
 2d/CCProgressTimer.cpp \
 2d/CCProtectedNode.cpp \
 2d/CCRenderTexture.cpp \
@@ -90,6 +93,7 @@ cocos2d.cpp \
 3d/CCFrustum.cpp \
 3d/CCPlane.cpp \
 platform/CCFileUtils.cpp \
+platform/CCFileView.cpp \
 platform/CCGLView.cpp \
 platform/CCImage.cpp \
 platform/CCSAXParser.cpp \
@@ -107,6 +111,7 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCJobSystem.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -202,6 +207,7 @@ physics/CCPhysicsBody.cpp \
 physics/CCPhysicsContact.cpp \
 physics/CCPhysicsJoint.cpp \
 physics/CCPhysicsShape.cpp \
+physics/CCPhysicsTMXLayerBaker.cpp \
 physics/CCPhysicsWorld.cpp \
 physics3d/CCPhysics3D.cpp \
 physics3d/CCPhysics3DWorld.cpp \
@@ -0,0 +1,226 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioDecoderWav"
+
+#include "audio/linux/AudioDecoderWav.h"
+#include "audio/linux/AudioMacros.h"
+#include "platform/CCFileUtils.h"
+
+#include <string.h>
+
+namespace cocos2d { namespace experimental {
+
+    static const uint16_t WAVE_FORMAT_PCM = 0x0001;
+    static const uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+    static const uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+    static uint16_t readLE16(const unsigned char* p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    static uint32_t readLE32(const unsigned char* p)
+    {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+            | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    AudioDecoderWav::AudioDecoderWav()
+    : _file(nullptr)
+    , _dataOffset(0)
+    , _sourceBytesPerSample(0)
+    , _isFloat(false)
+    , _currentFrame(0)
+    {
+    }
+
+    AudioDecoderWav::~AudioDecoderWav()
+    {
+        close();
+    }
+
+    bool AudioDecoderWav::open(const char* path)
+    {
+        std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
+
+        do
+        {
+            _file = fopen(FileUtils::getInstance()->getSuitableFOpen(fullPath).c_str(), "rb");
+            BREAK_IF_ERR_LOG(_file == nullptr, "Can't open %s", fullPath.c_str());
+
+            unsigned char header[12];
+            BREAK_IF_ERR_LOG(fread(header, 1, sizeof(header), _file) != sizeof(header), "%s is too small", fullPath.c_str());
+            BREAK_IF_ERR_LOG(memcmp(header, "RIFF", 4) != 0 || memcmp(header + 8, "WAVE", 4) != 0, "%s isn't a RIFF WAVE file", fullPath.c_str());
+
+            uint16_t format = 0;
+            uint32_t bitsPerSample = 0;
+            uint32_t dataSize = 0;
+            bool hasFormat = false;
+            unsigned char chunk[8];
+            while (fread(chunk, 1, sizeof(chunk), _file) == sizeof(chunk))
+            {
+                uint32_t chunkSize = readLE32(chunk + 4);
+                if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+                {
+                    unsigned char fmt[40] = { 0 };
+                    uint32_t fmtSize = chunkSize < sizeof(fmt) ? chunkSize : sizeof(fmt);
+                    if (fread(fmt, 1, fmtSize, _file) != fmtSize)
+                        break;
+
+                    format = readLE16(fmt);
+                    _channelCount = readLE16(fmt + 2);
+                    _sampleRate = readLE32(fmt + 4);
+                    bitsPerSample = readLE16(fmt + 14);
+                    if (format == WAVE_FORMAT_EXTENSIBLE && fmtSize >= 26)
+                    {
+                        // The sub format GUID starts with the actual format tag.
+                        format = readLE16(fmt + 24);
+                    }
+                    hasFormat = true;
+                    // Chunks are word aligned.
+                    fseek(_file, (chunkSize - fmtSize) + (chunkSize & 1), SEEK_CUR);
+                }
+                else if (memcmp(chunk, "data", 4) == 0)
+                {
+                    dataSize = chunkSize;
+                    _dataOffset = ftell(_file);
+                    break;
+                }
+                else
+                {
+                    fseek(_file, chunkSize + (chunkSize & 1), SEEK_CUR);
+                }
+            }
+
+            BREAK_IF_ERR_LOG(!hasFormat || _dataOffset == 0, "%s has no fmt or data chunk", fullPath.c_str());
+            BREAK_IF_ERR_LOG(_channelCount < 1 || _channelCount > 2, "%s has %u channels, only mono and stereo are supported", fullPath.c_str(), _channelCount);
+
+            _isFloat = (format == WAVE_FORMAT_IEEE_FLOAT);
+            BREAK_IF_ERR_LOG(!(format == WAVE_FORMAT_PCM && (bitsPerSample == 8 || bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32))
+                && !(_isFloat && bitsPerSample == 32), "%s has an unsupported format 0x%x, %u bits", fullPath.c_str(), format, bitsPerSample);
+
+            _sourceBytesPerSample = bitsPerSample / 8;
+            _bytesPerFrame = _channelCount * sizeof(int16_t);
+            _totalFrames = dataSize / (_sourceBytesPerSample * _channelCount);
+            _currentFrame = 0;
+
+            _isOpened = true;
+            return true;
+        } while (false);
+
+        if (_file != nullptr)
+        {
+            fclose(_file);
+            _file = nullptr;
+        }
+        return false;
+    }
+
+    void AudioDecoderWav::close()
+    {
+        if (isOpened())
+        {
+            fclose(_file);
+            _file = nullptr;
+            _readBuffer.clear();
+            _readBuffer.shrink_to_fit();
+            _isOpened = false;
+        }
+    }
+
+    uint32_t AudioDecoderWav::read(uint32_t framesToRead, char* pcmBuf)
+    {
+        if (_currentFrame + framesToRead > _totalFrames)
+        {
+            framesToRead = _totalFrames - _currentFrame;
+        }
+        if (framesToRead == 0)
+            return 0;
+
+        const uint32_t sampleCount = framesToRead * _channelCount;
+        _readBuffer.resize(sampleCount * _sourceBytesPerSample);
+        const uint32_t framesRead = static_cast<uint32_t>(fread(_readBuffer.data(), _sourceBytesPerSample * _channelCount, framesToRead, _file));
+        const uint32_t samplesRead = framesRead * _channelCount;
+
+        const unsigned char* src = _readBuffer.data();
+        int16_t* dst = reinterpret_cast<int16_t*>(pcmBuf);
+        switch (_sourceBytesPerSample)
+        {
+        case 1:
+            for (uint32_t i = 0; i < samplesRead; ++i)
+                dst[i] = static_cast<int16_t>((src[i] - 128) << 8);
+            break;
+        case 2:
+            for (uint32_t i = 0; i < samplesRead; ++i)
+                dst[i] = static_cast<int16_t>(readLE16(src + i * 2));
+            break;
+        case 3:
+            for (uint32_t i = 0; i < samplesRead; ++i)
+                dst[i] = static_cast<int16_t>(readLE16(src + i * 3 + 1));
+            break;
+        case 4:
+            if (_isFloat)
+            {
+                for (uint32_t i = 0; i < samplesRead; ++i)
+                {
+                    uint32_t bits = readLE32(src + i * 4);
+                    float value;
+                    memcpy(&value, &bits, sizeof(value));
+                    value = value > 1.0f ? 1.0f : (value < -1.0f ? -1.0f : value);
+                    dst[i] = static_cast<int16_t>(value * 32767.0f);
+                }
+            }
+            else
+            {
+                for (uint32_t i = 0; i < samplesRead; ++i)
+                    dst[i] = static_cast<int16_t>(readLE16(src + i * 4 + 2));
+            }
+            break;
+        default:
+            break;
+        }
+
+        _currentFrame += framesRead;
+        return framesRead;
+    }
+
+    bool AudioDecoderWav::seek(uint32_t frameOffset)
+    {
+        if (frameOffset > _totalFrames)
+            return false;
+
+        if (fseek(_file, _dataOffset + static_cast<long>(frameOffset) * _sourceBytesPerSample * _channelCount, SEEK_SET) != 0)
+            return false;
+
+        _currentFrame = frameOffset;
+        return true;
+    }
+
+    uint32_t AudioDecoderWav::tell() const
+    {
+        return _currentFrame;
+    }
+
+}} // namespace cocos2d { namespace experimental {
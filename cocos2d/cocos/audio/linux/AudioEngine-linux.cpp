@@ -1,18 +1,19 @@
 /****************************************************************************
+ Copyright (c) 2015-2016 Chukong Technologies Inc.
  Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
- 
+
  http://www.cocos2d-x.org
- 
+
  Permission is hereby granted, free of charge, to any person obtaining a copy
  of this software and associated documentation files (the "Software"), to deal
  in the Software without restriction, including without limitation the rights
  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
  copies of the Software, and to permit persons to whom the Software is
  furnished to do so, subject to the following conditions:
- 
+
  The above copyright notice and this permission notice shall be included in
  all copies or substantial portions of the Software.
- 
+
  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
@@ -25,9 +26,17 @@
 /**
  * @author cesarpachon
  */
+#define LOG_TAG "AudioEngine-linux"
+
 #include <cstring>
 #include <cstdint>
+#include <cstdarg>
 #include "audio/linux/AudioEngine-linux.h"
+#include "audio/linux/AudioDecoder.h"
+#include "audio/linux/AudioDecoderManager.h"
+#include "audio/linux/AudioOutputDevice.h"
+#include "audio/linux/AudioStream.h"
+#include "audio/linux/AudioMacros.h"
 
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
@@ -36,326 +45,372 @@
 using namespace cocos2d;
 using namespace cocos2d::experimental;
 
-AudioEngineImpl * g_AudioEngineImpl = nullptr;
+static const uint32_t OUTPUT_SAMPLE_RATE = 44100;
+static const uint32_t OUTPUT_FRAMES_PER_BUFFER = 512;
+static const uint32_t DECODE_FRAMES_PER_READ = 4096;
+// Sounds bigger than this once decoded are streamed, like background music.
+static const uint32_t PCMDATA_CACHEMAXSIZE = 1048576;
 
-void ERRCHECKWITHEXIT(FMOD_RESULT result)
+void audioLog(const char * format, ...)
 {
-    if (result != FMOD_OK) {
-        printf("FMOD error! (%d) %s\n", result, FMOD_ErrorString(result));
-    }
+    char buf[1024];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    fprintf(stderr, "%s\n", buf);
 }
 
-bool ERRCHECK(FMOD_RESULT result)
+static std::shared_ptr<PcmData> loadFile(const std::string& fullPath)
 {
-    if (result != FMOD_OK) {
-        printf("FMOD error! (%d) %s\n", result, FMOD_ErrorString(result));
-        return true;
+    AudioDecoder* decoder = AudioDecoderManager::createDecoder(fullPath.c_str());
+    if (decoder == nullptr)
+    {
+        ALOGE("Unsupported audio file %s", fullPath.c_str());
+        return nullptr;
     }
-    return false;
-}
 
-FMOD_RESULT F_CALLBACK channelCallback(FMOD_CHANNELCONTROL *channelcontrol,
-                                       FMOD_CHANNELCONTROL_TYPE controltype,
-                                       FMOD_CHANNELCONTROL_CALLBACK_TYPE callbacktype,
-                                       void *commandData1, void *commandData2)
-{
-    if (controltype == FMOD_CHANNELCONTROL_CHANNEL && callbacktype == FMOD_CHANNELCONTROL_CALLBACK_END) {
-        g_AudioEngineImpl->onSoundFinished((FMOD::Channel *)channelcontrol);
+    std::shared_ptr<PcmData> pcm;
+    if (decoder->open(fullPath.c_str()))
+    {
+        pcm = std::make_shared<PcmData>();
+        pcm->sampleRate = decoder->getSampleRate();
+        pcm->channelCount = decoder->getChannelCount();
+        if (static_cast<uint64_t>(decoder->getTotalFrames()) * decoder->getBytesPerFrame() > PCMDATA_CACHEMAXSIZE)
+        {
+            pcm->frameCount = decoder->getTotalFrames();
+            pcm->streamed = true;
+            AudioDecoderManager::destroyDecoder(decoder);
+            return pcm;
+        }
+
+        pcm->samples.reserve(decoder->getTotalFrames() * pcm->channelCount);
+
+        std::vector<int16_t> buffer(DECODE_FRAMES_PER_READ * pcm->channelCount);
+        uint32_t framesRead;
+        while ((framesRead = decoder->read(DECODE_FRAMES_PER_READ, reinterpret_cast<char*>(buffer.data()))) > 0)
+        {
+            pcm->samples.insert(pcm->samples.end(), buffer.begin(), buffer.begin() + framesRead * pcm->channelCount);
+        }
+        pcm->frameCount = static_cast<uint32_t>(pcm->samples.size() / pcm->channelCount);
+
+        if (pcm->frameCount == 0)
+        {
+            ALOGE("No audio frames in %s", fullPath.c_str());
+            pcm = nullptr;
+        }
     }
-    return FMOD_OK;
+    else
+    {
+        ALOGE("Can't decode %s", fullPath.c_str());
+    }
+
+    AudioDecoderManager::destroyDecoder(decoder);
+    return pcm;
 }
 
 AudioEngineImpl::AudioEngineImpl()
+: _mixer(nullptr)
+, _currentAudioID(0)
+, _scheduler(nullptr)
+, _lifeTracker(std::make_shared<bool>(true))
 {
 }
 
 AudioEngineImpl::~AudioEngineImpl()
 {
-    FMOD_RESULT result;
-    result = pSystem->close();
-    ERRCHECKWITHEXIT(result);
-    result = pSystem->release();
-    ERRCHECKWITHEXIT(result);
+    *_lifeTracker = false;
+    if (_scheduler != nullptr)
+    {
+        _scheduler->unschedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this);
+    }
+
+    // Stops the mixer thread before releasing the sounds it reads.
+    delete _mixer;
+    _instances.clear();
+    _pcmCache.clear();
+
+    AudioDecoderManager::destroy();
 }
 
 bool AudioEngineImpl::init()
 {
-    FMOD_RESULT result;
-    /*
-    Create a System object and initialize.
-    */
-    result = FMOD::System_Create(&pSystem);
-    ERRCHECKWITHEXIT(result);
+    if (!AudioDecoderManager::init())
+        return false;
+
+    _mixer = new (std::nothrow) AudioMixer(MAX_MIXER_VOICES, OUTPUT_SAMPLE_RATE, OUTPUT_FRAMES_PER_BUFFER);
+    if (_mixer == nullptr)
+        return false;
+    _mixer->start(AudioOutputDevice::create(OUTPUT_SAMPLE_RATE, 2, OUTPUT_FRAMES_PER_BUFFER));
+
+    _scheduler = Director::getInstance()->getScheduler();
+    _scheduler->schedule(CC_SCHEDULE_SELECTOR(AudioEngineImpl::update), this, 0.0f, false);
+
+    return true;
+}
+
+void AudioEngineImpl::load(const std::string& fullPath, const std::function<void(const std::shared_ptr<PcmData>&)>& callback)
+{
+    auto cached = _pcmCache.find(fullPath);
+    if (cached != _pcmCache.end())
+    {
+        callback(cached->second);
+        return;
+    }
+
+    auto& callbacks = _loadingCallbacks[fullPath];
+    callbacks.push_back(callback);
+    if (callbacks.size() > 1)
+    {
+        // Already being decoded.
+        return;
+    }
 
-    result = pSystem->setOutput(FMOD_OUTPUTTYPE_AUTODETECT);
-    ERRCHECKWITHEXIT(result);
+    auto lifeTracker = _lifeTracker;
+    AudioEngine::addTask([this, fullPath, lifeTracker](){
+        std::shared_ptr<PcmData> pcm = loadFile(fullPath);
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([this, fullPath, lifeTracker, pcm](){
+            if (!*lifeTracker)
+                return;
 
-    result = pSystem->init(32, FMOD_INIT_NORMAL, 0);
-    ERRCHECKWITHEXIT(result);
+            if (pcm)
+            {
+                _pcmCache[fullPath] = pcm;
+            }
+
+            auto it = _loadingCallbacks.find(fullPath);
+            if (it == _loadingCallbacks.end())
+                return;
+            auto callbacks = std::move(it->second);
+            _loadingCallbacks.erase(it);
+            for (const auto& callback : callbacks)
+            {
+                callback(pcm);
+            }
+        });
+    });
+}
 
-    mapChannelInfo.clear();
-    mapSound.clear();
+int AudioEngineImpl::play2d(const std::string &filePath, bool loop, float volume)
+{
+    if (_mixer == nullptr)
+        return AudioEngine::INVALID_AUDIO_ID;
+
+    int audioID = _currentAudioID++;
+    auto instance = new AudioInstance();
+    instance->filePath = filePath;
+    instance->position = 0;
+    instance->volume = volume;
+    instance->loop = loop;
+    instance->submitted = false;
+    instance->stopped = false;
+    _instances[audioID].reset(instance);
+
+    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
+    load(fullPath, [this, audioID, fullPath](const std::shared_ptr<PcmData>& pcm){
+        onLoaded(audioID, fullPath, pcm);
+    });
+
+    // A cached sound starts synchronously, and the instance is already gone if it couldn't.
+    return _instances.count(audioID) ? audioID : AudioEngine::INVALID_AUDIO_ID;
+}
 
-    auto scheduler = cocos2d::Director::getInstance()->getScheduler();
-    scheduler->schedule(schedule_selector(AudioEngineImpl::update), this, 0.05f, false);
+void AudioEngineImpl::onLoaded(int audioID, const std::string& fullPath, const std::shared_ptr<PcmData>& pcm)
+{
+    auto it = _instances.find(audioID);
+    if (it == _instances.end())
+        return;
+
+    AudioInstance* instance = it->second.get();
+    if (!instance->stopped && pcm)
+    {
+        instance->pcm = pcm;
+        bool played;
+        if (pcm->streamed)
+        {
+            instance->stream.reset(new AudioStream(fullPath, OUTPUT_SAMPLE_RATE, instance->loop));
+            played = _mixer->play(audioID, instance->stream.get(), &instance->position, instance->volume, instance->loop);
+        }
+        else
+        {
+            played = _mixer->play(audioID, pcm.get(), &instance->position, instance->volume, instance->loop);
+        }
 
-    g_AudioEngineImpl = this;
+        if (played)
+        {
+            instance->submitted = true;
+            AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PLAYING;
+            return;
+        }
+    }
 
-    return true;
+    if (!instance->stopped)
+    {
+        AudioEngine::remove(audioID);
+    }
+    _instances.erase(it);
 }
 
-int AudioEngineImpl::play2d(const std::string &fileFullPath, bool loop, float volume)
+AudioEngineImpl::AudioInstance* AudioEngineImpl::findInstance(int audioID)
 {
-    int id = preload(fileFullPath, nullptr);
-    if (id >= 0) {
-        mapChannelInfo[id].loop=loop;
-        mapChannelInfo[id].channel->setPaused(true);
-        mapChannelInfo[id].volume = volume;
-        AudioEngine::_audioIDInfoMap[id].state = AudioEngine::AudioState::PAUSED;
-        resume(id);
+    auto it = _instances.find(audioID);
+    if (it == _instances.end() || it->second->stopped)
+    {
+        ALOGW("Invalid audioID: %d", audioID);
+        return nullptr;
     }
-    return id;
+    return it->second.get();
 }
 
 void AudioEngineImpl::setVolume(int audioID, float volume)
 {
-    try {
-        mapChannelInfo[audioID].channel->setVolume(volume);
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::setVolume: invalid audioID: %d\n", audioID);
+    AudioInstance* instance = findInstance(audioID);
+    if (instance)
+    {
+        instance->volume = volume;
+        if (instance->submitted)
+            _mixer->setVolume(audioID, volume);
     }
 }
 
 void AudioEngineImpl::setLoop(int audioID, bool loop)
 {
-    try {
-        mapChannelInfo[audioID].channel->setLoopCount(loop ? -1 : 0);
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::setLoop: invalid audioID: %d\n", audioID);
+    AudioInstance* instance = findInstance(audioID);
+    if (instance)
+    {
+        instance->loop = loop;
+        if (instance->stream)
+            instance->stream->setLoop(loop);
+        // the voice of a stream keeps the flag too, so that looping music isn't stolen first
+        if (instance->submitted)
+            _mixer->setLoop(audioID, loop);
     }
 }
 
 bool AudioEngineImpl::pause(int audioID)
 {
-    try {
-        mapChannelInfo[audioID].channel->setPaused(true);
-        AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PAUSED;
-        return true;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::pause: invalid audioID: %d\n", audioID);
-        return false;
-    }
+    AudioInstance* instance = findInstance(audioID);
+    return instance && instance->submitted && _mixer->pause(audioID);
 }
 
 bool AudioEngineImpl::resume(int audioID)
 {
-    try {
-        if (!mapChannelInfo[audioID].channel) {
-            FMOD::Channel *channel = nullptr;
-            FMOD::ChannelGroup *channelgroup = nullptr;
-            //starts the sound in pause mode, use the channel to unpause
-            FMOD_RESULT result = pSystem->playSound(mapChannelInfo[audioID].sound, channelgroup, true, &channel);
-            if (ERRCHECK(result)) {
-                return false;
-            }
-            channel->setMode(mapChannelInfo[audioID].loop ? FMOD_LOOP_NORMAL : FMOD_LOOP_OFF);
-            channel->setLoopCount(mapChannelInfo[audioID].loop ? -1 : 0);
-            channel->setVolume(mapChannelInfo[audioID].volume);
-            channel->setUserData(reinterpret_cast<void *>(static_cast<std::intptr_t>(mapChannelInfo[audioID].id)));
-            mapChannelInfo[audioID].channel = channel;
-        }
-
-        mapChannelInfo[audioID].channel->setPaused(false);
-        AudioEngine::_audioIDInfoMap[audioID].state = AudioEngine::AudioState::PLAYING;
-
-        return true;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::resume: invalid audioID: %d\n", audioID);
-        return false;
-    }
+    AudioInstance* instance = findInstance(audioID);
+    return instance && instance->submitted && _mixer->resume(audioID);
 }
 
 bool AudioEngineImpl::stop(int audioID)
 {
-    try {
-        mapChannelInfo[audioID].channel->stop();
-        mapChannelInfo[audioID].channel = nullptr;
-        return true;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::stop: invalid audioID: %d\n", audioID);
+    AudioInstance* instance = findInstance(audioID);
+    if (instance == nullptr)
         return false;
-    }
+
+    // The instance is released when the mixer reports the voice, or when the sound has been decoded.
+    instance->stopped = true;
+    if (instance->submitted)
+        _mixer->stopVoice(audioID);
+    return true;
 }
 
 void AudioEngineImpl::stopAll()
 {
-    for (auto& it : mapChannelInfo) {
-        ChannelInfo & audioRef = it.second;
-        audioRef.channel->stop();
-        audioRef.channel = nullptr;
+    for (auto& it : _instances)
+    {
+        it.second->stopped = true;
     }
+    _mixer->stopAll();
 }
 
 float AudioEngineImpl::getDuration(int audioID)
 {
-    try {
-        FMOD::Sound * sound = mapChannelInfo[audioID].sound;
-        unsigned int length;
-        FMOD_RESULT result = sound->getLength(&length, FMOD_TIMEUNIT_MS);
-        ERRCHECK(result);
-        float duration = (float)length / 1000.0f;
-        return duration;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::getDuration: invalid audioID: %d\n", audioID);
-        return AudioEngine::TIME_UNKNOWN;
+    AudioInstance* instance = findInstance(audioID);
+    if (instance && instance->pcm)
+    {
+        return instance->pcm->getDuration();
     }
+    return AudioEngine::TIME_UNKNOWN;
 }
 
 float AudioEngineImpl::getCurrentTime(int audioID)
 {
-    try {
-        unsigned int position;
-        FMOD_RESULT result = mapChannelInfo[audioID].channel->getPosition(&position, FMOD_TIMEUNIT_MS);
-        ERRCHECK(result);
-        float currenttime = position /1000.0f;
-        return currenttime;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::getCurrentTime: invalid audioID: %d\n", audioID);
-        return AudioEngine::TIME_UNKNOWN;
+    AudioInstance* instance = findInstance(audioID);
+    if (instance && instance->pcm)
+    {
+        return static_cast<float>(instance->position.load(std::memory_order_relaxed)) / instance->pcm->sampleRate;
     }
+    return 0.0f;
 }
 
 bool AudioEngineImpl::setCurrentTime(int audioID, float time)
 {
-    bool ret = false;
-    try {
-        unsigned int position = (unsigned int)(time * 1000.0f);
-        FMOD_RESULT result = mapChannelInfo[audioID].channel->setPosition(position, FMOD_TIMEUNIT_MS);
-        ret = !ERRCHECK(result);
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::setCurrentTime: invalid audioID: %d\n", audioID);
-    }
-    return ret;
-}
+    AudioInstance* instance = findInstance(audioID);
+    if (instance == nullptr || !instance->submitted || time < 0.0f || time >= instance->pcm->getDuration())
+        return false;
 
-void AudioEngineImpl::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
-{
-    try {
-        FMOD::Channel * channel = mapChannelInfo[audioID].channel;
-        mapChannelInfo[audioID].callback = callback;
-        FMOD_RESULT result = channel->setCallback(channelCallback);
-        ERRCHECK(result);
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::setFinishCallback: invalid audioID: %d\n", audioID);
+    auto frame = static_cast<uint32_t>(time * instance->pcm->sampleRate);
+    instance->position = frame;
+    if (instance->stream)
+    {
+        instance->stream->seek(frame);
+        return true;
     }
+    return _mixer->seek(audioID, frame);
 }
 
-void AudioEngineImpl::onSoundFinished(FMOD::Channel * channel)
+void AudioEngineImpl::setFinishCallback(int audioID, const std::function<void (int, const std::string &)> &callback)
 {
-    int id = 0;
-    try {
-        void * data;
-        channel->getUserData(&data);
-        id = static_cast<int>(reinterpret_cast<std::intptr_t>(data));
-        if (mapChannelInfo[id].callback) {
-            mapChannelInfo[id].callback(id, mapChannelInfo[id].path);
-        }
-        mapChannelInfo[id].channel = nullptr;
-    }
-    catch (const std::out_of_range& oor) {
-        printf("AudioEngineImpl::onSoundFinished: invalid audioID: %d\n", id);
+    AudioInstance* instance = findInstance(audioID);
+    if (instance)
+    {
+        instance->finishCallback = callback;
     }
 }
 
-void AudioEngineImpl::uncache(const std::string& path)
+void AudioEngineImpl::uncache(const std::string& filePath)
 {
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
-    std::map<std::string, FMOD::Sound *>::const_iterator it = mapSound.find(fullPath);
-    if (it!=mapSound.end()) {
-        FMOD::Sound * sound = it->second;
-        if (sound) {
-            sound->release();
-        }
-        mapSound.erase(it);
-    }
-    if (mapId.find(path) != mapId.end())
-        mapId.erase(path);
+    // Playing instances keep their sound alive.
+    _pcmCache.erase(FileUtils::getInstance()->fullPathForFilename(filePath));
 }
 
 void AudioEngineImpl::uncacheAll()
 {
-    for (const auto& it : mapSound) {
-        auto sound = it.second;
-        if (sound) {
-            sound->release();
-        }
-    }
-    mapSound.clear();
-    mapId.clear();
+    _pcmCache.clear();
 }
 
 int AudioEngineImpl::preload(const std::string& filePath, std::function<void(bool isSuccess)> callback)
 {
-    FMOD::Sound * sound = findSound(filePath);
-    if (!sound) {
-        std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filePath);
-        FMOD_RESULT result = pSystem->createSound(fullPath.c_str(), FMOD_LOOP_OFF, 0, &sound);
-        if (ERRCHECK(result)) {
-            printf("sound effect in %s could not be preload\n", filePath.c_str());
-            if (callback) {
-                callback(false);
-            }
-            return -1;
+    load(FileUtils::getInstance()->fullPathForFilename(filePath), [callback](const std::shared_ptr<PcmData>& pcm){
+        if (callback)
+        {
+            callback(pcm != nullptr);
         }
-        mapSound[fullPath] = sound;
-    }
-
-    int id = static_cast<int>(mapChannelInfo.size()) + 1;
-    if (mapId.find(filePath) == mapId.end())
-        mapId.insert({filePath, id});
-    else
-        id = mapId.at(filePath);
-
-    auto& chanelInfo = mapChannelInfo[id];
-    chanelInfo.sound = sound;
-    chanelInfo.id = id;
-    chanelInfo.channel = nullptr;
-    chanelInfo.callback = nullptr;
-    chanelInfo.path = filePath;
-    //we are going to use UserData to store pointer to Channel when playing
-    chanelInfo.sound->setUserData(reinterpret_cast<void *>(static_cast<std::intptr_t>(id)));
-
-    if (callback) {
-        callback(true);
-    }
-    return id;
+    });
+    return 0;
 }
 
 void AudioEngineImpl::update(float dt)
 {
-    pSystem->update();
-}
-
-FMOD::Sound * AudioEngineImpl::findSound(const std::string &path)
-{
-    std::string fullPath = FileUtils::getInstance()->fullPathForFilename(path);
-    std::map<std::string, FMOD::Sound *>::const_iterator it = mapSound.find(fullPath);
-    return (it != mapSound.end()) ? (it->second) : nullptr;
-}
+    AudioMixer::Event event;
+    while (_mixer->pollEvent(event))
+    {
+        auto it = _instances.find(event.audioID);
+        if (it == _instances.end())
+            continue;
+
+        std::unique_ptr<AudioInstance> instance = std::move(it->second);
+        _instances.erase(it);
+        if (instance->stopped)
+            continue;
+
+        if (event.type == AudioMixer::EventType::STOLEN)
+        {
+            ALOGV("Audio %d cut, more than %d sounds are playing", event.audioID, MAX_MIXER_VOICES);
+        }
 
-FMOD::Channel * AudioEngineImpl::getChannel(FMOD::Sound *sound)
-{
-    void * data;
-    sound->getUserData(&data);
-    int id = static_cast<int>(reinterpret_cast<std::intptr_t>(data));
-    return mapChannelInfo[id].channel;
+        AudioEngine::remove(event.audioID);
+        if (instance->finishCallback)
+        {
+            instance->finishCallback(event.audioID, instance->filePath);
+        }
+    }
 }
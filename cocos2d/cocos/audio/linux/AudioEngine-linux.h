@@ -22,6 +22,7 @@
  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  THE SOFTWARE.
  ****************************************************************************/
+
 #include "platform/CCPlatformConfig.h"
 
 #if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
@@ -29,18 +30,24 @@
 #ifndef __AUDIO_ENGINE_LINUX_H_
 #define __AUDIO_ENGINE_LINUX_H_
 
+#include <atomic>
 #include <functional>
-#include <iostream>
-#include <map>
-#include "fmod.hpp"
-#include "fmod_errors.h"
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include "audio/include/AudioEngine.h"
+#include "audio/linux/AudioMixer.h"
+#include "audio/linux/AudioStream.h"
 
 #include "base/CCRef.h"
 
 NS_CC_BEGIN
+    class Scheduler;
+
     namespace experimental{
-#define MAX_AUDIOINSTANCES 32
+#define MAX_AUDIOINSTANCES 256
+/** The number of sounds heard at the same time, the quietest sound is cut when another one starts. */
+#define MAX_MIXER_VOICES 64
 
 class CC_DLL AudioEngineImpl : public cocos2d::Ref
 {
@@ -69,38 +76,37 @@ public:
     
     void update(float dt);
     
-    /**
-     * used internally by ffmod callback 
-     */ 
-    void onSoundFinished(FMOD::Channel * channel); 
-    
 private:
-  
-    /**
-    * returns null if a sound with the given path is not found
-    */
-    FMOD::Sound * findSound(const std::string &path);
-  
-    FMOD::Channel * getChannel(FMOD::Sound *);
-  
-    struct ChannelInfo{
-        int id;
-        std::string path; 
-        FMOD::Sound * sound;
-        FMOD::Channel * channel; 
-        bool loop; 
-        float volume; 
-        std::function<void (int, const std::string &)> callback;
+    struct AudioInstance
+    {
+        std::string filePath;
+        std::shared_ptr<PcmData> pcm;
+        std::unique_ptr<AudioStream> stream;
+        std::atomic<uint32_t> position;
+        float volume;
+        bool loop;
+        bool submitted;     // the mixer owns a voice, or will answer with an event
+        bool stopped;       // AudioEngine has forgotten the id
+        std::function<void (int, const std::string &)> finishCallback;
     };
-    
-    std::map<int, ChannelInfo> mapChannelInfo;
 
-    std::map<std::string, int> mapId;
-    
-    std::map<std::string, FMOD::Sound *> mapSound;  
-    
-    FMOD::System* pSystem;
-    
+    /** Decodes a file on the AudioEngine thread pool, calling back on the cocos thread. */
+    void load(const std::string& fullPath, const std::function<void(const std::shared_ptr<PcmData>&)>& callback);
+    void onLoaded(int audioID, const std::string& fullPath, const std::shared_ptr<PcmData>& pcm);
+    AudioInstance* findInstance(int audioID);
+
+    // decoded sounds, by full path
+    std::unordered_map<std::string, std::shared_ptr<PcmData>> _pcmCache;
+    // callbacks waiting for a file being decoded, by full path
+    std::unordered_map<std::string, std::vector<std::function<void(const std::shared_ptr<PcmData>&)>>> _loadingCallbacks;
+
+    // instances are kept until the mixer has released their voice
+    std::unordered_map<int, std::unique_ptr<AudioInstance>> _instances;
+
+    AudioMixer* _mixer;
+    int _currentAudioID;
+    Scheduler* _scheduler;
+    std::shared_ptr<bool> _lifeTracker;
 };
 }
 NS_CC_END
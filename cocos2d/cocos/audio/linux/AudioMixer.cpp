@@ -0,0 +1,542 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioMixer"
+
+#include "audio/linux/AudioMixer.h"
+#include "audio/linux/AudioOutputDevice.h"
+#include "audio/linux/AudioStream.h"
+#include "audio/linux/AudioMacros.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace cocos2d { namespace experimental {
+
+namespace {
+
+    const uint32_t COMMAND_QUEUE_SIZE = 1024;
+    const uint32_t EVENT_QUEUE_SIZE = 1024;
+    const uint32_t OUTPUT_CHANNELS = 2;
+    const uint64_t FIXED_ONE = 1ull << 32;
+    const float FIXED_TO_FLOAT = 1.0f / 4294967296.0f;
+    const float SAMPLE_TO_FLOAT = 1.0f / 32768.0f;
+
+    // Adds frames at the output sample rate, the loop is simple enough to be vectorized by the compiler.
+    template <int CHANNELS>
+    void mixFrames(const int16_t* __restrict src, float* __restrict out, uint32_t frameCount, float gain, float gainStep)
+    {
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            float g = gain + gainStep * i;
+            if (CHANNELS == 1)
+            {
+                float s = src[i] * g;
+                out[i * 2] += s;
+                out[i * 2 + 1] += s;
+            }
+            else
+            {
+                out[i * 2] += src[i * 2] * g;
+                out[i * 2 + 1] += src[i * 2 + 1] * g;
+            }
+        }
+    }
+
+    // Adds frames resampled with linear interpolation. The frame after the last one read is |next|, which
+    // lets the caller render the end of a sound without bounds checks in the loop.
+    template <int CHANNELS>
+    void resampleFrames(const int16_t* __restrict src, const int16_t* __restrict next, uint32_t lastFrame,
+                        uint64_t cursor, uint64_t step, float* __restrict out, uint32_t frameCount, float gain, float gainStep)
+    {
+        for (uint32_t i = 0; i < frameCount; ++i)
+        {
+            uint32_t index = static_cast<uint32_t>(cursor >> 32);
+            float frac = static_cast<float>(cursor & 0xffffffffu) * FIXED_TO_FLOAT;
+            const int16_t* s0 = src + index * CHANNELS;
+            const int16_t* s1 = index < lastFrame ? s0 + CHANNELS : next;
+            float g = gain + gainStep * i;
+            float left = s0[0] + (s1[0] - s0[0]) * frac;
+            float right = CHANNELS == 1 ? left : s0[1] + (s1[1] - s0[1]) * frac;
+            out[i * 2] += left * g;
+            out[i * 2 + 1] += right * g;
+            cursor += step;
+        }
+    }
+
+    void convertToInt16(const float* __restrict in, int16_t* __restrict out, uint32_t sampleCount)
+    {
+        uint32_t i = 0;
+#ifdef USE_SSE2
+        const __m128 scale = _mm_set1_ps(32768.0f);
+        for (; i + 8 <= sampleCount; i += 8)
+        {
+            __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i), scale));
+            __m128i hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(in + i + 4), scale));
+            // Saturates to [-32768, 32767].
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(lo, hi));
+        }
+#endif
+        for (; i < sampleCount; ++i)
+        {
+            float s = in[i] * 32768.0f;
+            s = s > 32767.0f ? 32767.0f : (s < -32768.0f ? -32768.0f : s);
+            out[i] = static_cast<int16_t>(s);
+        }
+    }
+
+    int64_t nowInMicroseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+} // namespace {
+
+AudioMixer::AudioMixer(uint32_t voiceCount, uint32_t sampleRate, uint32_t framesPerBuffer)
+: _voices(std::max(voiceCount, 1u))
+, _mixBuffer(framesPerBuffer * OUTPUT_CHANNELS)
+, _commands(COMMAND_QUEUE_SIZE)
+, _events(EVENT_QUEUE_SIZE)
+, _sampleRate(sampleRate)
+, _framesPerBuffer(framesPerBuffer)
+, _startOrder(0)
+, _device(nullptr)
+, _running(false)
+, _activeVoiceCount(0)
+, _deviceLatencyFrames(0)
+, _pendingEventCount(0)
+, _averageMixTime(0.0f)
+, _mixTimeAccumulated(0)
+, _mixTimeBuffers(0)
+{
+}
+
+AudioMixer::~AudioMixer()
+{
+    stop();
+    delete _device;
+}
+
+void AudioMixer::start(AudioOutputDevice* device)
+{
+    stop();
+    if (device != _device)
+    {
+        delete _device;
+        _device = device;
+    }
+    if (_device == nullptr)
+        return;
+
+    ALOGD("Mixing %u voices at %u Hz to the %s device", getVoiceCount(), _sampleRate, _device->getName());
+    _running = true;
+    _thread = std::thread(&AudioMixer::threadLoop, this);
+}
+
+void AudioMixer::stop()
+{
+    if (_thread.joinable())
+    {
+        _running = false;
+        _thread.join();
+    }
+}
+
+void AudioMixer::threadLoop()
+{
+    std::vector<int16_t> buffer(_framesPerBuffer * OUTPUT_CHANNELS);
+    while (_running.load(std::memory_order_relaxed))
+    {
+        mix(buffer.data(), _framesPerBuffer);
+        if (!_device->write(buffer.data(), _framesPerBuffer))
+        {
+            // The device is gone, an unplugged USB card for instance. Without a device pacing the thread,
+            // it would spin and finish the voices early, so keep mixing in real time to the null device.
+            ALOGW("The %s audio device failed, falling back to the null device", _device->getName());
+            delete _device;
+            _device = AudioOutputDevice::createNull(_sampleRate, OUTPUT_CHANNELS, _framesPerBuffer);
+        }
+        _deviceLatencyFrames.store(_device->getLatencyFrames(), std::memory_order_relaxed);
+    }
+}
+
+float AudioMixer::getLatency() const
+{
+    return static_cast<float>(_framesPerBuffer + _deviceLatencyFrames.load(std::memory_order_relaxed)) / _sampleRate;
+}
+
+void AudioMixer::mix(int16_t* out, uint32_t frameCount)
+{
+    int64_t startTime = nowInMicroseconds();
+
+    applyCommands();
+
+    while (frameCount > 0)
+    {
+        uint32_t frames = std::min(frameCount, _framesPerBuffer);
+        float* buffer = _mixBuffer.data();
+        memset(buffer, 0, frames * OUTPUT_CHANNELS * sizeof(float));
+
+        for (auto& voice : _voices)
+        {
+            if (voice.active && !voice.paused && !mixVoice(voice, buffer, frames))
+            {
+                endVoice(voice, EventType::FINISHED);
+            }
+        }
+
+        convertToInt16(buffer, out, frames * OUTPUT_CHANNELS);
+        out += frames * OUTPUT_CHANNELS;
+        frameCount -= frames;
+        ++_mixTimeBuffers;
+    }
+
+    _mixTimeAccumulated += nowInMicroseconds() - startTime;
+    if (_mixTimeBuffers * _framesPerBuffer >= _sampleRate)
+    {
+        _averageMixTime.store(static_cast<float>(_mixTimeAccumulated) / _mixTimeBuffers, std::memory_order_relaxed);
+        _mixTimeAccumulated = 0;
+        _mixTimeBuffers = 0;
+    }
+}
+
+bool AudioMixer::mixStreamVoice(Voice& voice, float* out, uint32_t frameCount)
+{
+    const float gain = voice.currentVolume * SAMPLE_TO_FLOAT;
+    const float gainStep = (voice.volume - voice.currentVolume) * SAMPLE_TO_FLOAT / frameCount;
+    voice.currentVolume = voice.volume;
+
+    bool ended = false;
+    uint32_t done = 0;
+    while (done < frameCount)
+    {
+        uint32_t frames = 0;
+        const int16_t* src = voice.stream->peek(frames, ended);
+        if (src == nullptr)
+        {
+            // Ended, or the stream thread lags behind and the rest of the buffer stays silent.
+            break;
+        }
+
+        frames = std::min(frames, frameCount - done);
+        mixFrames<2>(src, out + done * OUTPUT_CHANNELS, frames, gain + gainStep * done, gainStep);
+        voice.stream->consume(frames);
+        done += frames;
+    }
+
+    // Keeps the position set by a seek until the stream thread has caught up.
+    if (voice.position && done > 0)
+    {
+        voice.position->store(voice.stream->getPosition(), std::memory_order_relaxed);
+    }
+    return !ended;
+}
+
+bool AudioMixer::mixVoice(Voice& voice, float* out, uint32_t frameCount)
+{
+    if (voice.stream)
+        return mixStreamVoice(voice, out, frameCount);
+
+    const PcmData* pcm = voice.pcm;
+    const uint64_t end = static_cast<uint64_t>(pcm->frameCount) << 32;
+    const int16_t* samples = pcm->samples.data();
+    const uint32_t lastFrame = pcm->frameCount - 1;
+
+    // Ramps the volume over the buffer to avoid clicks.
+    const float gain = voice.currentVolume * SAMPLE_TO_FLOAT;
+    const float gainStep = (voice.volume - voice.currentVolume) * SAMPLE_TO_FLOAT / frameCount;
+    voice.currentVolume = voice.volume;
+
+    bool playing = true;
+    uint32_t done = 0;
+    while (done < frameCount)
+    {
+        if (voice.cursor >= end)
+        {
+            if (!voice.loop || end == 0)
+            {
+                playing = false;
+                break;
+            }
+            voice.cursor %= end;
+        }
+
+        // Renders up to the end of the sound at most.
+        uint32_t frames = frameCount - done;
+        uint64_t framesLeft = (end - voice.cursor + voice.step - 1) / voice.step;
+        if (framesLeft < frames)
+            frames = static_cast<uint32_t>(framesLeft);
+
+        float* dst = out + done * OUTPUT_CHANNELS;
+        float segmentGain = gain + gainStep * done;
+        if (voice.step == FIXED_ONE)
+        {
+            const int16_t* src = samples + (voice.cursor >> 32) * pcm->channelCount;
+            if (pcm->channelCount == 1)
+                mixFrames<1>(src, dst, frames, segmentGain, gainStep);
+            else
+                mixFrames<2>(src, dst, frames, segmentGain, gainStep);
+        }
+        else
+        {
+            // The last frame interpolates towards the first one when looping, towards itself otherwise.
+            const int16_t* next = voice.loop ? samples : samples + lastFrame * pcm->channelCount;
+            if (pcm->channelCount == 1)
+                resampleFrames<1>(samples, next, lastFrame, voice.cursor, voice.step, dst, frames, segmentGain, gainStep);
+            else
+                resampleFrames<2>(samples, next, lastFrame, voice.cursor, voice.step, dst, frames, segmentGain, gainStep);
+        }
+
+        voice.cursor += voice.step * frames;
+        done += frames;
+    }
+
+    if (voice.position)
+    {
+        voice.position->store(static_cast<uint32_t>(std::min(voice.cursor, end) >> 32), std::memory_order_relaxed);
+    }
+    return playing;
+}
+
+void AudioMixer::applyCommands()
+{
+    Command command;
+    while (_commands.pop(command))
+    {
+        applyCommand(command);
+    }
+}
+
+void AudioMixer::applyCommand(const Command& command)
+{
+    if (command.type == CommandType::PLAY)
+    {
+        Voice* voice = acquireVoice();
+        voice->audioID = command.audioID;
+        voice->pcm = command.pcm;
+        voice->stream = command.stream;
+        voice->position = command.position;
+        voice->cursor = 0;
+        voice->step = command.pcm ? (static_cast<uint64_t>(command.pcm->sampleRate) << 32) / _sampleRate : FIXED_ONE;
+        voice->volume = command.volume;
+        voice->currentVolume = command.volume;
+        voice->startOrder = _startOrder++;
+        voice->active = true;
+        voice->loop = command.loop;
+        voice->paused = false;
+        if (voice->step == 0)
+            voice->step = FIXED_ONE;
+        _activeVoiceCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    if (command.type == CommandType::STOP_ALL)
+    {
+        for (auto& voice : _voices)
+        {
+            if (voice.active)
+                endVoice(voice, EventType::STOPPED);
+        }
+        return;
+    }
+
+    Voice* voice = findVoice(command.audioID);
+    if (voice == nullptr)
+    {
+        // The voice has ended already, its event is on its way.
+        return;
+    }
+
+    switch (command.type)
+    {
+    case CommandType::STOP:
+        endVoice(*voice, EventType::STOPPED);
+        break;
+    case CommandType::PAUSE:
+        voice->paused = true;
+        break;
+    case CommandType::RESUME:
+        voice->paused = false;
+        break;
+    case CommandType::SET_VOLUME:
+        voice->volume = command.volume;
+        break;
+    case CommandType::SET_LOOP:
+        voice->loop = command.loop;
+        break;
+    case CommandType::SEEK:
+        if (voice->stream)
+            break;
+        voice->cursor = static_cast<uint64_t>(std::min(command.frame, voice->pcm->frameCount)) << 32;
+        if (voice->position)
+            voice->position->store(command.frame, std::memory_order_relaxed);
+        break;
+    default:
+        break;
+    }
+}
+
+AudioMixer::Voice* AudioMixer::findVoice(int audioID)
+{
+    for (auto& voice : _voices)
+    {
+        if (voice.active && voice.audioID == audioID)
+            return &voice;
+    }
+    return nullptr;
+}
+
+AudioMixer::Voice* AudioMixer::acquireVoice()
+{
+    Voice* victim = nullptr;
+    for (auto& voice : _voices)
+    {
+        if (!voice.active)
+            return &voice;
+
+        // Steals a voice which doesn't loop first, then the quietest, then the oldest.
+        if (victim == nullptr
+            || (victim->loop && !voice.loop)
+            || (victim->loop == voice.loop && (voice.volume < victim->volume
+                || (voice.volume == victim->volume && voice.startOrder - victim->startOrder > 0x80000000u))))
+        {
+            victim = &voice;
+        }
+    }
+
+    ALOGV("Voice of audio %d stolen", victim->audioID);
+    endVoice(*victim, EventType::STOLEN);
+    return victim;
+}
+
+void AudioMixer::endVoice(Voice& voice, EventType type)
+{
+    // Can't fail, play() doesn't queue more sounds than the event queue holds.
+    Event event = { voice.audioID, type };
+    _events.push(event);
+
+    voice.active = false;
+    voice.pcm = nullptr;
+    voice.stream = nullptr;
+    voice.position = nullptr;
+    _activeVoiceCount.fetch_sub(1, std::memory_order_relaxed);
+}
+
+bool AudioMixer::pushCommand(const Command& command)
+{
+    if (!_commands.push(command))
+    {
+        ALOGE("The command queue is full, command %d of audio %d dropped", static_cast<int>(command.type), command.audioID);
+        return false;
+    }
+    return true;
+}
+
+bool AudioMixer::play(int audioID, const PcmData* pcm, std::atomic<uint32_t>* position, float volume, bool loop)
+{
+    Command command = { CommandType::PLAY, audioID, pcm, nullptr, position, volume, loop, 0 };
+    return pushPlayCommand(command);
+}
+
+bool AudioMixer::play(int audioID, AudioStream* stream, std::atomic<uint32_t>* position, float volume, bool loop)
+{
+    Command command = { CommandType::PLAY, audioID, nullptr, stream, position, volume, loop, 0 };
+    return pushPlayCommand(command);
+}
+
+bool AudioMixer::pushPlayCommand(const Command& command)
+{
+    if (_pendingEventCount >= EVENT_QUEUE_SIZE)
+    {
+        ALOGE("Too many sounds playing, audio %d dropped", command.audioID);
+        return false;
+    }
+    if (command.position)
+        command.position->store(0, std::memory_order_relaxed);
+
+    if (!pushCommand(command))
+        return false;
+
+    ++_pendingEventCount;
+    return true;
+}
+
+bool AudioMixer::stopVoice(int audioID)
+{
+    Command command = { CommandType::STOP, audioID, nullptr, nullptr, nullptr, 0.0f, false, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::stopAll()
+{
+    Command command = { CommandType::STOP_ALL, 0, nullptr, nullptr, nullptr, 0.0f, false, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::pause(int audioID)
+{
+    Command command = { CommandType::PAUSE, audioID, nullptr, nullptr, nullptr, 0.0f, false, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::resume(int audioID)
+{
+    Command command = { CommandType::RESUME, audioID, nullptr, nullptr, nullptr, 0.0f, false, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::setVolume(int audioID, float volume)
+{
+    Command command = { CommandType::SET_VOLUME, audioID, nullptr, nullptr, nullptr, volume, false, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::setLoop(int audioID, bool loop)
+{
+    Command command = { CommandType::SET_LOOP, audioID, nullptr, nullptr, nullptr, 0.0f, loop, 0 };
+    return pushCommand(command);
+}
+
+bool AudioMixer::seek(int audioID, uint32_t frame)
+{
+    Command command = { CommandType::SEEK, audioID, nullptr, nullptr, nullptr, 0.0f, false, frame };
+    return pushCommand(command);
+}
+
+bool AudioMixer::pollEvent(Event& event)
+{
+    if (!_events.pop(event))
+        return false;
+
+    --_pendingEventCount;
+    return true;
+}
+
+}} // namespace cocos2d { namespace experimental {
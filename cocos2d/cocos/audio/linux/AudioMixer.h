@@ -0,0 +1,260 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cocos2d { namespace experimental {
+
+class AudioOutputDevice;
+class AudioStream;
+
+/**
+ * @brief A decoded sound, signed 16-bit interleaved samples with 1 or 2 channels.
+ * Sounds too long to be decoded at once are streamed; their PcmData only describes the format.
+ */
+struct PcmData
+{
+    std::vector<int16_t> samples;
+    uint32_t sampleRate;
+    uint32_t channelCount;
+    uint32_t frameCount;
+    bool streamed;
+
+    PcmData() : sampleRate(0), channelCount(0), frameCount(0), streamed(false) {}
+
+    float getDuration() const { return sampleRate > 0 ? static_cast<float>(frameCount) / sampleRate : 0.0f; }
+};
+
+/**
+ * @brief A single producer, single consumer queue which never blocks nor allocates once created.
+ */
+template <typename T>
+class AudioRingQueue
+{
+public:
+    explicit AudioRingQueue(uint32_t capacity)
+    : _items(capacity + 1)
+    , _head(0)
+    , _tail(0)
+    {
+    }
+
+    /** Called by the producer only. @return false if the queue is full.*/
+    bool push(const T& item)
+    {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        uint32_t next = (tail + 1) % static_cast<uint32_t>(_items.size());
+        if (next == _head.load(std::memory_order_acquire))
+            return false;
+        _items[tail] = item;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** Called by the consumer only. @return false if the queue is empty.*/
+    bool pop(T& item)
+    {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+            return false;
+        item = _items[head];
+        _head.store((head + 1) % static_cast<uint32_t>(_items.size()), std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> _items;
+    std::atomic<uint32_t> _head;
+    std::atomic<uint32_t> _tail;
+};
+
+/**
+ * @brief Mixes voices playing PcmData into a stereo output on its own thread.
+ *
+ * The game thread controls the voices through a lock-free command queue and learns about voices which have ended
+ * through a lock-free event queue, so the mixer thread never waits for the game thread. Every play() command is
+ * answered by exactly one event; the PcmData and the position counter passed to play() must stay alive until then.
+ *
+ * The voices are pooled. When all of them are busy, play() steals the quietest voice, preferring voices which
+ * don't loop. Sounds whose sample rate differs from the output are resampled with linear interpolation.
+ * Streams are resampled by their own thread, the mixer only adds their frames.
+ */
+class AudioMixer
+{
+public:
+    enum class EventType
+    {
+        FINISHED,   ///< the voice reached the end of a sound which doesn't loop
+        STOPPED,    ///< the voice has been stopped by stop() or stopAll()
+        STOLEN      ///< the voice has been given to a newer sound
+    };
+
+    struct Event
+    {
+        int audioID;
+        EventType type;
+    };
+
+    /**
+     * @param voiceCount The number of sounds that can be heard at the same time.
+     * @param sampleRate The sample rate of the output.
+     * @param framesPerBuffer The number of frames mixed at once, which bounds the latency of commands.
+     */
+    AudioMixer(uint32_t voiceCount, uint32_t sampleRate, uint32_t framesPerBuffer);
+    ~AudioMixer();
+
+    /**
+     * @brief Starts the mixer thread, writing to a device.
+     * @param device The output device, the mixer takes ownership of it.
+     * If writing to the device fails, the mixer thread goes on with the null device.
+     */
+    void start(AudioOutputDevice* device);
+
+    /** Stops the mixer thread. Voices keep their state and pending commands are kept.*/
+    void stop();
+
+    /**
+     * @brief Mixes the next frames, applying pending commands first.
+     * Called by the mixer thread; call it directly on a mixer which hasn't been started, e.g. to render offline.
+     * @param out The buffer receiving frameCount stereo frames.
+     */
+    void mix(int16_t* out, uint32_t frameCount);
+
+    // The following methods are called by the game thread only. They return false if the command queue is full,
+    // and play() also returns false when too many voices haven't been acknowledged through pollEvent() yet.
+
+    /**
+     * @brief Plays a sound.
+     * @param audioID The id reported by the event ending the voice.
+     * @param pcm The sound to play.
+     * @param position Receives the frame being played, in frames of pcm. Can be nullptr.
+     */
+    bool play(int audioID, const PcmData* pcm, std::atomic<uint32_t>* position, float volume, bool loop);
+
+    /**
+     * @brief Plays a stream. It loops according to AudioStream::setLoop() and is seeked with AudioStream::seek().
+     * @param stream The stream to play, it must stay alive until the event ending the voice.
+     * @param loop Whether the stream loops. Keep it in sync with setLoop(), since looping voices are stolen last.
+     */
+    bool play(int audioID, AudioStream* stream, std::atomic<uint32_t>* position, float volume, bool loop);
+    bool stopVoice(int audioID);
+    bool stopAll();
+    bool pause(int audioID);
+    bool resume(int audioID);
+    bool setVolume(int audioID, float volume);
+    bool setLoop(int audioID, bool loop);
+    bool seek(int audioID, uint32_t frame);
+
+    /** Polls the next voice which has ended. @return false if there is none.*/
+    bool pollEvent(Event& event);
+
+    uint32_t getSampleRate() const { return _sampleRate; }
+    uint32_t getVoiceCount() const { return static_cast<uint32_t>(_voices.size()); }
+
+    /** Gets the number of voices currently playing or paused.*/
+    uint32_t getActiveVoiceCount() const { return _activeVoiceCount.load(std::memory_order_relaxed); }
+
+    /** Gets the time between a command and its first audible frame, in seconds.*/
+    float getLatency() const;
+
+    /** Gets the average time spent mixing one buffer, in microseconds, over the last second.*/
+    float getAverageMixTime() const { return _averageMixTime.load(std::memory_order_relaxed); }
+
+private:
+    enum class CommandType
+    {
+        PLAY,
+        STOP,
+        STOP_ALL,
+        PAUSE,
+        RESUME,
+        SET_VOLUME,
+        SET_LOOP,
+        SEEK
+    };
+
+    struct Command
+    {
+        CommandType type;
+        int audioID;
+        const PcmData* pcm;
+        AudioStream* stream;
+        std::atomic<uint32_t>* position;
+        float volume;
+        bool loop;
+        uint32_t frame;
+    };
+
+    struct Voice
+    {
+        int audioID;
+        const PcmData* pcm;
+        AudioStream* stream;
+        std::atomic<uint32_t>* position;
+        uint64_t cursor;        // frame position in 32.32 fixed point
+        uint64_t step;          // cursor increment per output frame
+        float volume;           // target volume
+        float currentVolume;    // volume reached at the end of the last buffer, ramps towards volume
+        uint32_t startOrder;
+        bool active;
+        bool loop;
+        bool paused;
+    };
+
+    bool pushCommand(const Command& command);
+    bool pushPlayCommand(const Command& command);
+    void applyCommands();
+    void applyCommand(const Command& command);
+    Voice* findVoice(int audioID);
+    Voice* acquireVoice();
+    void endVoice(Voice& voice, EventType type);
+    bool mixVoice(Voice& voice, float* out, uint32_t frameCount);
+    bool mixStreamVoice(Voice& voice, float* out, uint32_t frameCount);
+    void threadLoop();
+
+    std::vector<Voice> _voices;
+    std::vector<float> _mixBuffer;
+    AudioRingQueue<Command> _commands;
+    AudioRingQueue<Event> _events;
+    uint32_t _sampleRate;
+    uint32_t _framesPerBuffer;
+    uint32_t _startOrder;
+
+    AudioOutputDevice* _device;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<uint32_t> _activeVoiceCount;
+    std::atomic<uint32_t> _deviceLatencyFrames;
+    uint32_t _pendingEventCount;
+    std::atomic<float> _averageMixTime;
+    int64_t _mixTimeAccumulated;
+    uint32_t _mixTimeBuffers;
+};
+
+}} // namespace cocos2d { namespace experimental {
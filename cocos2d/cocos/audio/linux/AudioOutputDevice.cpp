@@ -0,0 +1,178 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioOutputDevice"
+
+#include "audio/linux/AudioOutputDevice.h"
+#include "audio/linux/AudioMacros.h"
+
+#include <alsa/asoundlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <thread>
+
+namespace cocos2d { namespace experimental {
+
+namespace {
+
+    const uint32_t PERIODS_PER_DEVICE_BUFFER = 3;
+
+    int64_t nowInMicroseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    class AudioOutputDeviceALSA : public AudioOutputDevice
+    {
+    public:
+        AudioOutputDeviceALSA(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer)
+        : AudioOutputDevice(sampleRate, channelCount, framesPerBuffer)
+        , _pcm(nullptr)
+        {
+        }
+
+        virtual ~AudioOutputDeviceALSA()
+        {
+            if (_pcm != nullptr)
+            {
+                snd_pcm_drop(_pcm);
+                snd_pcm_close(_pcm);
+            }
+        }
+
+        virtual const char* getName() const override { return "alsa"; }
+
+        virtual bool open() override
+        {
+            int err = snd_pcm_open(&_pcm, "default", SND_PCM_STREAM_PLAYBACK, 0);
+            if (err < 0)
+            {
+                ALOGW("Can't open ALSA default device: %s", snd_strerror(err));
+                _pcm = nullptr;
+                return false;
+            }
+
+            unsigned int latency = static_cast<unsigned int>(1000000ull * _framesPerBuffer * PERIODS_PER_DEVICE_BUFFER / _sampleRate);
+            err = snd_pcm_set_params(_pcm, SND_PCM_FORMAT_S16_LE, SND_PCM_ACCESS_RW_INTERLEAVED, _channelCount, _sampleRate, 1, latency);
+            if (err < 0)
+            {
+                ALOGW("Can't configure ALSA default device: %s", snd_strerror(err));
+                snd_pcm_close(_pcm);
+                _pcm = nullptr;
+                return false;
+            }
+            return true;
+        }
+
+        virtual bool write(const int16_t* frames, uint32_t frameCount) override
+        {
+            while (frameCount > 0)
+            {
+                snd_pcm_sframes_t written = snd_pcm_writei(_pcm, frames, frameCount);
+                if (written < 0)
+                {
+                    // Recovers from underruns and suspends, the frames of this write are lost.
+                    int err = snd_pcm_recover(_pcm, static_cast<int>(written), 1);
+                    if (err < 0)
+                    {
+                        ALOGE("ALSA write failed: %s", snd_strerror(err));
+                        return false;
+                    }
+                    continue;
+                }
+                frames += written * _channelCount;
+                frameCount -= static_cast<uint32_t>(written);
+            }
+            return true;
+        }
+
+        virtual uint32_t getLatencyFrames() const override
+        {
+            snd_pcm_sframes_t delay = 0;
+            if (snd_pcm_delay(_pcm, &delay) < 0 || delay < 0)
+                return _framesPerBuffer * PERIODS_PER_DEVICE_BUFFER;
+            return static_cast<uint32_t>(delay);
+        }
+
+    private:
+        snd_pcm_t* _pcm;
+    };
+
+} // namespace {
+
+AudioOutputDevice* AudioOutputDevice::create(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer)
+{
+    const char* name = getenv("COCOS_AUDIO_DEVICE");
+    if (name == nullptr || strcmp(name, "null") != 0)
+    {
+        AudioOutputDevice* device = new (std::nothrow) AudioOutputDeviceALSA(sampleRate, channelCount, framesPerBuffer);
+        if (device && device->open())
+            return device;
+
+        delete device;
+        ALOGW("Falling back to the null audio device, nothing will be heard");
+    }
+
+    return createNull(sampleRate, channelCount, framesPerBuffer);
+}
+
+AudioOutputDevice* AudioOutputDevice::createNull(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer)
+{
+    AudioOutputDevice* device = new AudioOutputDeviceNull(sampleRate, channelCount, framesPerBuffer);
+    device->open();
+    return device;
+}
+
+AudioOutputDeviceNull::AudioOutputDeviceNull(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer)
+: AudioOutputDevice(sampleRate, channelCount, framesPerBuffer)
+, _nextWriteTime(0)
+{
+}
+
+bool AudioOutputDeviceNull::open()
+{
+    _nextWriteTime = nowInMicroseconds();
+    return true;
+}
+
+bool AudioOutputDeviceNull::write(const int16_t* frames, uint32_t frameCount)
+{
+    // Consumes the frames at the rate a sound card would.
+    _nextWriteTime += static_cast<int64_t>(frameCount) * 1000000 / _sampleRate;
+    int64_t now = nowInMicroseconds();
+    if (_nextWriteTime > now)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(_nextWriteTime - now));
+    }
+    else if (now - _nextWriteTime > 1000000ll * _framesPerBuffer / _sampleRate)
+    {
+        // Too late, like an underrun; don't try to catch up.
+        _nextWriteTime = now;
+    }
+    return true;
+}
+
+}} // namespace cocos2d { namespace experimental {
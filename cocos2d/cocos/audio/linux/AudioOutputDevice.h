@@ -0,0 +1,105 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+
+namespace cocos2d { namespace experimental {
+
+/**
+ * @brief The sink the mixer thread writes signed 16-bit interleaved frames to.
+ *
+ * Writing blocks until the device accepts the frames, so the device paces the mixer thread.
+ */
+class AudioOutputDevice
+{
+public:
+    /**
+     * @brief Opens the output device.
+     * The device is ALSA's default PCM, unless the COCOS_AUDIO_DEVICE environment variable is set to "null".
+     * Falls back to the null device if no sound card can be opened, so headless machines still run the mixer.
+     * @return The device, never nullptr.
+     */
+    static AudioOutputDevice* create(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer);
+
+    /**
+     * @brief Opens the null device, which can't fail.
+     * @return The device, never nullptr.
+     */
+    static AudioOutputDevice* createNull(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer);
+
+    virtual ~AudioOutputDevice() {}
+
+    /** Gets the name of the device, for logs.*/
+    virtual const char* getName() const = 0;
+
+    /**
+     * @brief Writes frames, blocking until they have been queued.
+     * @return false if the frames have been dropped.
+     */
+    virtual bool write(const int16_t* frames, uint32_t frameCount) = 0;
+
+    /** Gets the number of frames written but not played yet.*/
+    virtual uint32_t getLatencyFrames() const = 0;
+
+    uint32_t getSampleRate() const { return _sampleRate; }
+    uint32_t getChannelCount() const { return _channelCount; }
+    uint32_t getFramesPerBuffer() const { return _framesPerBuffer; }
+
+protected:
+    AudioOutputDevice(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer)
+    : _sampleRate(sampleRate)
+    , _channelCount(channelCount)
+    , _framesPerBuffer(framesPerBuffer)
+    {
+    }
+
+    virtual bool open() = 0;
+
+    uint32_t _sampleRate;
+    uint32_t _channelCount;
+    uint32_t _framesPerBuffer;
+};
+
+/**
+ * @brief An output device which discards the frames, consuming them in real time.
+ * Used on machines without a sound card and for headless runs.
+ */
+class AudioOutputDeviceNull : public AudioOutputDevice
+{
+public:
+    AudioOutputDeviceNull(uint32_t sampleRate, uint32_t channelCount, uint32_t framesPerBuffer);
+
+    virtual const char* getName() const override { return "null"; }
+    virtual bool write(const int16_t* frames, uint32_t frameCount) override;
+    virtual uint32_t getLatencyFrames() const override { return _framesPerBuffer; }
+
+protected:
+    virtual bool open() override;
+
+    int64_t _nextWriteTime;
+};
+
+}} // namespace cocos2d { namespace experimental {
@@ -0,0 +1,304 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#define LOG_TAG "AudioStream"
+
+#include "audio/linux/AudioStream.h"
+#include "audio/linux/AudioDecoder.h"
+#include "audio/linux/AudioDecoderManager.h"
+#include "audio/linux/AudioMacros.h"
+
+#include <string.h>
+#include <chrono>
+
+namespace cocos2d { namespace experimental {
+
+namespace {
+
+    const uint32_t STREAM_BLOCK_COUNT = 6;
+    const uint32_t STREAM_BLOCK_FRAMES = 4096;
+    const uint32_t SOURCE_FRAMES = 2048;
+    const float FIXED_TO_FLOAT = 1.0f / 4294967296.0f;
+
+} // namespace {
+
+AudioStream::AudioStream(const std::string& fullPath, uint32_t outputSampleRate, bool loop)
+: _fullPath(fullPath)
+, _outputSampleRate(outputSampleRate)
+, _blocks(STREAM_BLOCK_COUNT)
+, _filledBlocks(STREAM_BLOCK_COUNT)
+, _freeBlocks(STREAM_BLOCK_COUNT)
+, _loop(loop)
+, _failed(false)
+, _seekFrame(0)
+, _seekEpoch(0)
+, _totalFrames(0)
+, _sourceStep(0)
+, _currentBlock(nullptr)
+, _currentIndex(0)
+, _blockOffset(0)
+, _decoder(nullptr)
+, _sourceFrames(0)
+, _sourceBase(0)
+, _cursor(0)
+, _atEnd(false)
+, _stopped(false)
+{
+    for (uint32_t i = 0; i < STREAM_BLOCK_COUNT; ++i)
+    {
+        _blocks[i].samples.resize(STREAM_BLOCK_FRAMES * 2);
+        _blocks[i].frameCount = 0;
+        _blocks[i].sourceFrame = 0;
+        _blocks[i].epoch = 0;
+        _blocks[i].end = false;
+        _freeBlocks.push(i);
+    }
+
+    _thread = std::thread(&AudioStream::threadLoop, this);
+}
+
+AudioStream::~AudioStream()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopped = true;
+    }
+    _condition.notify_one();
+    _thread.join();
+
+    if (_decoder != nullptr)
+    {
+        AudioDecoderManager::destroyDecoder(_decoder);
+    }
+}
+
+void AudioStream::setLoop(bool loop)
+{
+    _loop = loop;
+}
+
+void AudioStream::seek(uint32_t frame)
+{
+    _seekFrame.store(frame, std::memory_order_relaxed);
+    _seekEpoch.fetch_add(1, std::memory_order_release);
+    _condition.notify_one();
+}
+
+const int16_t* AudioStream::peek(uint32_t& frameCount, bool& ended)
+{
+    ended = _failed.load(std::memory_order_relaxed);
+    if (ended)
+        return nullptr;
+
+    const uint32_t epoch = _seekEpoch.load(std::memory_order_acquire);
+    while (true)
+    {
+        if (_currentBlock != nullptr)
+        {
+            if (_currentBlock->epoch == epoch)
+            {
+                if (_blockOffset < _currentBlock->frameCount)
+                {
+                    frameCount = _currentBlock->frameCount - _blockOffset;
+                    return _currentBlock->samples.data() + _blockOffset * 2;
+                }
+                if (_currentBlock->end)
+                {
+                    ended = true;
+                    return nullptr;
+                }
+            }
+
+            // Played entirely, or decoded before a seek.
+            _freeBlocks.push(_currentIndex);
+            _currentBlock = nullptr;
+        }
+
+        uint32_t index;
+        if (!_filledBlocks.pop(index))
+            return nullptr;
+
+        _currentBlock = &_blocks[index];
+        _currentIndex = index;
+        _blockOffset = 0;
+    }
+}
+
+void AudioStream::consume(uint32_t frameCount)
+{
+    _blockOffset += frameCount;
+}
+
+uint32_t AudioStream::getPosition() const
+{
+    if (_currentBlock == nullptr)
+        return 0;
+
+    uint32_t position = _currentBlock->sourceFrame + static_cast<uint32_t>((_blockOffset * _sourceStep.load(std::memory_order_relaxed)) >> 32);
+    uint32_t totalFrames = _totalFrames.load(std::memory_order_relaxed);
+    return totalFrames > 0 ? position % totalFrames : position;
+}
+
+void AudioStream::wait()
+{
+    // Sleeps for a fraction of a block, the mixer has a few blocks in advance.
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (!_stopped)
+    {
+        _condition.wait_for(lock, std::chrono::milliseconds(1000 * STREAM_BLOCK_FRAMES / _outputSampleRate / 4));
+    }
+}
+
+bool AudioStream::openDecoder()
+{
+    _decoder = AudioDecoderManager::createDecoder(_fullPath.c_str());
+    if (_decoder == nullptr || !_decoder->open(_fullPath.c_str()))
+    {
+        ALOGE("Can't stream %s", _fullPath.c_str());
+        return false;
+    }
+
+    _source.resize(SOURCE_FRAMES * _decoder->getChannelCount());
+    _totalFrames = _decoder->getTotalFrames();
+    _sourceStep = (static_cast<uint64_t>(_decoder->getSampleRate()) << 32) / _outputSampleRate;
+    return true;
+}
+
+void AudioStream::threadLoop()
+{
+    if (!openDecoder())
+    {
+        _failed = true;
+        return;
+    }
+
+    uint32_t epoch = 0;
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_stopped)
+                break;
+        }
+
+        const uint32_t requestedEpoch = _seekEpoch.load(std::memory_order_acquire);
+        if (requestedEpoch != epoch)
+        {
+            epoch = requestedEpoch;
+            uint32_t frame = _seekFrame.load(std::memory_order_relaxed);
+            if (!_decoder->seek(frame))
+            {
+                ALOGW("Can't seek %s to frame %u", _fullPath.c_str(), frame);
+            }
+            _sourceFrames = 0;
+            _sourceBase = _decoder->tell();
+            _cursor = 0;
+            _atEnd = false;
+        }
+
+        uint32_t index;
+        if (_atEnd || !_freeBlocks.pop(index))
+        {
+            wait();
+            continue;
+        }
+
+        fillBlock(_blocks[index], epoch);
+        _filledBlocks.push(index);
+    }
+}
+
+void AudioStream::fillBlock(Block& block, uint32_t epoch)
+{
+    const uint32_t channelCount = _decoder->getChannelCount();
+    const uint64_t step = _sourceStep.load(std::memory_order_relaxed);
+    const uint32_t totalFrames = _totalFrames.load(std::memory_order_relaxed);
+
+    block.sourceFrame = _sourceBase + static_cast<uint32_t>(_cursor >> 32);
+    if (totalFrames > 0)
+        block.sourceFrame %= totalFrames;
+    block.epoch = epoch;
+    block.end = false;
+
+    int16_t* out = block.samples.data();
+    uint32_t produced = 0;
+    while (produced < STREAM_BLOCK_FRAMES)
+    {
+        uint32_t index = static_cast<uint32_t>(_cursor >> 32);
+        if (index + 1 >= _sourceFrames)
+        {
+            if (!readSource())
+            {
+                _atEnd = true;
+                block.end = true;
+                break;
+            }
+            continue;
+        }
+
+        // Resamples to the output rate and to stereo with linear interpolation.
+        float frac = static_cast<float>(_cursor & 0xffffffffu) * FIXED_TO_FLOAT;
+        const int16_t* s0 = _source.data() + index * channelCount;
+        const int16_t* s1 = s0 + channelCount;
+        float left = s0[0] + (s1[0] - s0[0]) * frac;
+        float right = channelCount == 1 ? left : s0[1] + (s1[1] - s0[1]) * frac;
+        out[produced * 2] = static_cast<int16_t>(left);
+        out[produced * 2 + 1] = static_cast<int16_t>(right);
+
+        _cursor += step;
+        ++produced;
+    }
+
+    block.frameCount = produced;
+}
+
+bool AudioStream::readSource()
+{
+    const uint32_t channelCount = _decoder->getChannelCount();
+
+    // Keeps the frame being interpolated, drops the ones before.
+    uint32_t index = static_cast<uint32_t>(_cursor >> 32);
+    if (index > _sourceFrames)
+        index = _sourceFrames;
+    memmove(_source.data(), _source.data() + index * channelCount, (_sourceFrames - index) * channelCount * sizeof(int16_t));
+    _sourceFrames -= index;
+    _sourceBase += index;
+    _cursor -= static_cast<uint64_t>(index) << 32;
+
+    char* dst = reinterpret_cast<char*>(_source.data() + _sourceFrames * channelCount);
+    uint32_t framesRead = _decoder->read(SOURCE_FRAMES - _sourceFrames, dst);
+    if (framesRead == 0 && _loop.load(std::memory_order_relaxed))
+    {
+        // Frame 0 follows the last frame in the buffer, so the loop is seamless.
+        if (_decoder->seek(0))
+        {
+            framesRead = _decoder->read(SOURCE_FRAMES - _sourceFrames, dst);
+        }
+    }
+
+    _sourceFrames += framesRead;
+    return framesRead > 0;
+}
+
+}} // namespace cocos2d { namespace experimental {
@@ -0,0 +1,127 @@
+/****************************************************************************
+ Copyright (c) 2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#pragma once
+
+#include "audio/linux/AudioMixer.h"
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cocos2d { namespace experimental {
+
+class AudioDecoder;
+
+/**
+ * @brief Plays a long sound without decoding it entirely.
+ *
+ * A thread decodes the file, resamples it to the output sample rate and fills a few blocks of stereo frames which
+ * the mixer consumes, so the memory used doesn't depend on the length of the sound. Blocks are handed over through
+ * lock-free queues; blocks decoded before a seek are tagged with an older epoch and skipped by the mixer.
+ */
+class AudioStream
+{
+public:
+    /**
+     * @param fullPath The full path of the file to stream. It is opened by the stream thread.
+     * @param outputSampleRate The sample rate of the mixer.
+     */
+    AudioStream(const std::string& fullPath, uint32_t outputSampleRate, bool loop);
+    ~AudioStream();
+
+    // Called by the game thread.
+    void setLoop(bool loop);
+    void seek(uint32_t frame);
+
+    // Called by the mixer thread.
+
+    /**
+     * @brief Gets the next frames to mix.
+     * @param frameCount Receives the number of stereo frames available at the returned address.
+     * @param ended Set to true when the end of a sound which doesn't loop has been reached.
+     * @return The frames, or nullptr if the stream thread lags behind or the end has been reached.
+     */
+    const int16_t* peek(uint32_t& frameCount, bool& ended);
+
+    /** Consumes frames returned by peek(). */
+    void consume(uint32_t frameCount);
+
+    /** Gets the frame being played, in frames of the file. */
+    uint32_t getPosition() const;
+
+private:
+    struct Block
+    {
+        std::vector<int16_t> samples;
+        uint32_t frameCount;
+        uint32_t sourceFrame;   // frame of the file played at the start of the block
+        uint32_t epoch;
+        bool end;
+    };
+
+    void threadLoop();
+    bool openDecoder();
+    void fillBlock(Block& block, uint32_t epoch);
+    bool readSource();
+    void wait();
+
+    std::string _fullPath;
+    uint32_t _outputSampleRate;
+
+    std::vector<Block> _blocks;
+    AudioRingQueue<uint32_t> _filledBlocks;
+    AudioRingQueue<uint32_t> _freeBlocks;
+
+    std::atomic<bool> _loop;
+    std::atomic<bool> _failed;
+    std::atomic<uint32_t> _seekFrame;
+    std::atomic<uint32_t> _seekEpoch;
+    std::atomic<uint32_t> _totalFrames;
+    std::atomic<uint64_t> _sourceStep;
+
+    // mixer thread state
+    Block* _currentBlock;
+    uint32_t _currentIndex;
+    uint32_t _blockOffset;
+
+    // stream thread state
+    AudioDecoder* _decoder;
+    std::vector<int16_t> _source;   // decoded frames not entirely resampled yet
+    uint32_t _sourceFrames;
+    uint32_t _sourceBase;           // frame of the file at _source[0]
+    uint64_t _cursor;               // position in _source, 32.32 fixed point
+    bool _atEnd;
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stopped;
+};
+
+}} // namespace cocos2d { namespace experimental {
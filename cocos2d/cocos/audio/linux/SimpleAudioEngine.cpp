@@ -76,6 +76,16 @@ void SimpleAudioEngine::preloadBackgroundMusic(const char* filePath)
 
 void SimpleAudioEngine::playBackgroundMusic(const char* filePath, bool loop)
 {
+    int musicid = g_SimpleAudioEngineLinux->musicid;
+    if (musicid != AudioEngine::INVALID_AUDIO_ID && g_SimpleAudioEngineLinux->musicpath == filePath
+        && AudioEngine::getState(musicid) != AudioEngine::AudioState::ERROR) {
+        // the music is still streaming, e.g. the scene has been replaced: keep it instead of reopening the file
+        AudioEngine::setLoop(musicid, loop);
+        AudioEngine::resume(musicid);
+        return;
+    }
+
+    AudioEngine::stop(musicid);
     g_SimpleAudioEngineLinux->musicpath = filePath;
     g_SimpleAudioEngineLinux->musicid = AudioEngine::play2d(filePath, loop);
 }
@@ -83,6 +93,7 @@ void SimpleAudioEngine::playBackgroundMusic(const char* filePath, bool loop)
 void SimpleAudioEngine::stopBackgroundMusic(bool releaseData)
 {
     AudioEngine::stop(g_SimpleAudioEngineLinux->musicid);
+    g_SimpleAudioEngineLinux->musicid = AudioEngine::INVALID_AUDIO_ID;
     if (releaseData) {
         AudioEngine::uncache(g_SimpleAudioEngineLinux->musicpath.c_str());
     }
@@ -173,7 +184,7 @@ void SimpleAudioEngine::setEffectsVolume(float volume)
  */
 unsigned int SimpleAudioEngine::playEffect(const char* filePath, bool loop, float pitch, float pan, float gain)
 {
-    return AudioEngine::play2d(filePath, loop, gain);
+    return AudioEngine::play2d(filePath, loop, gain * g_SimpleAudioEngineLinux->effectsvolume);
 }
 
 /**
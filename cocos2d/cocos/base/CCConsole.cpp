@@ -64,6 +64,7 @@
 #include "platform/CCPlatformConfig.h"
 #include "base/CCConfiguration.h"
 #include "2d/CCScene.h"
+#include "2d/CCNodePool.h"
 #include "platform/CCFileUtils.h"
 #include "renderer/CCTextureCache.h"
 #include "base/base64.h"
@@ -1028,7 +1029,7 @@ void Console::addClient()
 
 void Console::createCommandAllocator()
 {
-    addCommand({"allocator", "Display allocator diagnostics for all allocators. Args: [-h | help | ]",
+    addCommand({"allocator", "Display allocator diagnostics for all allocators and node pools. Args: [-h | help | ]",
         CC_CALLBACK_2(Console::commandAllocator, this)});
 }
 
@@ -1110,10 +1111,12 @@ void Console::createCommandSceneGraph()
 
 void Console::createCommandTexture()
 {
-    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | ] ",
+    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | budget | ] ",
         CC_CALLBACK_2(Console::commandTextures, this)});
     addSubCommand("texture", {"flush", "Purges the dictionary of loaded textures.",
         CC_CALLBACK_2(Console::commandTexturesSubCommandFlush, this)});
+    addSubCommand("texture", {"budget", "Print or set the texture memory budget. Args: [MB], 0 for unlimited.",
+        CC_CALLBACK_2(Console::commandTexturesSubCommandBudget, this)});
 }
 
 void Console::createCommandTouch()
@@ -1147,6 +1150,17 @@ void Console::commandAllocator(int fd, const std::string& /*args*/)
 #else
     Console::Utility::mydprintf(fd, "allocator diagnostics not available. CC_ENABLE_ALLOCATOR_DIAGNOSTICS must be set to 1 in ccConfig.h\n");
 #endif
+
+    // node pools live in the cocos thread
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto pools = NodePoolBase::getAllDiagnostics();
+        if (!pools.empty())
+        {
+            Console::Utility::mydprintf(fd, "node pools:\n%s", pools.c_str());
+        }
+        Console::Utility::sendPrompt(fd);
+    });
 }
 
 void Console::commandConfig(int fd, const std::string& /*args*/)
@@ -1348,6 +1362,31 @@ void Console::commandTexturesSubCommandFlush(int /*fd*/, const std::string& /*ar
     });
 }
 
+void Console::commandTexturesSubCommandBudget(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+    if (argv.size() == 2 && !Console::Utility::isFloat(argv[1]))
+    {
+        Console::Utility::mydprintf(fd, "budget in MB expected, got %s\n", argv[1].c_str());
+        Console::Utility::sendPrompt(fd);
+        return;
+    }
+
+    float megabytes = (argv.size() == 2) ? utils::atof(argv[1].c_str()) : -1;
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto textureCache = Director::getInstance()->getTextureCache();
+        if (megabytes >= 0)
+        {
+            textureCache->setTextureMemoryBudget(static_cast<size_t>(megabytes * 1024 * 1024));
+        }
+        Console::Utility::mydprintf(fd, "budget: %.2f MB, resident: %.2f MB\n",
+            textureCache->getTextureMemoryBudget() / (1024.0f * 1024.0f),
+            textureCache->getTextureMemoryUsage() / (1024.0f * 1024.0f));
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandTouchSubCommandTap(int fd, const std::string& args)
 {
     auto argv = Console::Utility::split(args,' ');
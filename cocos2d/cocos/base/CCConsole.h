@@ -266,6 +266,7 @@ protected:
     void commandSceneGraph(int fd, const std::string& args);
     void commandTextures(int fd, const std::string& args);
     void commandTexturesSubCommandFlush(int fd, const std::string& args);
+    void commandTexturesSubCommandBudget(int fd, const std::string& args);
     void commandTouchSubCommandTap(int fd, const std::string& args);
     void commandTouchSubCommandSwipe(int fd, const std::string& args);
     void commandUpload(int fd);
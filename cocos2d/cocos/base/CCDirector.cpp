@@ -34,6 +34,7 @@ THE SOFTWARE.
 
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
+#include "2d/CCDynamicAtlas.h"
 #include "platform/CCFileUtils.h"
 
 #include "2d/CCActionManager.h"
@@ -43,6 +44,7 @@ THE SOFTWARE.
 #include "2d/CCTransition.h"
 #include "2d/CCFontFreeType.h"
 #include "2d/CCLabelAtlas.h"
+#include "2d/CCParticleSystem.h"
 #include "renderer/CCGLProgramCache.h"
 #include "renderer/CCGLProgramStateCache.h"
 #include "renderer/CCTextureCache.h"
@@ -61,6 +63,7 @@ THE SOFTWARE.
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/ObjectFactory.h"
 #include "platform/CCApplication.h"
 
@@ -271,6 +274,8 @@ void Director::drawScene()
     {
         _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
         _scheduler->update(_deltaTime);
+        // join the particle jobs before anyone looks at the particles again
+        ParticleSystem::finishParallelUpdates();
         _eventDispatcher->dispatchEvent(_eventAfterUpdate);
     }
 
@@ -1101,10 +1106,12 @@ void Director::reset()
 #endif
     AnimationCache::destroyInstance();
     SpriteFrameCache::destroyInstance();
+    DynamicAtlas::destroyInstance();
     GLProgramCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
     FileUtils::destroyInstance();
     AsyncTaskPool::destroyInstance();
+    JobSystem::destroyInstance();
     
     // cocos2d-x specific data structures
     UserDefault::destroyInstance();
@@ -108,6 +108,20 @@ static EventListener::ListenerID __getListenerID(Event* event)
     return ret;
 }
 
+/** Returns the depth of node below rootNode, or -1 if the node is not part of rootNode's scene graph. */
+static int __getDepthInSceneGraph(Node* node, Node* rootNode)
+{
+    int depth = 0;
+    while (node != nullptr)
+    {
+        if (node == rootNode)
+            return depth;
+        node = node->getParent();
+        ++depth;
+    }
+    return -1;
+}
+
 EventDispatcher::EventListenerVector::EventListenerVector() :
  _fixedListeners(nullptr),
  _sceneGraphListeners(nullptr),
@@ -481,11 +495,11 @@ void EventDispatcher::forceAddEventListener(EventListener* listener)
     
     if (listener->getFixedPriority() == 0)
     {
-        setDirty(listenerID, DirtyFlag::SCENE_GRAPH_PRIORITY);
-        
         auto node = listener->getAssociatedNode();
         CCASSERT(node != nullptr, "Invalid scene graph priority!");
         
+        setDirtyForSceneGraphNode(listenerID, node);
+        
         associateNodeAndEventListener(node, listener);
         
         if (!node->isRunning())
@@ -655,7 +669,8 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         if (isFound)
         {
             // fixed #4160: Dirty flag need to be updated after listeners were removed.
-            setDirty(listener->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+            // Removing a listener keeps the relative order of the others, so no node needs to be re-positioned.
+            setDirtyForSceneGraphNode(listener->getListenerID(), nullptr);
         }
         else
         {
@@ -681,6 +696,7 @@ void EventDispatcher::removeEventListener(EventListener* listener)
         if (iter->second->empty())
         {
             _priorityDirtyFlagMap.erase(listener->getListenerID());
+            clearSceneGraphSortState(listener->getListenerID());
             auto list = iter->second;
             iter = _listenerMap.erase(iter);
             CC_SAFE_DELETE(list);
@@ -939,6 +955,40 @@ void EventDispatcher::dispatchEvent(Event* event)
     updateListeners(event);
 }
 
+void EventDispatcher::dispatchEventBatch(const EventListener::ListenerID& listenerID, ssize_t count, const std::function<Event*(ssize_t)>& eventAt)
+{
+    CCASSERT(listenerID != EventListenerTouchOneByOne::LISTENER_ID && listenerID != EventListenerTouchAllAtOnce::LISTENER_ID
+             && listenerID != EventListenerMouse::LISTENER_ID, "Touch and mouse events can't be dispatched in a batch.");
+    
+    if (!_isEnabled || count <= 0 || _listenerMap.find(listenerID) == _listenerMap.end())
+        return;
+    
+    updateDirtyFlagForSceneGraph();
+    
+    DispatchGuard guard(_inDispatch);
+    
+    sortEventListeners(listenerID);
+    
+    // listeners added during the batch are queued, and removed ones are only unregistered, so the vector stays valid
+    auto listeners = _listenerMap.find(listenerID)->second;
+    Event* event = nullptr;
+    
+    auto onEvent = [&event](EventListener* listener) -> bool{
+        event->setCurrentTarget(listener->getAssociatedNode());
+        listener->_onEvent(event);
+        return event->isStopped();
+    };
+    
+    for (ssize_t i = 0; i < count; ++i)
+    {
+        event = eventAt(i);
+        CCASSERT(__getListenerID(event) == listenerID, "Every event of a batch must have the same listener ID.");
+        dispatchEventToListeners(listeners, onEvent);
+    }
+    
+    updateListeners(event);
+}
+
 void EventDispatcher::dispatchCustomEvent(const std::string &eventName, void *optionalUserData)
 {
     EventCustom ev(eventName);
@@ -1232,6 +1282,7 @@ void EventDispatcher::updateListeners(Event* event)
         if (iter->second->empty())
         {
             _priorityDirtyFlagMap.erase(iter->first);
+            clearSceneGraphSortState(iter->first);
             delete iter->second;
             iter = _listenerMap.erase(iter);
         }
@@ -1267,7 +1318,7 @@ void EventDispatcher::updateDirtyFlagForSceneGraph()
             {
                 for (auto& l : *iter->second)
                 {
-                    setDirty(l->getListenerID(), DirtyFlag::SCENE_GRAPH_PRIORITY);
+                    setDirtyForSceneGraphNode(l->getListenerID(), node);
                 }
             }
         }
@@ -1320,7 +1371,16 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
     auto sceneGraphListeners = listeners->getSceneGraphPriorityListeners();
     
     if (sceneGraphListeners == nullptr)
+    {
+        clearSceneGraphSortState(listenerID);
         return;
+    }
+
+    if (sortDirtyEventListenersOfSceneGraphPriority(listenerID, rootNode))
+    {
+        _sceneGraphDirtyNodesMap.erase(listenerID);
+        return;
+    }
 
     // Reset priority index
     _nodePriorityIndex = 0;
@@ -1340,6 +1400,103 @@ void EventDispatcher::sortEventListenersOfSceneGraphPriority(const EventListener
         log("listener priority: node ([%s]%p), priority (%d)", typeid(*l->_node).name(), l->_node, _nodePriorityMap[l->_node]);
     }
 #endif
+    
+    _sceneGraphDirtyNodesMap.erase(listenerID);
+    _sceneGraphSortedRootMap[listenerID] = rootNode;
+}
+
+bool EventDispatcher::sortDirtyEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode)
+{
+    // The previous order is only reusable if it was computed for the same scene
+    auto rootIter = _sceneGraphSortedRootMap.find(listenerID);
+    if (rootIter == _sceneGraphSortedRootMap.end() || rootIter->second != rootNode)
+        return false;
+    
+    auto dirtyNodesIter = _sceneGraphDirtyNodesMap.find(listenerID);
+    if (dirtyNodesIter == _sceneGraphDirtyNodesMap.end())
+        return false;
+    
+    const auto& dirtyNodes = dirtyNodesIter->second;
+    auto sceneGraphListeners = getListeners(listenerID)->getSceneGraphPriorityListeners();
+    
+    auto isClean = [&dirtyNodes](const EventListener* l) {
+        return dirtyNodes.find(l->getAssociatedNode()) == dirtyNodes.end();
+    };
+    
+    // Nodes which left the scene are never visited and get the lowest priority, whatever their previous position,
+    // so move their listeners to the end to keep the clean ones in order
+    auto outside = std::stable_partition(sceneGraphListeners->begin(), sceneGraphListeners->end(), [](const EventListener* l) {
+        return l->getAssociatedNode()->isRunning();
+    });
+    
+    // When most listeners moved, walking the whole scene graph is cheaper
+    auto dirtyCount = std::count_if(sceneGraphListeners->begin(), outside, [&isClean](const EventListener* l) {
+        return !isClean(l);
+    });
+    if (dirtyCount * 2 > std::distance(sceneGraphListeners->begin(), outside))
+        return false;
+    
+    if (dirtyCount > 0)
+    {
+        auto compare = [this, rootNode](const EventListener* l1, const EventListener* l2) {
+            return isVisitedAfter(l1->getAssociatedNode(), l2->getAssociatedNode(), rootNode);
+        };
+        
+        // Clean listeners are still in order, sort the dirty ones and merge them back
+        auto mid = std::stable_partition(sceneGraphListeners->begin(), outside, isClean);
+        std::stable_sort(mid, outside, compare);
+        std::inplace_merge(sceneGraphListeners->begin(), mid, outside, compare);
+    }
+    
+    return true;
+}
+
+bool EventDispatcher::isVisitedAfter(Node* node1, Node* node2, Node* rootNode) const
+{
+    if (node1 == node2)
+        return false;
+    
+    int depth1 = __getDepthInSceneGraph(node1, rootNode);
+    int depth2 = __getDepthInSceneGraph(node2, rootNode);
+    
+    // Nodes outside of the running scene are never visited and keep the lowest priority
+    if (depth1 < 0)
+        return false;
+    if (depth2 < 0)
+        return true;
+    
+    if (node1->getGlobalZOrder() != node2->getGlobalZOrder())
+        return node1->getGlobalZOrder() > node2->getGlobalZOrder();
+    
+    // Climb to the common ancestor, remembering the children it visits the two nodes through
+    Node* child1 = nullptr;
+    Node* child2 = nullptr;
+    for (; depth1 > depth2; --depth1)
+    {
+        child1 = node1;
+        node1 = node1->getParent();
+    }
+    for (; depth2 > depth1; --depth2)
+    {
+        child2 = node2;
+        node2 = node2->getParent();
+    }
+    while (node1 != node2)
+    {
+        child1 = node1;
+        child2 = node2;
+        node1 = node1->getParent();
+        node2 = node2->getParent();
+    }
+    
+    // A node is visited after its children with negative local z order and before the others
+    if (child1 == nullptr)
+        return child2->_localZOrder < 0;
+    if (child2 == nullptr)
+        return child1->_localZOrder >= 0;
+    
+    // Siblings are visited in the order of Node::sortNodes
+    return (child1->_localZOrder == child2->_localZOrder && child1->_orderOfArrival > child2->_orderOfArrival) || child1->_localZOrder > child2->_localZOrder;
 }
 
 void EventDispatcher::sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID)
@@ -1431,6 +1588,7 @@ void EventDispatcher::removeEventListenersForListenerID(const EventListener::Lis
         // Remove the dirty flag according the 'listenerID'.
         // No need to check whether the dispatcher is dispatching event.
         _priorityDirtyFlagMap.erase(listenerID);
+        clearSceneGraphSortState(listenerID);
         
         if (!_inDispatch)
         {
@@ -1545,6 +1703,12 @@ void EventDispatcher::setDirtyForNode(Node* node)
 
 void EventDispatcher::setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag)
 {    
+    // Without knowing which nodes changed, the scene graph listeners need a full sort
+    if ((int)flag & (int)DirtyFlag::SCENE_GRAPH_PRIORITY)
+    {
+        _sceneGraphDirtyNodesMap.erase(listenerID);
+    }
+    
     auto iter = _priorityDirtyFlagMap.find(listenerID);
     if (iter == _priorityDirtyFlagMap.end())
     {
@@ -1557,6 +1721,34 @@ void EventDispatcher::setDirty(const EventListener::ListenerID& listenerID, Dirt
     }
 }
 
+void EventDispatcher::setDirtyForSceneGraphNode(const EventListener::ListenerID& listenerID, Node* node)
+{
+    auto flagIter = _priorityDirtyFlagMap.find(listenerID);
+    bool isDirty = flagIter != _priorityDirtyFlagMap.end() && ((int)flagIter->second & (int)DirtyFlag::SCENE_GRAPH_PRIORITY);
+    auto nodesIter = _sceneGraphDirtyNodesMap.find(listenerID);
+    
+    // A full sort is already pending, nothing to record
+    if (isDirty && nodesIter == _sceneGraphDirtyNodesMap.end())
+        return;
+    
+    if (!isDirty)
+    {
+        setDirty(listenerID, DirtyFlag::SCENE_GRAPH_PRIORITY);
+        nodesIter = _sceneGraphDirtyNodesMap.emplace(listenerID, std::unordered_set<Node*>()).first;
+    }
+    
+    if (node != nullptr)
+    {
+        nodesIter->second.insert(node);
+    }
+}
+
+void EventDispatcher::clearSceneGraphSortState(const EventListener::ListenerID& listenerID)
+{
+    _sceneGraphDirtyNodesMap.erase(listenerID);
+    _sceneGraphSortedRootMap.erase(listenerID);
+}
+
 void EventDispatcher::cleanToRemovedListeners()
 {
     for (auto& l : _toRemovedListeners)
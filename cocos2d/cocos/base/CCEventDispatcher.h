@@ -29,6 +29,7 @@
 #include <functional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <set>
 
@@ -178,6 +179,18 @@ public:
      */
     void dispatchCustomEvent(const std::string &eventName, void *optionalUserData = nullptr);
 
+    /** Dispatches a batch of events which share a listener ID, in order.
+     *  The listeners are looked up and sorted once for the whole batch. Listeners added while the batch
+     *  is dispatched only receive later events, listeners removed during it receive no more events.
+     *
+     * @param listenerID The listener ID of every event in the batch, it can't be a touch or mouse listener ID.
+     * @param count The number of events in the batch.
+     * @param eventAt Returns the event at an index, it is called right before that event is dispatched.
+     * @js NA
+     * @lua NA
+     */
+    void dispatchEventBatch(const EventListener::ListenerID& listenerID, ssize_t count, const std::function<Event*(ssize_t)>& eventAt);
+
     /** Query whether the specified event listener id has been added.
      *
      * @param listenerID The listenerID of the event listener id.
@@ -264,6 +277,12 @@ protected:
     /** Sorts the listeners of specified type by scene graph priority */
     void sortEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode);
     
+    /** Re-positions only the listeners of dirty nodes, returns false if a full sort is needed instead */
+    bool sortDirtyEventListenersOfSceneGraphPriority(const EventListener::ListenerID& listenerID, Node* rootNode);
+    
+    /** Returns whether node1 gets a higher scene graph priority than node2, in the same order visitTarget would assign */
+    bool isVisitedAfter(Node* node1, Node* node2, Node* rootNode) const;
+    
     /** Sorts the listeners of specified type by fixed priority */
     void sortEventListenersOfFixedPriority(const EventListener::ListenerID& listenerID);
     
@@ -309,6 +328,15 @@ protected:
     /** Sets the dirty flag for a specified listener ID */
     void setDirty(const EventListener::ListenerID& listenerID, DirtyFlag flag);
     
+    /** Sets the scene graph priority dirty flag for a specified listener ID,
+     *  remembering the node whose listeners need to be re-positioned.
+     *  Passing nullptr means the order of the remaining listeners was not changed.
+     */
+    void setDirtyForSceneGraphNode(const EventListener::ListenerID& listenerID, Node* node);
+    
+    /** Forgets the incremental sorting state of a specified listener ID */
+    void clearSceneGraphSortState(const EventListener::ListenerID& listenerID);
+    
     /** Walks though scene graph to get the draw order for each node, it's called before sorting event listener with scene graph priority */
     void visitTarget(Node* node, bool isRootNode);
 
@@ -327,6 +355,12 @@ protected:
     /** The map of node and its event priority */
     std::unordered_map<Node*, int> _nodePriorityMap;
     
+    /** The nodes whose listeners need to be re-positioned by listener ID, only present while an incremental sort is possible */
+    std::unordered_map<EventListener::ListenerID, std::unordered_set<Node*>> _sceneGraphDirtyNodesMap;
+    
+    /** The root node used by the last scene graph priority sort by listener ID */
+    std::unordered_map<EventListener::ListenerID, Node*> _sceneGraphSortedRootMap;
+    
     /** key: Global Z Order, value: Sorted Nodes */
     std::unordered_map<float, std::vector<Node*>> _globalZOrderNodeMap;
     
@@ -0,0 +1,173 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCJobSystem.h"
+#include <algorithm>
+
+NS_CC_BEGIN
+
+JobSystem* JobSystem::s_jobSystem = nullptr;
+
+JobSystem* JobSystem::getInstance()
+{
+    if (s_jobSystem == nullptr)
+    {
+        s_jobSystem = new (std::nothrow) JobSystem();
+    }
+    return s_jobSystem;
+}
+
+void JobSystem::destroyInstance()
+{
+    delete s_jobSystem;
+    s_jobSystem = nullptr;
+}
+
+JobSystem::JobSystem()
+: _threadCount(0)
+, _job(nullptr)
+, _jobCount(0)
+, _nextJob(0)
+, _generation(0)
+, _activeWorkers(0)
+, _running(false)
+, _quit(false)
+{
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    _threadCount = std::max(0, std::min(hardwareThreads - 1, 3));
+    startThreads();
+}
+
+JobSystem::~JobSystem()
+{
+    stopThreads();
+}
+
+void JobSystem::setThreadCount(int threadCount)
+{
+    threadCount = std::max(0, threadCount);
+    if (threadCount == _threadCount)
+        return;
+
+    stopThreads();
+    _threadCount = threadCount;
+    startThreads();
+}
+
+void JobSystem::startThreads()
+{
+    _quit = false;
+    for (int i = 0; i < _threadCount; ++i)
+    {
+        _threads.emplace_back(&JobSystem::workerLoop, this);
+    }
+}
+
+void JobSystem::stopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _quit = true;
+    }
+    _workAvailable.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+    _threads.clear();
+}
+
+void JobSystem::parallelFor(int count, const std::function<void(int)>& job)
+{
+    if (count <= 0)
+        return;
+
+    bool serial = false;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // nested or trivial: no point in waking anybody up
+        serial = _running || _threads.empty() || count == 1;
+        if (!serial)
+        {
+            _job = &job;
+            _jobCount = count;
+            _nextJob = 0;
+            ++_generation;
+            _running = true;
+        }
+    }
+    if (serial)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            job(i);
+        }
+        return;
+    }
+    _workAvailable.notify_all();
+
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    // every index has been claimed once runJobs() returns, so only in-flight jobs are left
+    _workDone.wait(lock, [this]{ return _activeWorkers == 0; });
+    _job = nullptr;
+    _running = false;
+}
+
+void JobSystem::runJobs()
+{
+    for (int i = _nextJob++; i < _jobCount; i = _nextJob++)
+    {
+        (*_job)(i);
+    }
+}
+
+void JobSystem::workerLoop()
+{
+    unsigned int generation = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _workAvailable.wait(lock, [&]{ return _quit || _generation != generation; });
+        if (_quit)
+            break;
+
+        generation = _generation;
+        // the batch may already be finished if this thread woke up late
+        if (_job == nullptr)
+            continue;
+
+        ++_activeWorkers;
+        lock.unlock();
+        runJobs();
+        lock.lock();
+        if (--_activeWorkers == 0)
+        {
+            _workDone.notify_all();
+        }
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,114 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __BASE_CCJOBSYSTEM_H__
+#define __BASE_CCJOBSYSTEM_H__
+
+#include "platform/CCPlatformMacros.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @addtogroup base
+ * @{
+ */
+NS_CC_BEGIN
+
+/**
+ * @class JobSystem
+ * @brief A small pool of worker threads for fork/join work inside a frame.
+ *
+ * Unlike AsyncTaskPool, jobs are not queued for later: parallelFor() blocks until
+ * every job has run, and the calling thread executes jobs itself while it waits.
+ * It is meant to be driven from the cocos thread only.
+ * @js NA
+ */
+class CC_DLL JobSystem
+{
+public:
+    /**
+     * Returns the shared instance of the job system.
+     */
+    static JobSystem* getInstance();
+
+    /**
+     * Destroys the job system, joining its worker threads.
+     */
+    static void destroyInstance();
+
+    /**
+     * Sets the number of worker threads, not counting the calling thread.
+     * 0 runs every job on the calling thread. Default is the number of hardware threads minus one, at most 3.
+     * Must not be called while parallelFor() is running.
+     */
+    void setThreadCount(int threadCount);
+
+    /** Returns the number of worker threads. */
+    int getThreadCount() const { return _threadCount; }
+
+    /**
+     * Runs job(0) ... job(count - 1) on the worker threads and the calling thread,
+     * and returns once all of them have finished.
+     * Jobs must not depend on the order they run in. A nested call from inside a job runs serially.
+     */
+    void parallelFor(int count, const std::function<void(int)>& job);
+
+CC_CONSTRUCTOR_ACCESS:
+    JobSystem();
+    ~JobSystem();
+
+protected:
+    void startThreads();
+    void stopThreads();
+    void workerLoop();
+    void runJobs();
+
+    static JobSystem* s_jobSystem;
+
+    std::vector<std::thread> _threads;
+    int _threadCount;
+
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _workDone;
+
+    const std::function<void(int)>* _job;
+    int _jobCount;
+    std::atomic<int> _nextJob;
+    unsigned int _generation;
+    int _activeWorkers;
+    bool _running;
+    bool _quit;
+};
+
+NS_CC_END
+
+// end group
+/// @}
+
+#endif // __BASE_CCJOBSYSTEM_H__
@@ -27,6 +27,7 @@
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include "base/ccUtils.h"
 
 NS_CC_BEGIN
@@ -39,65 +40,77 @@ const Value Value::Null;
 
 Value::Value()
 : _type(Type::NONE)
+, _isShortString(false)
 {
     memset(&_field, 0, sizeof(_field));
 }
 
 Value::Value(unsigned char v)
 : _type(Type::BYTE)
+, _isShortString(false)
 {
     _field.byteVal = v;
 }
 
 Value::Value(int v)
 : _type(Type::INTEGER)
+, _isShortString(false)
 {
     _field.intVal = v;
 }
 
 Value::Value(unsigned int v)
 : _type(Type::UNSIGNED)
+, _isShortString(false)
 {
     _field.unsignedVal = v;
 }
 
 Value::Value(float v)
 : _type(Type::FLOAT)
+, _isShortString(false)
 {
     _field.floatVal = v;
 }
 
 Value::Value(double v)
 : _type(Type::DOUBLE)
+, _isShortString(false)
 {
     _field.doubleVal = v;
 }
 
 Value::Value(bool v)
 : _type(Type::BOOLEAN)
+, _isShortString(false)
 {
     _field.boolVal = v;
 }
 
 Value::Value(const char* v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _isShortString(false)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    if (v)
-    {
-        *_field.strVal = v;
-    }
+    setString(v ? v : "", v ? strlen(v) : 0);
 }
 
 Value::Value(const std::string& v)
-: _type(Type::STRING)
+: _type(Type::NONE)
+, _isShortString(false)
 {
-    _field.strVal = new (std::nothrow) std::string();
-    *_field.strVal = v;
+    setString(v.c_str(), v.length());
+}
+
+Value::Value(std::string&& v)
+: _type(Type::NONE)
+, _isShortString(false)
+{
+    setString(std::move(v));
 }
 
 Value::Value(const ValueVector& v)
 : _type(Type::VECTOR)
+, _isShortString(false)
 {
     _field.vectorVal = new (std::nothrow) ValueVector();
     *_field.vectorVal = v;
@@ -105,6 +118,7 @@ Value::Value(const ValueVector& v)
 
 Value::Value(ValueVector&& v)
 : _type(Type::VECTOR)
+, _isShortString(false)
 {
     _field.vectorVal = new (std::nothrow) ValueVector();
     *_field.vectorVal = std::move(v);
@@ -112,6 +126,7 @@ Value::Value(ValueVector&& v)
 
 Value::Value(const ValueMap& v)
 : _type(Type::MAP)
+, _isShortString(false)
 {
     _field.mapVal = new (std::nothrow) ValueMap();
     *_field.mapVal = v;
@@ -119,6 +134,7 @@ Value::Value(const ValueMap& v)
 
 Value::Value(ValueMap&& v)
 : _type(Type::MAP)
+, _isShortString(false)
 {
     _field.mapVal = new (std::nothrow) ValueMap();
     *_field.mapVal = std::move(v);
@@ -126,6 +142,7 @@ Value::Value(ValueMap&& v)
 
 Value::Value(const ValueMapIntKey& v)
 : _type(Type::INT_KEY_MAP)
+, _isShortString(false)
 {
     _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
     *_field.intKeyMapVal = v;
@@ -133,6 +150,7 @@ Value::Value(const ValueMapIntKey& v)
 
 Value::Value(ValueMapIntKey&& v)
 : _type(Type::INT_KEY_MAP)
+, _isShortString(false)
 {
     _field.intKeyMapVal = new (std::nothrow) ValueMapIntKey();
     *_field.intKeyMapVal = std::move(v);
@@ -140,12 +158,14 @@ Value::Value(ValueMapIntKey&& v)
 
 Value::Value(const Value& other)
 : _type(Type::NONE)
+, _isShortString(false)
 {
     *this = other;
 }
 
 Value::Value(Value&& other)
 : _type(Type::NONE)
+, _isShortString(false)
 {
     *this = std::move(other);
 }
@@ -180,11 +200,7 @@ Value& Value::operator= (const Value& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                if (_field.strVal == nullptr)
-                {
-                    _field.strVal = new std::string();
-                }
-                *_field.strVal = *other._field.strVal;
+                setString(other.getStringData(), other.getStringLength());
                 break;
             case Type::VECTOR:
                 if (_field.vectorVal == nullptr)
@@ -240,7 +256,8 @@ Value& Value::operator= (Value&& other)
                 _field.boolVal = other._field.boolVal;
                 break;
             case Type::STRING:
-                _field.strVal = other._field.strVal;
+                memcpy(&_field, &other._field, sizeof(_field));
+                _isShortString = other._isShortString;
                 break;
             case Type::VECTOR:
                 _field.vectorVal = other._field.vectorVal;
@@ -258,6 +275,7 @@ Value& Value::operator= (Value&& other)
 
         memset(&other._field, 0, sizeof(other._field));
         other._type = Type::NONE;
+        other._isShortString = false;
     }
 
     return *this;
@@ -307,15 +325,19 @@ Value& Value::operator= (bool v)
 
 Value& Value::operator= (const char* v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v ? v : "";
+    setString(v ? v : "", v ? strlen(v) : 0);
     return *this;
 }
 
 Value& Value::operator= (const std::string& v)
 {
-    reset(Type::STRING);
-    *_field.strVal = v;
+    setString(v.c_str(), v.length());
+    return *this;
+}
+
+Value& Value::operator= (std::string&& v)
+{
+    setString(std::move(v));
     return *this;
 }
 
@@ -386,7 +408,11 @@ bool Value::operator== (const Value& v) const
         case Type::INTEGER: return v._field.intVal      == this->_field.intVal;
         case Type::UNSIGNED:return v._field.unsignedVal == this->_field.unsignedVal;
         case Type::BOOLEAN: return v._field.boolVal     == this->_field.boolVal;
-        case Type::STRING:  return *v._field.strVal     == *this->_field.strVal;
+        case Type::STRING:
+        {
+            const auto length = this->getStringLength();
+            return v.getStringLength() == length && memcmp(v.getStringData(), this->getStringData(), length) == 0;
+        }
         case Type::FLOAT:   return std::abs(v._field.floatVal  - this->_field.floatVal)  <= FLT_EPSILON;
         case Type::DOUBLE:  return std::abs(v._field.doubleVal - this->_field.doubleVal) <= DBL_EPSILON;
         case Type::VECTOR:
@@ -461,7 +487,7 @@ unsigned char Value::asByte() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<unsigned char>(atoi(_field.strVal->c_str()));
+        return static_cast<unsigned char>(atoi(getStringData()));
     }
 
     if (_type == Type::FLOAT)
@@ -503,7 +529,7 @@ int Value::asInt() const
 
     if (_type == Type::STRING)
     {
-        return atoi(_field.strVal->c_str());
+        return atoi(getStringData());
     }
 
     if (_type == Type::FLOAT)
@@ -547,7 +573,7 @@ unsigned int Value::asUnsignedInt() const
     if (_type == Type::STRING)
     {
         // NOTE: strtoul is required (need to augment on unsupported platforms)
-        return static_cast<unsigned int>(strtoul(_field.strVal->c_str(), nullptr, 10));
+        return static_cast<unsigned int>(strtoul(getStringData(), nullptr, 10));
     }
 
     if (_type == Type::FLOAT)
@@ -583,7 +609,7 @@ float Value::asFloat() const
 
     if (_type == Type::STRING)
     {
-        return utils::atof(_field.strVal->c_str());
+        return utils::atof(getStringData());
     }
 
     if (_type == Type::INTEGER)
@@ -624,7 +650,7 @@ double Value::asDouble() const
 
     if (_type == Type::STRING)
     {
-        return static_cast<double>(utils::atof(_field.strVal->c_str()));
+        return static_cast<double>(utils::atof(getStringData()));
     }
 
     if (_type == Type::INTEGER)
@@ -665,7 +691,7 @@ bool Value::asBool() const
 
     if (_type == Type::STRING)
     {
-        return (*_field.strVal == "0" || *_field.strVal == "false") ? false : true;
+        return (strcmp(getStringData(), "0") == 0 || strcmp(getStringData(), "false") == 0) ? false : true;
     }
 
     if (_type == Type::INTEGER)
@@ -697,7 +723,7 @@ std::string Value::asString() const
 
     if (_type == Type::STRING)
     {
-        return *_field.strVal;
+        return _isShortString ? std::string(_field.shortStrVal) : *_field.strVal;
     }
 
     std::stringstream ret;
@@ -884,7 +910,15 @@ void Value::clear()
             _field.boolVal = false;
             break;
         case Type::STRING:
-            CC_SAFE_DELETE(_field.strVal);
+            if (_isShortString)
+            {
+                _field.shortStrVal[0] = '\0';
+                _isShortString = false;
+            }
+            else
+            {
+                CC_SAFE_DELETE(_field.strVal);
+            }
             break;
         case Type::VECTOR:
             CC_SAFE_DELETE(_field.vectorVal);
@@ -913,7 +947,8 @@ void Value::reset(Type type)
     switch (type)
     {
         case Type::STRING:
-            _field.strVal = new (std::nothrow) std::string();
+            _field.shortStrVal[0] = '\0';
+            _isShortString = true;
             break;
         case Type::VECTOR:
             _field.vectorVal = new (std::nothrow) ValueVector();
@@ -931,4 +966,133 @@ void Value::reset(Type type)
     _type = type;
 }
 
+void Value::setString(const char* v, size_t length)
+{
+    // Strings containing '\0' don't fit the short storage which relies on strlen()
+    bool isShort = length <= SHORT_STRING_CAPACITY && memchr(v, '\0', length) == nullptr;
+
+    if (_type == Type::STRING && !_isShortString && !isShort)
+    {
+        // Reuse the allocated string
+        _field.strVal->assign(v, length);
+        return;
+    }
+
+    clear();
+    if (isShort)
+    {
+        memcpy(_field.shortStrVal, v, length);
+        _field.shortStrVal[length] = '\0';
+        _isShortString = true;
+    }
+    else
+    {
+        _field.strVal = new (std::nothrow) std::string(v, length);
+    }
+    _type = Type::STRING;
+}
+
+void Value::setString(std::string&& v)
+{
+    if (v.length() <= SHORT_STRING_CAPACITY)
+    {
+        setString(v.c_str(), v.length());
+        return;
+    }
+
+    if (_type == Type::STRING && !_isShortString)
+    {
+        *_field.strVal = std::move(v);
+        return;
+    }
+
+    clear();
+    _field.strVal = new (std::nothrow) std::string(std::move(v));
+    _type = Type::STRING;
+}
+
+// ValueMapFlat
+
+ValueMapFlat::ValueMapFlat(const ValueMap& v)
+{
+    _items.reserve(v.size());
+    for (const auto& item : v)
+    {
+        _items.push_back(item);
+    }
+    sort();
+}
+
+ValueMapFlat::ValueMapFlat(ValueMap&& v)
+{
+    _items.reserve(v.size());
+    for (auto& item : v)
+    {
+        _items.emplace_back(item.first, std::move(item.second));
+    }
+    v.clear();
+    sort();
+}
+
+void ValueMapFlat::sort()
+{
+    std::sort(_items.begin(), _items.end(), [](const value_type& a, const value_type& b) {
+        return a.first < b.first;
+    });
+}
+
+ValueMapFlat::iterator ValueMapFlat::find(const std::string& key)
+{
+    auto iter = std::lower_bound(_items.begin(), _items.end(), key, [](const value_type& item, const std::string& k) {
+        return item.first < k;
+    });
+    return (iter != _items.end() && iter->first == key) ? iter : _items.end();
+}
+
+ValueMapFlat::const_iterator ValueMapFlat::find(const std::string& key) const
+{
+    auto iter = std::lower_bound(_items.begin(), _items.end(), key, [](const value_type& item, const std::string& k) {
+        return item.first < k;
+    });
+    return (iter != _items.end() && iter->first == key) ? iter : _items.end();
+}
+
+Value& ValueMapFlat::operator[] (const std::string& key)
+{
+    auto iter = std::lower_bound(_items.begin(), _items.end(), key, [](const value_type& item, const std::string& k) {
+        return item.first < k;
+    });
+    if (iter == _items.end() || iter->first != key)
+    {
+        iter = _items.insert(iter, value_type(key, Value::Null));
+    }
+    return iter->second;
+}
+
+const Value& ValueMapFlat::at(const std::string& key) const
+{
+    auto iter = find(key);
+    return iter != _items.end() ? iter->second : Value::Null;
+}
+
+size_t ValueMapFlat::erase(const std::string& key)
+{
+    auto iter = find(key);
+    if (iter == _items.end())
+        return 0;
+    _items.erase(iter);
+    return 1;
+}
+
+ValueMap ValueMapFlat::asValueMap() const
+{
+    ValueMap ret;
+    ret.reserve(_items.size());
+    for (const auto& item : _items)
+    {
+        ret.emplace(item.first, item.second);
+    }
+    return ret;
+}
+
 NS_CC_END
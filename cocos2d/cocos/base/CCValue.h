@@ -28,6 +28,7 @@
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccMacros.h"
+#include <cstring>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -84,6 +85,8 @@ public:
     
     /** Create a Value by a string. */
     explicit Value(const std::string& v);
+    /** Create a Value by a string. It will use std::move internally. */
+    explicit Value(std::string&& v);
     
     /** Create a Value by a ValueVector object. */
     explicit Value(const ValueVector& v);
@@ -129,6 +132,8 @@ public:
     Value& operator= (const char* v);
     /** Assignment operator, assign from string to Value. */
     Value& operator= (const std::string& v);
+    /** Assignment operator, assign from string to Value. It will use std::move internally. */
+    Value& operator= (std::string&& v);
 
     /** Assignment operator, assign from ValueVector to Value. */
     Value& operator= (const ValueVector& v);
@@ -224,9 +229,17 @@ public:
     std::string getDescription() const;
 
 private:
+    /** Strings up to this length are stored inside the Value instead of on the heap. */
+    static const size_t SHORT_STRING_CAPACITY = 15;
+
     void clear();
     void reset(Type type);
 
+    void setString(const char* v, size_t length);
+    void setString(std::string&& v);
+    const char* getStringData() const { return _isShortString ? _field.shortStrVal : _field.strVal->c_str(); }
+    size_t getStringLength() const { return _isShortString ? strlen(_field.shortStrVal) : _field.strVal->length(); }
+
     union
     {
         unsigned char byteVal;
@@ -237,12 +250,69 @@ private:
         bool boolVal;
 
         std::string* strVal;
+        char shortStrVal[SHORT_STRING_CAPACITY + 1];
         ValueVector* vectorVal;
         ValueMap* mapVal;
         ValueMapIntKey* intKeyMapVal;
     }_field;
 
     Type _type;
+    /** Whether a Type::STRING value is stored in _field.shortStrVal rather than _field.strVal. */
+    bool _isShortString;
+};
+
+/**
+ * A dictionary stored as a vector of key/value pairs sorted by key.
+ * Lookups are binary searches over contiguous memory and building it costs a single allocation,
+ * which makes it cheaper than ValueMap for read-mostly dictionaries such as parsed plist or TMX properties.
+ * Inserting or erasing keys moves the following items, prefer ValueMap for dictionaries modified often.
+ */
+class CC_DLL ValueMapFlat
+{
+public:
+    typedef std::pair<std::string, Value> value_type;
+    typedef std::vector<value_type>::iterator iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+    /** Default constructor. */
+    ValueMapFlat() {}
+    /** Create a ValueMapFlat with the items of a ValueMap. */
+    explicit ValueMapFlat(const ValueMap& v);
+    /** Create a ValueMapFlat with the items of a ValueMap. It will use std::move internally. */
+    explicit ValueMapFlat(ValueMap&& v);
+
+    /** Finds the item of a key, returns end() if there isn't one. */
+    iterator find(const std::string& key);
+    /** Finds the item of a key, returns end() if there isn't one. */
+    const_iterator find(const std::string& key) const;
+    /** Returns 1 if the key exists, 0 if not. */
+    size_t count(const std::string& key) const { return find(key) != end() ? 1 : 0; }
+
+    /** Gets the value of a key, inserting a null Value if there isn't one. */
+    Value& operator[] (const std::string& key);
+    /** Gets the value of a key, or Value::Null if there isn't one. */
+    const Value& at(const std::string& key) const;
+
+    /** Removes the item of a key, returns the number of removed items. */
+    size_t erase(const std::string& key);
+
+    /** Converts back to a ValueMap. */
+    ValueMap asValueMap() const;
+
+    void reserve(size_t n) { _items.reserve(n); }
+    void clear() { _items.clear(); }
+    size_t size() const { return _items.size(); }
+    bool empty() const { return _items.empty(); }
+
+    iterator begin() { return _items.begin(); }
+    iterator end() { return _items.end(); }
+    const_iterator begin() const { return _items.begin(); }
+    const_iterator end() const { return _items.end(); }
+
+private:
+    void sort();
+
+    std::vector<value_type> _items;
 };
 
 /** @} */
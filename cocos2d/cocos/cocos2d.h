@@ -40,6 +40,7 @@ THE SOFTWARE.
 
 // base
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCJobSystem.h"
 #include "base/CCAutoreleasePool.h"
 #include "base/CCConfiguration.h"
 #include "base/CCConsole.h"
@@ -128,10 +129,13 @@ THE SOFTWARE.
 #include "2d/CCMotionStreak.h"
 #include "2d/CCNode.h"
 #include "2d/CCNodeGrid.h"
+#include "2d/CCNodePool.h"
+#include "2d/CCDynamicAtlas.h"
 #include "2d/CCParticleBatchNode.h"
 #include "2d/CCParticleExamples.h"
 #include "2d/CCParticleSystem.h"
 #include "2d/CCParticleSystemQuad.h"
+#include "2d/CCParticleSystemGPU.h"
 #include "2d/CCProgressTimer.h"
 #include "2d/CCProtectedNode.h"
 #include "2d/CCRenderTexture.h"
@@ -183,12 +187,14 @@ THE SOFTWARE.
 #include "physics/CCPhysicsContact.h"
 #include "physics/CCPhysicsJoint.h"
 #include "physics/CCPhysicsShape.h"
+#include "physics/CCPhysicsTMXLayerBaker.h"
 #include "physics/CCPhysicsWorld.h"
 
 // platform
 #include "platform/CCCommon.h"
 #include "platform/CCDevice.h"
 #include "platform/CCFileUtils.h"
+#include "platform/CCFileView.h"
 #include "platform/CCImage.h"
 #include "platform/CCPlatformConfig.h"
 #include "platform/CCPlatformMacros.h"
@@ -25,6 +25,7 @@
 
 #include "network/CCDownloader-curl.h"
 
+#include <algorithm>
 #include <set>
 
 #include <curl/curl.h>
@@ -40,6 +41,8 @@
 // member function without suffix designed called in main thread
 
 #define CC_CURL_POLL_TIMEOUT_MS 50 //wait until DNS query done
+#define CC_CHUNKS_SAVE_INTERVAL (1024 * 1024) // received bytes between two saves of the chunk progress
+#define CC_CHUNKS_FILE_SUFFIX ".chunks"
 
 namespace cocos2d { namespace network {
     using namespace std;
@@ -47,6 +50,19 @@ namespace cocos2d { namespace network {
 ////////////////////////////////////////////////////////////////////////////////
 //  Implementation DownloadTaskCURL
 
+    class DownloadTaskCURL;
+
+    // a byte range of a file task, transferred by its own curl handle
+    struct DownloadChunkCURL
+    {
+        DownloadTaskCURL *owner;
+        CURL    *handle;        // nullptr if the range is not transferring
+        int64_t begin;          // first byte of the range in the file
+        int64_t end;            // one past the last byte
+        int64_t received;       // bytes written from begin
+        bool    rangeChecked;   // the server answered with the partial content
+    };
+
     class DownloadTaskCURL : public IDownloadTask
     {
         static int _sSerialId;
@@ -60,6 +76,8 @@ namespace cocos2d { namespace network {
         DownloadTaskCURL()
         : serialId(_sSerialId++)
         , _fp(nullptr)
+        , _checksumType(DownloadTask::ChecksumType::NONE)
+        , _readFp(nullptr)
         {
             _initInternal();
             DLLOG("Construct DownloadTaskCURL %p", this);
@@ -78,11 +96,19 @@ namespace cocos2d { namespace network {
                 fclose(_fp);
                 _fp = nullptr;
             }
+            if (_readFp)
+            {
+                fclose(_readFp);
+                _readFp = nullptr;
+            }
             DLLOG("Destruct DownloadTaskCURL %p", this);
         }
 
-        bool init(const string& filename, const string& tempSuffix)
+        bool init(const string& filename, const string& tempSuffix, DownloadTask::ChecksumType checksumType, const string& checksum)
         {
+            _checksumType = checksumType;
+            _checksumExpected = checksum;
+
             if (0 == filename.length())
             {
                 // data task
@@ -171,6 +197,7 @@ namespace cocos2d { namespace network {
             if (_fp)
             {
                 ret = fwrite(buffer, size, count, _fp);
+                _digestProc(_totalBytesReceived, buffer, ret);
             }
             else
             {
@@ -191,6 +218,56 @@ namespace cocos2d { namespace network {
             return ret;
         }
 
+        size_t writeChunkDataProc(DownloadChunkCURL& chunk, unsigned char *buffer, size_t len)
+        {
+            lock_guard<mutex> lock(_mutex);
+            if (!chunk.rangeChecked)
+            {
+                // a server ignoring the range sends the whole file, which doesn't belong at this offset
+                long httpResponseCode = 0;
+                curl_easy_getinfo(chunk.handle, CURLINFO_RESPONSE_CODE, &httpResponseCode);
+                if (206 != httpResponseCode)
+                {
+                    _errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                    _errCodeInternal = 0;
+                    _errDescription = "Server doesn't support byte ranges of:";
+                    _errDescription.append(_fileName);
+                    return 0;
+                }
+                chunk.rangeChecked = true;
+            }
+
+            int64_t offset = chunk.begin + chunk.received;
+            if (offset + (int64_t)len > chunk.end)
+            {
+                _errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                _errCodeInternal = 0;
+                _errDescription = "Server sent more than the requested range of:";
+                _errDescription.append(_fileName);
+                return 0;
+            }
+            if (0 != fseek(_fp, (long)offset, SEEK_SET) || len != fwrite(buffer, 1, len, _fp))
+            {
+                _errCode = DownloadTask::ERROR_FILE_OP_FAILED;
+                _errCodeInternal = 0;
+                _errDescription = "Can't write file:";
+                _errDescription.append(_tempFileName);
+                return 0;
+            }
+
+            chunk.received += len;
+            _bytesReceived += len;
+            _totalBytesReceived += len;
+            _digestProc(offset, buffer, len);
+
+            _bytesSinceSaved += len;
+            if (_bytesSinceSaved >= CC_CHUNKS_SAVE_INTERVAL)
+            {
+                _saveChunksProc();
+            }
+            return len;
+        }
+
     private:
         friend class DownloaderCURL;
 
@@ -219,6 +296,19 @@ namespace cocos2d { namespace network {
         vector<unsigned char> _buf;
         FILE*  _fp;
 
+        // for verifying the file while writing
+        DownloadTask::ChecksumType _checksumType;
+        string  _checksumExpected;
+        DownloadChecksum _checksum;
+        int64_t _checksumOffset;    // the file is digested up to this offset
+        FILE*   _readFp;            // reads back the data written before the checksum offset reached it
+
+        // for chunked file tasks
+        vector<DownloadChunkCURL> _chunks;
+        int     _runningChunks;
+        int64_t _bytesSinceSaved;
+        string  _validator;         // ETag or Last-Modified of the file the chunks belong to
+
         void _initInternal()
         {
             _acceptRanges = (false);
@@ -230,6 +320,232 @@ namespace cocos2d { namespace network {
             _errCodeInternal = (CURLE_OK);
             _header.resize(0);
             _header.reserve(384);   // pre alloc header string buffer
+            _checksum.reset(_checksumType);
+            _checksumOffset = 0;
+            _chunks.clear();
+            _runningChunks = 0;
+            _bytesSinceSaved = 0;
+            _validator.clear();
+        }
+
+        string _chunksFileName() const
+        {
+            return _tempFileName + CC_CHUNKS_FILE_SUFFIX;
+        }
+
+        bool _reopenTempFileProc(const char *mode)
+        {
+            if (_readFp)
+            {
+                fclose(_readFp);
+                _readFp = nullptr;
+            }
+            if (_fp)
+            {
+                fclose(_fp);
+            }
+            _fp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName).c_str(), mode);
+            return nullptr != _fp;
+        }
+
+        // the end of the data written contiguously from offset
+        int64_t _writtenEndProc(int64_t offset) const
+        {
+            if (_chunks.empty())
+            {
+                return _totalBytesReceived;
+            }
+            for (auto& chunk : _chunks)
+            {
+                if (offset >= chunk.end)
+                {
+                    continue;
+                }
+                if (offset < chunk.begin)
+                {
+                    break;
+                }
+                offset = chunk.begin + chunk.received;
+                if (offset < chunk.end)
+                {
+                    break;
+                }
+            }
+            return offset;
+        }
+
+        // digest the data in order: from memory if it continues the digested data, otherwise read it back later
+        void _digestProc(int64_t offset, const unsigned char *buffer, size_t len)
+        {
+            if (DownloadTask::ChecksumType::NONE == _checksumType)
+            {
+                return;
+            }
+            if (offset != _checksumOffset)
+            {
+                _digestFileProc();
+            }
+            // once the file is caught up, the buffer may continue it, as after a single stream resumes
+            if (offset == _checksumOffset)
+            {
+                _checksum.update(buffer, len);
+                _checksumOffset += len;
+            }
+        }
+
+        void _digestFileProc()
+        {
+            int64_t end = _writtenEndProc(_checksumOffset);
+            if (end <= _checksumOffset || nullptr == _fp)
+            {
+                return;
+            }
+
+            fflush(_fp);
+            if (nullptr == _readFp)
+            {
+                _readFp = fopen(FileUtils::getInstance()->getSuitableFOpen(_tempFileName).c_str(), "rb");
+            }
+            if (nullptr == _readFp || 0 != fseek(_readFp, (long)_checksumOffset, SEEK_SET))
+            {
+                return;
+            }
+
+            unsigned char buf[16384];
+            while (_checksumOffset < end)
+            {
+                size_t len = fread(buf, 1, (size_t)std::min<int64_t>(sizeof(buf), end - _checksumOffset), _readFp);
+                if (0 == len)
+                {
+                    break;
+                }
+                _checksum.update(buf, len);
+                _checksumOffset += len;
+            }
+        }
+
+        bool _verifyChecksumProc()
+        {
+            if (DownloadTask::ChecksumType::NONE == _checksumType)
+            {
+                return true;
+            }
+            _digestFileProc();
+            return _checksumOffset == _totalBytesReceived && _checksum.verify(_checksumExpected);
+        }
+
+        // flush the file, then record how much of every chunk it holds
+        void _saveChunksProc()
+        {
+            _bytesSinceSaved = 0;
+            if (_chunks.empty() || nullptr == _fp)
+            {
+                return;
+            }
+            fflush(_fp);
+
+            auto util = FileUtils::getInstance();
+            string fileName = _chunksFileName();
+            string tempFileName = fileName + ".tmp";
+            FILE *fp = fopen(util->getSuitableFOpen(tempFileName).c_str(), "wb");
+            if (nullptr == fp)
+            {
+                return;
+            }
+            fprintf(fp, "%lld %d\n%s\n", (long long)_totalBytesExpected, (int)_chunks.size(), _validator.c_str());
+            for (auto& chunk : _chunks)
+            {
+                fprintf(fp, "%lld %lld %lld\n", (long long)chunk.begin, (long long)chunk.end, (long long)chunk.received);
+            }
+            bool ok = 0 == ferror(fp);
+            ok = 0 == fclose(fp) && ok;
+            if (ok)
+            {
+                util->renameFile(tempFileName, fileName);
+            }
+        }
+
+        // restore the chunks saved for the same file, false if there are none
+        bool _loadChunksProc()
+        {
+            auto util = FileUtils::getInstance();
+            FILE *fp = fopen(util->getSuitableFOpen(_chunksFileName()).c_str(), "rb");
+            if (nullptr == fp)
+            {
+                return false;
+            }
+
+            bool ok = false;
+            do
+            {
+                long long total = 0;
+                int count = 0;
+                char validator[512] = { 0 };
+                if (2 != fscanf(fp, "%lld %d", &total, &count) || total != _totalBytesExpected || count <= 0 || count > 1024)
+                {
+                    break;
+                }
+                fgetc(fp);
+                if (nullptr == fgets(validator, sizeof(validator), fp))
+                {
+                    break;
+                }
+                validator[strcspn(validator, "\r\n")] = '\0';
+                if (_validator != validator)
+                {
+                    break;
+                }
+
+                // trust no more than the temp file holds
+                int64_t fileSize = util->getFileSize(_tempFileName);
+                int64_t expectedBegin = 0;
+                int parsed = 0;
+                _chunks.resize(count);
+                for (auto& chunk : _chunks)
+                {
+                    long long begin = 0, end = 0, received = 0;
+                    if (3 != fscanf(fp, "%lld %lld %lld", &begin, &end, &received)
+                        || begin != expectedBegin || end <= begin || received < 0 || received > end - begin)
+                    {
+                        break;
+                    }
+                    chunk.owner = this;
+                    chunk.handle = nullptr;
+                    chunk.begin = begin;
+                    chunk.end = end;
+                    chunk.received = std::max<int64_t>(0, std::min<int64_t>(received, fileSize - begin));
+                    chunk.rangeChecked = false;
+                    expectedBegin = end;
+                    ++parsed;
+                }
+                ok = parsed == count && expectedBegin == total;
+            } while (0);
+            fclose(fp);
+
+            if (!ok)
+            {
+                _chunks.clear();
+            }
+            return ok;
+        }
+
+        // split the file into ranges, keeping the data a previous single stream left in the temp file
+        void _planChunksProc(int count)
+        {
+            int64_t fileSize = FileUtils::getInstance()->getFileSize(_tempFileName);
+            int64_t size = (_totalBytesExpected + count - 1) / count;
+            count = (int)((_totalBytesExpected + size - 1) / size);
+            _chunks.resize(count);
+            for (int i = 0; i < count; ++i)
+            {
+                DownloadChunkCURL& chunk = _chunks[i];
+                chunk.owner = this;
+                chunk.handle = nullptr;
+                chunk.begin = size * i;
+                chunk.end = std::min(_totalBytesExpected, chunk.begin + size);
+                chunk.received = std::max<int64_t>(0, std::min(fileSize, chunk.end) - chunk.begin);
+                chunk.rangeChecked = false;
+            }
         }
     };
     int DownloadTaskCURL::_sSerialId;
@@ -329,6 +645,29 @@ namespace cocos2d { namespace network {
             return coTask->writeDataProc((unsigned char *)buffer, size, count);
         }
 
+        static size_t _outputChunkDataCallbackProc(void *buffer, size_t size, size_t count, void *userdata)
+        {
+            DownloadChunkCURL *chunk = (DownloadChunkCURL*)userdata;
+            return chunk->owner->writeChunkDataProc(*chunk, (unsigned char *)buffer, size * count);
+        }
+
+        // the value of the last header named name, headers of redirects included
+        static string _findHeaderValue(const string& header, const string& name)
+        {
+            string lowerHeader = header;
+            std::transform(lowerHeader.begin(), lowerHeader.end(), lowerHeader.begin(), ::tolower);
+            size_t pos = lowerHeader.rfind("\n" + name + ":");
+            if (string::npos == pos)
+            {
+                return "";
+            }
+            pos += name.length() + 2;
+            size_t end = header.find_first_of("\r\n", pos);
+            string value = header.substr(pos, string::npos == end ? string::npos : end - pos);
+            size_t first = value.find_first_not_of(" \t");
+            return string::npos == first ? "" : value.substr(first);
+        }
+
         // this function designed call in work thread
         // the curl handle destroyed in _threadProc
         // handle inited for get header
@@ -432,6 +771,13 @@ namespace cocos2d { namespace network {
 
                 bool acceptRanges = (string::npos != coTask._header.find("Accept-Ranges")) ? true : false;
 
+                // identifies the version of the file saved chunks belong to
+                string validator = _findHeaderValue(coTask._header, "etag");
+                if (validator.empty())
+                {
+                    validator = _findHeaderValue(coTask._header, "last-modified");
+                }
+
                 // get current file size
                 int64_t fileSize = 0;
                 if (acceptRanges && coTask._tempFileName.length())
@@ -443,6 +789,7 @@ namespace cocos2d { namespace network {
                 lock_guard<mutex> lock(coTask._mutex);
                 coTask._totalBytesExpected = (int64_t)contentLen;
                 coTask._acceptRanges = acceptRanges;
+                coTask._validator = validator;
                 if (acceptRanges && fileSize > 0)
                 {
                     coTask._totalBytesReceived = fileSize;
@@ -457,6 +804,235 @@ namespace cocos2d { namespace network {
             return coTask._headerAchieved;
         }
 
+        enum class ChunksState
+        {
+            NONE,       // the content is fetched as a single stream
+            RUNNING,    // the handles of the chunks are transferring
+            FINISHED,   // nothing left to transfer, or the chunks failed to start
+        };
+
+        // after get header info, fetch the content as parallel byte ranges if the file is large enough
+        // or if chunks of the same file were saved
+        ChunksState _startChunksProc(CURLM *curlmHandle, TaskWrapper& wrapper, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            if (nullptr == coTask._fp)
+            {
+                return ChunksState::NONE;
+            }
+
+            lock_guard<mutex> lock(coTask._mutex);
+            int64_t minSizeOfChunk = hints.minSizeOfChunk ? hints.minSizeOfChunk : 1024 * 1024;
+            int countOfChunks = (int)std::min<int64_t>(hints.countOfChunksPerFileTask, coTask._totalBytesExpected / minSizeOfChunk);
+            bool rangesUsable = coTask._acceptRanges && coTask._totalBytesExpected > 0;
+            auto util = FileUtils::getInstance();
+            bool hasChunks = util->isFileExist(coTask._chunksFileName());
+            bool chunksLoaded = rangesUsable && hasChunks && coTask._loadChunksProc();
+            if (hasChunks && !chunksLoaded)
+            {
+                // the temp file of older chunks has holes and may hold another version of the file,
+                // so none of it can be kept as a received prefix
+                util->removeFile(coTask._chunksFileName());
+                coTask._reopenTempFileProc("wb");
+                coTask._totalBytesReceived = 0;
+            }
+
+            bool chunked = chunksLoaded || (rangesUsable && countOfChunks > 1);
+            if (!chunked)
+            {
+                // without ranges the stream can't continue a temp file
+                if (!coTask._acceptRanges && util->getFileSize(coTask._tempFileName) > 0)
+                {
+                    coTask._reopenTempFileProc("wb");
+                    coTask._totalBytesReceived = 0;
+                }
+                return ChunksState::NONE;
+            }
+
+            if (coTask._chunks.empty())
+            {
+                coTask._planChunksProc(countOfChunks);
+            }
+
+            // write the ranges in place
+            if (!coTask._reopenTempFileProc("r+b"))
+            {
+                coTask._errCode = DownloadTask::ERROR_FILE_OP_FAILED;
+                coTask._errCodeInternal = 0;
+                coTask._errDescription = "Can't open file:";
+                coTask._errDescription.append(coTask._tempFileName);
+                return ChunksState::FINISHED;
+            }
+
+            coTask._totalBytesReceived = 0;
+            for (auto& chunk : coTask._chunks)
+            {
+                coTask._totalBytesReceived += chunk.received;
+            }
+            coTask._saveChunksProc();
+
+            for (auto& chunk : coTask._chunks)
+            {
+                if (chunk.received == chunk.end - chunk.begin)
+                {
+                    continue;
+                }
+
+                CURL *handle = curl_easy_init();
+                if (nullptr == handle)
+                {
+                    coTask._errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                    coTask._errCodeInternal = 0;
+                    coTask._errDescription = "Alloc curl handle failed.";
+                    break;
+                }
+
+                char range[64];
+                sprintf(range, "%lld-%lld", (long long)(chunk.begin + chunk.received), (long long)(chunk.end - 1));
+                _initCurlHandleProc(handle, wrapper, true);
+                curl_easy_setopt(handle, CURLOPT_RESUME_FROM_LARGE, (curl_off_t)0);
+                curl_easy_setopt(handle, CURLOPT_RANGE, range);
+                curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, DownloaderCURL::Impl::_outputChunkDataCallbackProc);
+                curl_easy_setopt(handle, CURLOPT_WRITEDATA, &chunk);
+
+                CURLMcode mcode = curl_multi_add_handle(curlmHandle, handle);
+                if (CURLM_OK != mcode)
+                {
+                    curl_easy_cleanup(handle);
+                    coTask._errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                    coTask._errCodeInternal = mcode;
+                    coTask._errDescription = curl_multi_strerror(mcode);
+                    break;
+                }
+                chunk.handle = handle;
+                coTaskMap[handle] = wrapper;
+                ++coTask._runningChunks;
+            }
+
+            if (DownloadTask::ERROR_NO_ERROR != coTask._errCode)
+            {
+                _abortChunksProc(curlmHandle, coTask, coTaskMap);
+            }
+            return coTask._runningChunks > 0 ? ChunksState::RUNNING : ChunksState::FINISHED;
+        }
+
+        // stop the transferring chunks of a task, the caller holds the lock of the task
+        void _abortChunksProc(CURLM *curlmHandle, DownloadTaskCURL& coTask, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            for (auto& chunk : coTask._chunks)
+            {
+                if (chunk.handle)
+                {
+                    curl_multi_remove_handle(curlmHandle, chunk.handle);
+                    curl_easy_cleanup(chunk.handle);
+                    coTaskMap.erase(chunk.handle);
+                    chunk.handle = nullptr;
+                }
+            }
+            coTask._runningChunks = 0;
+        }
+
+        // a chunk handle is done, returns true when the whole task is
+        bool _onChunkDoneProc(CURLM *curlmHandle, CURL *handle, CURLcode errCode, TaskWrapper& wrapper, unordered_map<CURL*, TaskWrapper>& coTaskMap)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            lock_guard<mutex> lock(coTask._mutex);
+
+            for (auto& chunk : coTask._chunks)
+            {
+                if (chunk.handle != handle)
+                {
+                    continue;
+                }
+                chunk.handle = nullptr;
+                --coTask._runningChunks;
+                if (DownloadTask::ERROR_NO_ERROR != coTask._errCode)
+                {
+                    // the error is set by the write callback
+                }
+                else if (CURLE_OK != errCode)
+                {
+                    coTask._errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                    coTask._errCodeInternal = errCode;
+                    coTask._errDescription = curl_easy_strerror(errCode);
+                }
+                else if (chunk.received != chunk.end - chunk.begin)
+                {
+                    coTask._errCode = DownloadTask::ERROR_IMPL_INTERNAL;
+                    coTask._errCodeInternal = 0;
+                    coTask._errDescription = "Incomplete range of:";
+                    coTask._errDescription.append(coTask._fileName);
+                }
+                break;
+            }
+            coTaskMap.erase(handle);
+            curl_easy_cleanup(handle);
+
+            if (DownloadTask::ERROR_NO_ERROR != coTask._errCode)
+            {
+                _abortChunksProc(curlmHandle, coTask, coTaskMap);
+            }
+            if (coTask._runningChunks > 0)
+            {
+                coTask._saveChunksProc();
+                return false;
+            }
+            return true;
+        }
+
+        // verify the file of a done task, then hand the task to the main thread
+        void _finishTaskProc(TaskWrapper& wrapper)
+        {
+            DownloadTaskCURL& coTask = *wrapper.second;
+            {
+                lock_guard<mutex> lock(coTask._mutex);
+                if (coTask._fp && DownloadTask::ERROR_NO_ERROR == coTask._errCode)
+                {
+                    auto util = FileUtils::getInstance();
+                    if (coTask._verifyChecksumProc())
+                    {
+                        util->removeFile(coTask._chunksFileName());
+                    }
+                    else
+                    {
+                        // start over next time
+                        coTask._errCode = DownloadTask::ERROR_CHECKSUM_MISMATCH;
+                        coTask._errCodeInternal = 0;
+                        coTask._errDescription = "Checksum mismatch:";
+                        coTask._errDescription.append(coTask._fileName);
+                        fclose(coTask._fp);
+                        coTask._fp = nullptr;
+                        util->removeFile(coTask._tempFileName);
+                        util->removeFile(coTask._chunksFileName());
+                    }
+                }
+                else
+                {
+                    // resume the chunks next time
+                    coTask._saveChunksProc();
+                }
+                if (coTask._readFp)
+                {
+                    fclose(coTask._readFp);
+                    coTask._readFp = nullptr;
+                }
+            }
+
+            // remove from _processSet
+            {
+                lock_guard<mutex> lock(_processMutex);
+                if (_processSet.end() != _processSet.find(wrapper)) {
+                    _processSet.erase(wrapper);
+                }
+            }
+
+            // add to finishedQueue
+            {
+                lock_guard<mutex> lock(_finishedMutex);
+                _finishedQueue.push_back(wrapper);
+            }
+        }
+
         void _threadProc()
         {
             DLLOG("++++DownloaderCURL::Impl::_threadProc begin %p", this);
@@ -557,7 +1133,19 @@ namespace cocos2d { namespace network {
 
                             // remove from multi-handle
                             curl_multi_remove_handle(curlmHandle, curlHandle);
+
+                            // a range of a chunked task, the task finishes with its last range
+                            if (wrapper.second->_runningChunks > 0)
+                            {
+                                if (_onChunkDoneProc(curlmHandle, curlHandle, errCode, wrapper, coTaskMap))
+                                {
+                                    _finishTaskProc(wrapper);
+                                }
+                                continue;
+                            }
+
                             bool reinited = false;
+                            bool chunked = false;
                             do
                             {
                                 if (CURLE_OK != errCode)
@@ -580,6 +1168,14 @@ namespace cocos2d { namespace network {
                                     break;
                                 }
 
+                                // large files continue as chunks with their own handles
+                                ChunksState chunksState = _startChunksProc(curlmHandle, wrapper, coTaskMap);
+                                if (ChunksState::NONE != chunksState)
+                                {
+                                    chunked = ChunksState::RUNNING == chunksState;
+                                    break;
+                                }
+
                                 // after get header info success
                                 // wrapper.second->_totalBytesReceived inited by local file size
                                 // if the local file size equal with the content size from header, the file has downloaded finish
@@ -612,25 +1208,20 @@ namespace cocos2d { namespace network {
                            // remove from coTaskMap
                             coTaskMap.erase(curlHandle);
 
-                            // remove from _processSet
-                            {
-                                lock_guard<mutex> lock(_processMutex);
-                                if (_processSet.end() != _processSet.find(wrapper)) {
-                                    _processSet.erase(wrapper);
-                                }
-                            }
-
-                            // add to finishedQueue
+                            if (!chunked)
                             {
-                                lock_guard<mutex> lock(_finishedMutex);
-                                _finishedQueue.push_back(wrapper);
+                                _finishTaskProc(wrapper);
                             }
                         }
                     } while(m);
                 }
 
-                // process tasks in _requestList
-                auto size = coTaskMap.size();
+                // process tasks in _requestList, the chunks of a task count as one
+                size_t size = 0;
+                {
+                    lock_guard<mutex> lock(_processMutex);
+                    size = _processSet.size();
+                }
                 while (0 == countOfMaxProcessingTasks || size < countOfMaxProcessingTasks)
                 {
                     // get task wrapper from request queue
@@ -678,6 +1269,7 @@ namespace cocos2d { namespace network {
 
                     DLLOG("    _threadProc task create curl handle:%p", curlHandle);
                     coTaskMap[curlHandle] = wrapper;
+                    ++size;
                     lock_guard<mutex> lock(_processMutex);
                     _processSet.insert(wrapper);
                 }
@@ -748,7 +1340,7 @@ namespace cocos2d { namespace network {
     IDownloadTask *DownloaderCURL::createCoTask(std::shared_ptr<const DownloadTask>& task)
     {
         DownloadTaskCURL *coTask = new (std::nothrow) DownloadTaskCURL;
-        coTask->init(task->storagePath, _impl->hints.tempFileNameSuffix);
+        coTask->init(task->storagePath, _impl->hints.tempFileNameSuffix, task->checksumType, task->checksum);
 
         DLLOG("    DownloaderCURL: createTask: Id(%d)", coTask->serialId);
 
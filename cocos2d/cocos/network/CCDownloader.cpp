@@ -25,6 +25,10 @@
 
 #include "network/CCDownloader.h"
 
+#include "md5/md5.h"
+#include "xxhash.h"
+#include "platform/CCFileUtils.h"
+
 // include platform specific implement class
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_MAC || CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
 
@@ -40,12 +44,14 @@
 
 #include "network/CCDownloader-curl.h"
 #define DownloaderImpl  DownloaderCURL
+#define DOWNLOADER_IMPL_VERIFIES_CHECKSUM
 
 #endif
 
 namespace cocos2d { namespace network {
 
     DownloadTask::DownloadTask()
+    : checksumType(ChecksumType::NONE)
     {
         DLLOG("Construct DownloadTask %p", this);
     }
@@ -55,6 +61,121 @@ namespace cocos2d { namespace network {
         DLLOG("Destruct DownloadTask %p", this);
     }
 
+////////////////////////////////////////////////////////////////////////////////
+//  Implement DownloadChecksum
+    struct DownloadChecksum::State
+    {
+        DownloadTask::ChecksumType type;
+        md5_state_t md5;
+        XXH32_stateSpace_t xxh32;
+    };
+
+    DownloadChecksum::DownloadChecksum()
+    : _state(new (std::nothrow) State)
+    {
+        _state->type = DownloadTask::ChecksumType::NONE;
+    }
+
+    DownloadChecksum::~DownloadChecksum()
+    {
+        delete _state;
+    }
+
+    void DownloadChecksum::reset(DownloadTask::ChecksumType type)
+    {
+        _state->type = type;
+        if (DownloadTask::ChecksumType::MD5 == type)
+        {
+            md5_init(&_state->md5);
+        }
+        else if (DownloadTask::ChecksumType::XXH32 == type)
+        {
+            XXH32_resetState(&_state->xxh32, 0);
+        }
+    }
+
+    void DownloadChecksum::update(const void *data, size_t size)
+    {
+        // both digests take int lengths
+        static const size_t MAX_BLOCK = 1 << 30;
+        const unsigned char *bytes = (const unsigned char *)data;
+        while (size > 0)
+        {
+            int len = (int)std::min(size, MAX_BLOCK);
+            if (DownloadTask::ChecksumType::MD5 == _state->type)
+            {
+                md5_append(&_state->md5, (const md5_byte_t *)bytes, len);
+            }
+            else if (DownloadTask::ChecksumType::XXH32 == _state->type)
+            {
+                XXH32_update(&_state->xxh32, bytes, len);
+            }
+            bytes += len;
+            size -= len;
+        }
+    }
+
+    bool DownloadChecksum::verify(const std::string& expected)
+    {
+        char hexOutput[33] = { 0 };
+        if (DownloadTask::ChecksumType::MD5 == _state->type)
+        {
+            md5_byte_t digest[16];
+            md5_finish(&_state->md5, digest);
+            for (int di = 0; di < 16; ++di)
+                sprintf(hexOutput + di * 2, "%02x", digest[di]);
+        }
+        else if (DownloadTask::ChecksumType::XXH32 == _state->type)
+        {
+            // XXH32_digest() would free the state
+            sprintf(hexOutput, "%08x", XXH32_intermediateDigest(&_state->xxh32));
+        }
+        else
+        {
+            return true;
+        }
+        _state->type = DownloadTask::ChecksumType::NONE;
+
+        if (expected.length() != strlen(hexOutput))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < expected.length(); ++i)
+        {
+            if (tolower((unsigned char)expected[i]) != hexOutput[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool DownloadChecksum::verifyFile(const std::string& path, DownloadTask::ChecksumType type, const std::string& expected)
+    {
+        if (DownloadTask::ChecksumType::NONE == type)
+        {
+            return true;
+        }
+
+        FILE *fp = fopen(FileUtils::getInstance()->getSuitableFOpen(path).c_str(), "rb");
+        if (nullptr == fp)
+        {
+            return false;
+        }
+
+        DownloadChecksum checksum;
+        checksum.reset(type);
+        unsigned char buf[16384];
+        size_t len = 0;
+        while ((len = fread(buf, 1, sizeof(buf), fp)) > 0)
+        {
+            checksum.update(buf, len);
+        }
+        bool failed = ferror(fp) != 0;
+        fclose(fp);
+        return !failed && checksum.verify(expected);
+    }
+
 ////////////////////////////////////////////////////////////////////////////////
 //  Implement Downloader
     Downloader::Downloader()
@@ -63,7 +184,9 @@ namespace cocos2d { namespace network {
         {
             6,
             45,
-            ".tmp"
+            ".tmp",
+            0,
+            0
         };
         new(this)Downloader(hints);
     }
@@ -99,6 +222,20 @@ namespace cocos2d { namespace network {
                 return;
             }
 
+#ifndef DOWNLOADER_IMPL_VERIFIES_CHECKSUM
+            // the platform downloader doesn't digest while writing, check the finished file instead
+            if (task.storagePath.length()
+                && !DownloadChecksum::verifyFile(task.storagePath, task.checksumType, task.checksum))
+            {
+                FileUtils::getInstance()->removeFile(task.storagePath);
+                if (onTaskError)
+                {
+                    onTaskError(task, DownloadTask::ERROR_CHECKSUM_MISMATCH, 0, "Checksum mismatch: " + task.storagePath);
+                }
+                return;
+            }
+#endif
+
             // success callback
             if (task.storagePath.length())
             {
@@ -149,6 +286,15 @@ namespace cocos2d { namespace network {
     std::shared_ptr<const DownloadTask> Downloader::createDownloadFileTask(const std::string& srcUrl,
                                                                            const std::string& storagePath,
                                                                            const std::string& identifier/* = ""*/)
+    {
+        return createDownloadFileTask(srcUrl, storagePath, identifier, DownloadTask::ChecksumType::NONE, "");
+    }
+
+    std::shared_ptr<const DownloadTask> Downloader::createDownloadFileTask(const std::string& srcUrl,
+                                                                           const std::string& storagePath,
+                                                                           const std::string& identifier,
+                                                                           DownloadTask::ChecksumType checksumType,
+                                                                           const std::string& checksum)
     {
         DownloadTask *task_ = new (std::nothrow) DownloadTask();
         std::shared_ptr<const DownloadTask> task(task_);
@@ -157,6 +303,8 @@ namespace cocos2d { namespace network {
             task_->requestURL    = srcUrl;
             task_->storagePath   = storagePath;
             task_->identifier    = identifier;
+            task_->checksumType  = checksumType;
+            task_->checksum      = checksum;
             if (0 == srcUrl.length() || 0 == storagePath.length())
             {
                 if (onTaskError)
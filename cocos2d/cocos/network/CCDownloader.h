@@ -45,11 +45,23 @@ namespace cocos2d { namespace network {
         const static int ERROR_INVALID_PARAMS = -1;
         const static int ERROR_FILE_OP_FAILED = -2;
         const static int ERROR_IMPL_INTERNAL = -3;
+        const static int ERROR_CHECKSUM_MISMATCH = -4;
+
+        enum class ChecksumType
+        {
+            NONE,
+            MD5,        // 32 hex digits
+            XXH32,      // 8 hex digits, seed 0
+        };
 
         std::string identifier;
         std::string requestURL;
         std::string storagePath;
 
+        // expected digest of a file task, verified before the file is renamed to storagePath
+        ChecksumType checksumType;
+        std::string checksum;
+
         DownloadTask();
         virtual ~DownloadTask();
 
@@ -64,6 +76,12 @@ namespace cocos2d { namespace network {
         uint32_t countOfMaxProcessingTasks;
         uint32_t timeoutInSeconds;
         std::string tempFileNameSuffix;
+
+        // with libcurl, files of at least 2 * minSizeOfChunk bytes are fetched as up to countOfChunksPerFileTask
+        // parallel byte ranges, whose progress is saved next to the temp file to resume after the app was killed;
+        // 0 or 1 chunk disables it, 0 bytes means 1 MB
+        uint32_t countOfChunksPerFileTask;
+        uint32_t minSizeOfChunk;
     };
 
     class CC_DLL Downloader final
@@ -104,6 +122,13 @@ namespace cocos2d { namespace network {
 
         std::shared_ptr<const DownloadTask> createDownloadFileTask(const std::string& srcUrl, const std::string& storagePath, const std::string& identifier = "");
 
+        // the file fails with ERROR_CHECKSUM_MISMATCH and is removed if its digest is not checksum (hex, case insensitive)
+        std::shared_ptr<const DownloadTask> createDownloadFileTask(const std::string& srcUrl,
+                                                                   const std::string& storagePath,
+                                                                   const std::string& identifier,
+                                                                   DownloadTask::ChecksumType checksumType,
+                                                                   const std::string& checksum);
+
     private:
         std::unique_ptr<IDownloaderImpl> _impl;
     };
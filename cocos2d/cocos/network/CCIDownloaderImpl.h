@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include <memory>
 
 #include "base/CCConsole.h"
+#include "network/CCDownloader.h"
 
 //#define CC_DOWNLOADER_DEBUG
 #ifdef  CC_DOWNLOADER_DEBUG
@@ -40,7 +41,27 @@ THE SOFTWARE.
 
 namespace cocos2d { namespace network
 {
-    class DownloadTask;
+    // Incremental digest of downloaded data, see DownloadTask::checksum
+    class CC_DLL DownloadChecksum
+    {
+    public:
+        DownloadChecksum();
+        ~DownloadChecksum();
+
+        void reset(DownloadTask::ChecksumType type);
+        void update(const void *data, size_t size);
+
+        // finish the digest and compare it with the expected hex string, returns true if there is no checksum
+        bool verify(const std::string& expected);
+
+        static bool verifyFile(const std::string& path, DownloadTask::ChecksumType type, const std::string& expected);
+
+    private:
+        CC_DISALLOW_COPY_AND_ASSIGN(DownloadChecksum);
+
+        struct State;
+        State *_state;
+    };
 
     class CC_DLL IDownloadTask
     {
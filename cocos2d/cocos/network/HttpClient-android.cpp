@@ -882,6 +882,7 @@ HttpClient::HttpClient()
 : _isInited(false)
 , _timeoutForConnect(30)
 , _timeoutForRead(60)
+, _maxConcurrentRequests(1)
 , _threadCount(0)
 , _cookie(nullptr)
 , _requestSentinel(new HttpRequest())
@@ -1039,6 +1040,19 @@ int HttpClient::getTimeoutForRead()
     return _timeoutForRead;
 }
     
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    // requests are transferred one after the other on this platform
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    _maxConcurrentRequests = value;
+}
+    
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    return _maxConcurrentRequests;
+}
+    
 const std::string& HttpClient::getCookieFilename()
 {
     std::lock_guard<std::mutex> lock(_cookieFileMutex);
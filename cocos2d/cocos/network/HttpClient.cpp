@@ -27,6 +27,7 @@
 
 #include "network/HttpClient.h"
 #include <queue>
+#include <unordered_map>
 #include <errno.h>
 #include <curl/curl.h>
 #include "base/CCDirector.h"
@@ -40,6 +41,9 @@ namespace network {
 typedef int int32_t;
 #endif
 
+// upper bound of the delay before a request queued during transfers is started
+#define CC_HTTP_POLL_TIMEOUT_MS 20
+
 static HttpClient* _httpClient = nullptr; // pointer to singleton
 
 typedef size_t (*write_callback)(void *ptr, size_t size, size_t nmemb, void *stream);
@@ -70,102 +74,29 @@ static size_t writeHeaderData(void *ptr, size_t size, size_t nmemb, void *stream
     return sizes;
 }
 
-
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processPutTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-static int processDeleteTask(HttpClient* client,  HttpRequest* request, write_callback callback, void *stream, long *errorCode, write_callback headerCallback, void *headerStream, char* errorBuffer);
-// int processDownloadTask(HttpRequest *task, write_callback callback, void *stream, int32_t *errorCode);
-
-// Worker thread
-void HttpClient::networkThread()
+// A request being transferred by the multi handle of the network thread
+struct HttpTransfer
 {
-    increaseThreadCount();
-
-    while (true)
-    {
-        HttpRequest *request;
-
-        // step 1: send http request if the requestQueue isn't empty
-        {
-            std::lock_guard<std::mutex> lock(_requestQueueMutex);
-            while (_requestQueue.empty())
-            {
-                _sleepCondition.wait(_requestQueueMutex);
-            }
-            request = _requestQueue.at(0);
-            _requestQueue.erase(0);
-        }
-
-        if (request == _requestSentinel) {
-            break;
-        }
-
-        // step 2: libcurl sync access
-        
-        // Create a HttpResponse object, the default setting is http access failed
-        HttpResponse *response = new (std::nothrow) HttpResponse(request);
-
-        processResponse(response, _responseMessage);
-
-
-        // add response packet into queue
-        _responseQueueMutex.lock();
-        _responseQueue.pushBack(response);
-        _responseQueueMutex.unlock();
-
-        _schedulerMutex.lock();
-        if (nullptr != _scheduler)
-        {
-            _scheduler->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
-        }
-        _schedulerMutex.unlock();
-    }
-    
-    // cleanup: if worker thread received quit signal, clean up un-completed request queue
-    _requestQueueMutex.lock();
-    _requestQueue.clear();
-    _requestQueueMutex.unlock();
-
-    _responseQueueMutex.lock();
-    _responseQueue.clear();
-    _responseQueueMutex.unlock();
+    HttpResponse* response;
+    curl_slist* headers;    // custom header data, must outlive the transfer
+    bool immediate;         // sent with sendImmediate(), not counted against the concurrency limit
+    char errorBuffer[CURL_ERROR_SIZE];
+};
 
-    decreaseThreadCountAndMayDeleteThis();
+static bool isHttp2Supported()
+{
+#ifdef CURL_VERSION_HTTP2
+    static const bool supported = (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2) != 0;
+    return supported;
+#else
+    return false;
+#endif
 }
 
-// Worker thread
-void HttpClient::networkThreadAlone(HttpRequest* request, HttpResponse* response)
+template <class T>
+static bool setOption(CURL* handle, CURLoption option, T data)
 {
-    increaseThreadCount();
-
-    char responseMessage[RESPONSE_BUFFER_SIZE] = { 0 };
-    processResponse(response, responseMessage);
-
-    _schedulerMutex.lock();
-    if (nullptr != _scheduler)
-    {
-        _scheduler->performFunctionInCocosThread([this, response, request]{
-            const ccHttpRequestCallback& callback = request->getCallback();
-            Ref* pTarget = request->getTarget();
-            SEL_HttpResponse pSelector = request->getSelector();
-
-            if (callback != nullptr)
-            {
-                callback(this, response);
-            }
-            else if (pTarget && pSelector)
-            {
-                (pTarget->*pSelector)(this, response);
-            }
-            response->release();
-            // do not release in other thread
-            request->release();
-        });
-    }
-    _schedulerMutex.unlock();
-
-    decreaseThreadCountAndMayDeleteThis();
+    return CURLE_OK == curl_easy_setopt(handle, option, data);
 }
 
 //Configure curl's timeout property
@@ -180,11 +111,11 @@ static bool configureCURL(HttpClient* client, CURL* handle, char* errorBuffer)
     if (code != CURLE_OK) {
         return false;
     }
-    code = curl_easy_setopt(handle, CURLOPT_TIMEOUT, HttpClient::getInstance()->getTimeoutForRead());
+    code = curl_easy_setopt(handle, CURLOPT_TIMEOUT, client->getTimeoutForRead());
     if (code != CURLE_OK) {
         return false;
     }
-    code = curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, HttpClient::getInstance()->getTimeoutForConnect());
+    code = curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, client->getTimeoutForConnect());
     if (code != CURLE_OK) {
         return false;
     }
@@ -205,138 +136,383 @@ static bool configureCURL(HttpClient* client, CURL* handle, char* errorBuffer)
 
     curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
 
+    // connections stay in the connection cache of the multi handle, keep them alive for the next requests
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+
+#if LIBCURL_VERSION_NUM >= 0x072f00
+    // multiplex the requests to a host over one HTTP/2 connection instead of opening new connections
+    if (isHttp2Supported()) {
+        curl_easy_setopt(handle, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+    }
+#endif
+
     return true;
 }
 
-class CURLRaii
+/**
+ * @brief Inits a pooled CURL handle for a request
+ * @param transfer Null not allowed, keeps the header list and the error buffer of the transfer
+ * @param share Null not allowed, holds the cookies of every handle
+ * @param cookieFilename The cookie file, empty if cookies are disabled
+ */
+static bool initCurlHandle(HttpClient* client, CURL* handle, HttpTransfer* transfer, CURLSH* share,
+                           const std::string& cookieFilename)
 {
-    /// Instance of CURL
-    CURL *_curl;
-    /// Keeps custom header data
-    curl_slist *_headers;
-public:
-    CURLRaii()
-        : _curl(curl_easy_init())
-        , _headers(nullptr)
+    HttpResponse* response = transfer->response;
+    HttpRequest* request = response->getHttpRequest();
+
+    if (!configureCURL(client, handle, transfer->errorBuffer))
+        return false;
+
+    /* get custom header data (if set) */
+    std::vector<std::string> headers=request->getHeaders();
+    if(!headers.empty())
     {
+        /* append custom headers one by one */
+        for (auto& header : headers)
+            transfer->headers = curl_slist_append(transfer->headers, header.c_str());
+        /* set custom headers for curl */
+        if (!setOption(handle, CURLOPT_HTTPHEADER, transfer->headers))
+            return false;
+    }
+    if (!setOption(handle, CURLOPT_SHARE, share))
+        return false;
+    if (!cookieFilename.empty()) {
+        if (!setOption(handle, CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
+            return false;
+        }
     }
 
-    ~CURLRaii()
+    bool ok = setOption(handle, CURLOPT_URL, request->getUrl())
+            && setOption(handle, CURLOPT_WRITEFUNCTION, (write_callback)writeData)
+            && setOption(handle, CURLOPT_WRITEDATA, (void*)response->getResponseData())
+            && setOption(handle, CURLOPT_HEADERFUNCTION, (write_callback)writeHeaderData)
+            && setOption(handle, CURLOPT_HEADERDATA, (void*)response->getResponseHeader())
+            && setOption(handle, CURLOPT_PRIVATE, (void*)transfer);
+    if (!ok)
+        return false;
+
+    switch (request->getRequestType())
     {
-        if (_curl)
-            curl_easy_cleanup(_curl);
-        /* free the linked list for header data */
-        if (_headers)
-            curl_slist_free_all(_headers);
+    case HttpRequest::Type::GET: // HTTP GET
+        return setOption(handle, CURLOPT_FOLLOWLOCATION, 1L);
+
+    case HttpRequest::Type::POST: // HTTP POST
+        return setOption(handle, CURLOPT_POST, 1L)
+                && setOption(handle, CURLOPT_POSTFIELDS, request->getRequestData())
+                && setOption(handle, CURLOPT_POSTFIELDSIZE, (long)request->getRequestDataSize());
+
+    case HttpRequest::Type::PUT:
+        return setOption(handle, CURLOPT_CUSTOMREQUEST, "PUT")
+                && setOption(handle, CURLOPT_POSTFIELDS, request->getRequestData())
+                && setOption(handle, CURLOPT_POSTFIELDSIZE, (long)request->getRequestDataSize());
+
+    case HttpRequest::Type::DELETE:
+        return setOption(handle, CURLOPT_CUSTOMREQUEST, "DELETE")
+                && setOption(handle, CURLOPT_FOLLOWLOCATION, 1L);
+
+    default:
+        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT or DELETE is supported");
+        return false;
     }
+}
+
+/**
+ * @brief Replaces the shared cookies with the cookies of a file
+ * @note A throwaway handle reads the file, a pooled one would keep the file list after curl_easy_reset
+ */
+static void loadCookieFile(CURLSH* share, const std::string& cookieFilename)
+{
+    CURL* handle = curl_easy_init();
+    if (!handle)
+        return;
 
-    template <class T>
-    bool setOption(CURLoption option, T data)
+    bool ok = setOption(handle, CURLOPT_SHARE, share)
+            && setOption(handle, CURLOPT_COOKIELIST, "ALL")
+            && setOption(handle, CURLOPT_COOKIEFILE, cookieFilename.c_str())
+            && setOption(handle, CURLOPT_COOKIELIST, "RELOAD");
+    if (!ok)
     {
-        return CURLE_OK == curl_easy_setopt(_curl, option, data);
+        CCLOGERROR("HttpClient: failed to load cookie file %s", cookieFilename.c_str());
     }
+    curl_easy_cleanup(handle);
+}
+
+// Worker thread
+void HttpClient::networkThread()
+{
+    increaseThreadCount();
+
+    // the easy handles added to the multi handle share its connection cache, so requests to the
+    // same host reuse the kept-alive connections, or a single multiplexed one over HTTP/2
+    CURLM* multiHandle = curl_multi_init();
+#ifdef CURLPIPE_MULTIPLEX
+    curl_multi_setopt(multiHandle, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+
+    // one cookie store for all the handles, otherwise every pooled handle would keep its own cookies
+    // and the last one writing the cookie jar would drop the cookies received by the others
+    CURLSH* shareHandle = curl_share_init();
+    curl_share_setopt(shareHandle, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+    std::string loadedCookieFilename;
 
-    /**
-     * @brief Inits CURL instance for common usage
-     * @param request Null not allowed
-     * @param callback Response write callback
-     * @param stream Response write stream
-     */
-    bool init(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, write_callback headerCallback, void* headerStream, char* errorBuffer)
+    std::unordered_map<CURL*, HttpTransfer*> transfers;
+    std::vector<CURL*> idleHandles;     // reset handles, reused to keep their SSL session cache
+    std::vector<std::pair<HttpRequest*, bool>> startingRequests;
+    int queuedTransferCount = 0;        // transfers limited by _maxConcurrentRequests
+    int runningHandles = 0;
+    bool quit = false;
+
+    while (!quit)
     {
-        if (!_curl)
-            return false;
-        if (!configureCURL(client, _curl, errorBuffer))
-            return false;
+        // step 1: take the requests to start, sleep if there is nothing to do
+        int maxConcurrentRequests = getMaxConcurrentRequests();
+        startingRequests.clear();
+        {
+            std::lock_guard<std::mutex> lock(_requestQueueMutex);
+            while (transfers.empty() && _requestQueue.empty() && _immediateRequestQueue.empty())
+            {
+                _sleepCondition.wait(_requestQueueMutex);
+            }
+
+            if (!_requestQueue.empty() && _requestQueue.back() == _requestSentinel)
+            {
+                quit = true;
+                break;
+            }
+
+            while (!_immediateRequestQueue.empty())
+            {
+                startingRequests.push_back(std::make_pair(_immediateRequestQueue.at(0), true));
+                _immediateRequestQueue.erase(0);
+            }
 
-        /* get custom header data (if set) */
-        std::vector<std::string> headers=request->getHeaders();
-        if(!headers.empty())
+            // the queue is sorted by priority
+            while (!_requestQueue.empty()
+                   && (maxConcurrentRequests <= 0 || queuedTransferCount < maxConcurrentRequests))
+            {
+                startingRequests.push_back(std::make_pair(_requestQueue.at(0), false));
+                _requestQueue.erase(0);
+                ++queuedTransferCount;
+            }
+        }
+
+        // step 2: add the new transfers to the multi handle
+        std::string cookieFilename = startingRequests.empty() ? loadedCookieFilename : getCookieFilename();
+        if (cookieFilename != loadedCookieFilename && shareHandle)
         {
-            /* append custom headers one by one */
-            for (auto& header : headers)
-                _headers = curl_slist_append(_headers,header.c_str());
-            /* set custom headers for curl */
-            if (!setOption(CURLOPT_HTTPHEADER, _headers))
-                return false;
+            loadCookieFile(shareHandle, cookieFilename);
+            loadedCookieFilename = cookieFilename;
         }
-        std::string cookieFilename = client->getCookieFilename();
-        if (!cookieFilename.empty()) {
-            if (!setOption(CURLOPT_COOKIEFILE, cookieFilename.c_str())) {
-                return false;
+        for (auto& starting : startingRequests)
+        {
+            // Create a HttpResponse object, the default setting is http access failed
+            HttpTransfer* transfer = new (std::nothrow) HttpTransfer();
+            transfer->response = new (std::nothrow) HttpResponse(starting.first);
+            transfer->headers = nullptr;
+            transfer->immediate = starting.second;
+            transfer->errorBuffer[0] = '\0';
+
+            CURL* handle = nullptr;
+            if (!idleHandles.empty())
+            {
+                handle = idleHandles.back();
+                idleHandles.pop_back();
+            }
+            else
+            {
+                handle = curl_easy_init();
+            }
+
+            CURLMcode mcode = CURLM_INTERNAL_ERROR;
+            if (handle && shareHandle && initCurlHandle(this, handle, transfer, shareHandle, cookieFilename))
+            {
+                mcode = curl_multi_add_handle(multiHandle, handle);
             }
-            if (!setOption(CURLOPT_COOKIEJAR, cookieFilename.c_str())) {
-                return false;
+
+            if (CURLM_OK == mcode)
+            {
+                transfers[handle] = transfer;
+                continue;
             }
+
+            CCLOGERROR("HttpClient: failed to start request %s", starting.first->getUrl());
+            if (handle)
+            {
+                curl_easy_cleanup(handle);
+            }
+            if (!transfer->immediate)
+            {
+                --queuedTransferCount;
+            }
+            transfer->response->setResponseCode(-1);
+            transfer->response->setSucceed(false);
+            transfer->response->setErrorBuffer(transfer->errorBuffer[0] ? transfer->errorBuffer : "Init curl handle failed.");
+            curl_slist_free_all(transfer->headers);
+            queueResponse(transfer->response);
+            delete transfer;
         }
 
-        return setOption(CURLOPT_URL, request->getUrl())
-                && setOption(CURLOPT_WRITEFUNCTION, callback)
-                && setOption(CURLOPT_WRITEDATA, stream)
-                && setOption(CURLOPT_HEADERFUNCTION, headerCallback)
-                && setOption(CURLOPT_HEADERDATA, headerStream);
-        
+        if (transfers.empty())
+        {
+            continue;
+        }
+
+        // step 3: transfer, then hand the finished responses to the cocos thread
+        CURLMcode mcode = CURLM_CALL_MULTI_PERFORM;
+        while (CURLM_CALL_MULTI_PERFORM == mcode)
+        {
+            mcode = curl_multi_perform(multiHandle, &runningHandles);
+        }
+        if (CURLM_OK != mcode)
+        {
+            CCLOGERROR("HttpClient: curl_multi_perform failed: %s", curl_multi_strerror(mcode));
+        }
+
+        struct CURLMsg *m;
+        do {
+            int msgq = 0;
+            m = curl_multi_info_read(multiHandle, &msgq);
+            if (m && (m->msg == CURLMSG_DONE))
+            {
+                CURL* handle = m->easy_handle;
+                CURLcode errCode = m->data.result;
+                HttpTransfer* transfer = transfers[handle];
+                HttpResponse* response = transfer->response;
+
+                long responseCode = -1;
+                bool succeed = false;
+                if (CURLE_OK == errCode)
+                {
+                    CURLcode code = curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &responseCode);
+                    succeed = code == CURLE_OK && responseCode >= 200 && responseCode < 300;
+                }
+                else if (!transfer->errorBuffer[0])
+                {
+                    strncpy(transfer->errorBuffer, curl_easy_strerror(errCode), CURL_ERROR_SIZE - 1);
+                    transfer->errorBuffer[CURL_ERROR_SIZE - 1] = '\0';
+                }
+
+                // write data to HttpResponse
+                response->setResponseCode(responseCode);
+                response->setSucceed(succeed);
+                if (!succeed)
+                {
+                    response->setErrorBuffer(transfer->errorBuffer);
+                }
+
+                curl_multi_remove_handle(multiHandle, handle);
+                if (!getCookieFilename().empty())
+                {
+                    // a reused handle only writes the cookie jar when asked to, the jar holds the shared cookies
+                    curl_easy_setopt(handle, CURLOPT_COOKIELIST, "FLUSH");
+                }
+                curl_easy_reset(handle);
+                idleHandles.push_back(handle);
+                curl_slist_free_all(transfer->headers);
+                transfers.erase(handle);
+                if (!transfer->immediate)
+                {
+                    --queuedTransferCount;
+                }
+                delete transfer;
+
+                queueResponse(response);
+            }
+        } while (m);
+
+        if (transfers.empty())
+        {
+            continue;
+        }
+
+        // step 4: wait for network activity, or for the next poll of the request queue
+        long timeoutMS = -1;
+        curl_multi_timeout(multiHandle, &timeoutMS);
+        if (timeoutMS < 0 || timeoutMS > CC_HTTP_POLL_TIMEOUT_MS)
+        {
+            timeoutMS = CC_HTTP_POLL_TIMEOUT_MS;
+        }
+
+        fd_set fdread;
+        fd_set fdwrite;
+        fd_set fdexcep;
+        int maxfd = -1;
+
+        FD_ZERO(&fdread);
+        FD_ZERO(&fdwrite);
+        FD_ZERO(&fdexcep);
+
+        curl_multi_fdset(multiHandle, &fdread, &fdwrite, &fdexcep, &maxfd);
+        if (maxfd == -1)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMS));
+        }
+        else
+        {
+            struct timeval timeout;
+            timeout.tv_sec = timeoutMS / 1000;
+            timeout.tv_usec = (timeoutMS % 1000) * 1000;
+            select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout);
+        }
     }
 
-    /// @param responseCode Null not allowed
-    bool perform(long *responseCode)
+    // cleanup: if worker thread received quit signal, abort the transfers and clean up un-completed request queue
+    for (auto& iter : transfers)
     {
-        if (CURLE_OK != curl_easy_perform(_curl))
-            return false;
-        CURLcode code = curl_easy_getinfo(_curl, CURLINFO_RESPONSE_CODE, responseCode);
-        if (code != CURLE_OK || !(*responseCode >= 200 && *responseCode < 300)) {
-            CCLOGERROR("Curl curl_easy_getinfo failed: %s", curl_easy_strerror(code));
-            return false;
+        curl_multi_remove_handle(multiHandle, iter.first);
+        curl_easy_cleanup(iter.first);
+        curl_slist_free_all(iter.second->headers);
+        HttpRequest* request = iter.second->response->getHttpRequest();
+        iter.second->response->release();
+        request->release();
+        delete iter.second;
+    }
+    for (auto handle : idleHandles)
+    {
+        curl_easy_cleanup(handle);
+    }
+    curl_multi_cleanup(multiHandle);
+    // the easy handles using it are cleaned up
+    curl_share_cleanup(shareHandle);
+
+    _requestQueueMutex.lock();
+    for (auto request : _requestQueue)
+    {
+        if (request != _requestSentinel)
+        {
+            request->release();
         }
-        // Get some mor data.
-        
-        return true;
     }
-};
+    for (auto request : _immediateRequestQueue)
+    {
+        request->release();
+    }
+    _requestQueue.clear();
+    _immediateRequestQueue.clear();
+    _requestQueueMutex.unlock();
 
-//Process Get Request
-static int processGetTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    _responseQueueMutex.lock();
+    _responseQueue.clear();
+    _responseQueueMutex.unlock();
 
-//Process POST Request
-static int processPostTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_POST, 1)
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    decreaseThreadCountAndMayDeleteThis();
 }
 
-//Process PUT Request
-static int processPutTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
+void HttpClient::queueResponse(HttpResponse* response)
 {
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "PUT")
-            && curl.setOption(CURLOPT_POSTFIELDS, request->getRequestData())
-            && curl.setOption(CURLOPT_POSTFIELDSIZE, request->getRequestDataSize())
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
-}
+    // add response packet into queue
+    _responseQueueMutex.lock();
+    _responseQueue.pushBack(response);
+    _responseQueueMutex.unlock();
 
-//Process DELETE Request
-static int processDeleteTask(HttpClient* client, HttpRequest* request, write_callback callback, void* stream, long* responseCode, write_callback headerCallback, void* headerStream, char* errorBuffer)
-{
-    CURLRaii curl;
-    bool ok = curl.init(client, request, callback, stream, headerCallback, headerStream, errorBuffer)
-            && curl.setOption(CURLOPT_CUSTOMREQUEST, "DELETE")
-            && curl.setOption(CURLOPT_FOLLOWLOCATION, true)
-            && curl.perform(responseCode);
-    return ok ? 0 : 1;
+    _schedulerMutex.lock();
+    if (nullptr != _scheduler)
+    {
+        _scheduler->performFunctionInCocosThread(CC_CALLBACK_0(HttpClient::dispatchResponseCallbacks, this));
+    }
+    _schedulerMutex.unlock();
 }
 
 // HttpClient implementation
@@ -349,7 +525,6 @@ HttpClient* HttpClient::getInstance()
     
     return _httpClient;
 }
-
 void HttpClient::destroyInstance()
 {
     if (nullptr == _httpClient)
@@ -400,6 +575,7 @@ HttpClient::HttpClient()
 : _isInited(false)
 , _timeoutForConnect(30)
 , _timeoutForRead(60)
+, _maxConcurrentRequests(6)
 , _threadCount(0)
 , _cookie(nullptr)
 , _requestSentinel(new HttpRequest())
@@ -449,7 +625,13 @@ void HttpClient::send(HttpRequest* request)
     request->retain();
 
     _requestQueueMutex.lock();
-    _requestQueue.pushBack(request);
+    // keep the queue sorted by priority, first come first served within a priority
+    ssize_t index = _requestQueue.size();
+    while (index > 0 && _requestQueue.at(index - 1)->getPriority() < request->getPriority())
+    {
+        --index;
+    }
+    _requestQueue.insert(index, request);
     _requestQueueMutex.unlock();
 
     // Notify thread start to work
@@ -458,17 +640,24 @@ void HttpClient::send(HttpRequest* request)
 
 void HttpClient::sendImmediate(HttpRequest* request)
 {
+    if (false == lazyInitThreadSemaphore())
+    {
+        return;
+    }
+
     if(!request)
     {
         return;
     }
 
     request->retain();
-    // Create a HttpResponse object, the default setting is http access failed
-    HttpResponse *response = new (std::nothrow) HttpResponse(request);
 
-    auto t = std::thread(&HttpClient::networkThreadAlone, this, request, response);
-    t.detach();
+    // started on the next turn of the network thread, regardless of the concurrency limit
+    _requestQueueMutex.lock();
+    _immediateRequestQueue.pushBack(request);
+    _requestQueueMutex.unlock();
+
+    _sleepCondition.notify_one();
 }
 
 // Poll and notify main thread if responses exists in queue
@@ -508,74 +697,6 @@ void HttpClient::dispatchResponseCallbacks()
     }
 }
 
-// Process Response
-void HttpClient::processResponse(HttpResponse* response, char* responseMessage)
-{
-    auto request = response->getHttpRequest();
-    long responseCode = -1;
-    int retValue = 0;
-
-    // Process the request -> get response packet
-    switch (request->getRequestType())
-    {
-    case HttpRequest::Type::GET: // HTTP GET
-        retValue = processGetTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::POST: // HTTP POST
-        retValue = processPostTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::PUT:
-        retValue = processPutTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    case HttpRequest::Type::DELETE:
-        retValue = processDeleteTask(this, request,
-            writeData,
-            response->getResponseData(),
-            &responseCode,
-            writeHeaderData,
-            response->getResponseHeader(),
-            responseMessage);
-        break;
-
-    default:
-        CCASSERT(false, "CCHttpClient: unknown request type, only GET, POST, PUT or DELETE is supported");
-        break;
-    }
-
-    // write data to HttpResponse
-    response->setResponseCode(responseCode);
-    if (retValue != 0)
-    {
-        response->setSucceed(false);
-        response->setErrorBuffer(responseMessage);
-    }
-    else
-    {
-        response->setSucceed(true);
-    }
-}
-
 void HttpClient::increaseThreadCount()
 {
     _threadCountMutex.lock();
@@ -623,6 +744,18 @@ int HttpClient::getTimeoutForRead()
     std::lock_guard<std::mutex> lock(_timeoutForReadMutex);
     return _timeoutForRead;
 }
+
+void HttpClient::setMaxConcurrentRequests(int value)
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    _maxConcurrentRequests = value;
+}
+
+int HttpClient::getMaxConcurrentRequests()
+{
+    std::lock_guard<std::mutex> lock(_maxConcurrentRequestsMutex);
+    return _maxConcurrentRequests;
+}
     
 const std::string& HttpClient::getCookieFilename()
 {
@@ -51,6 +51,9 @@ namespace network {
  *
  * Once the request completed, a callback will issued in main thread when it provided during make request.
  *
+ * With libcurl, the requests are transferred concurrently by a single network thread. Requests to the same
+ * host reuse pooled keep-alive connections, multiplexed over HTTP/2 when libcurl and the server support it.
+ *
  * @lua NA
  */
 class CC_DLL HttpClient
@@ -110,7 +113,7 @@ public:
     void send(HttpRequest* request);
 
     /**
-     * Immediate send a request
+     * Immediate send a request, bypassing the request queue and the concurrency limit.
      *
      * @param request a HttpRequest object, which includes url, response callback etc.
                       please make sure request->_requestData is clear before calling "sendImmediate" here.
@@ -145,6 +148,23 @@ public:
      */
     int getTimeoutForRead();
 
+    /**
+     * Set the maximum number of queued requests transferred at the same time.
+     *
+     * Queued requests wait for a free slot in order of priority. 1 transfers them one after the other,
+     * 0 or less removes the limit. Only the libcurl implementation honours it, where the default is 6.
+     *
+     * @param value the maximum number of concurrent requests.
+     */
+    void setMaxConcurrentRequests(int value);
+
+    /**
+     * Get the maximum number of queued requests transferred at the same time.
+     *
+     * @return int the maximum number of concurrent requests.
+     */
+    int getMaxConcurrentRequests();
+
     HttpCookie* getCookie() const {return _cookie; }
 
     std::mutex& getCookieFileMutex() {return _cookieFileMutex;}
@@ -166,6 +186,7 @@ private:
     void dispatchResponseCallbacks();
 
     void processResponse(HttpResponse* response, char* responseMessage);
+    void queueResponse(HttpResponse* response);
     void increaseThreadCount();
     void decreaseThreadCountAndMayDeleteThis();
 
@@ -178,6 +199,9 @@ private:
     int _timeoutForRead;
     std::mutex _timeoutForReadMutex;
 
+    int _maxConcurrentRequests;
+    std::mutex _maxConcurrentRequestsMutex;
+
     int  _threadCount;
     std::mutex _threadCountMutex;
 
@@ -185,6 +209,7 @@ private:
     std::mutex _schedulerMutex;
 
     Vector<HttpRequest*>  _requestQueue;
+    Vector<HttpRequest*>  _immediateRequestQueue;
     std::mutex _requestQueueMutex;
 
     Vector<HttpResponse*> _responseQueue;
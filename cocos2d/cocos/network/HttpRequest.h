@@ -90,6 +90,7 @@ public:
         , _pSelector(nullptr)
         , _pCallback(nullptr)
         , _pUserData(nullptr)
+        , _priority(0)
     {
     }
 
@@ -319,6 +320,26 @@ public:
         return _pCallback;
     }
 
+    /**
+     * Set the priority of the request. HttpClient::send() starts the queued requests with a higher priority first.
+     *
+     * @param priority the priority, default is 0.
+     */
+    void setPriority(int priority)
+    {
+        _priority = priority;
+    }
+
+    /**
+     * Get the priority of the request.
+     *
+     * @return int the priority.
+     */
+    int getPriority() const
+    {
+        return _priority;
+    }
+
     /**
      * Set custom-defined headers.
      *
@@ -366,6 +387,7 @@ protected:
     ccHttpRequestCallback       _pCallback;      /// C++11 style callbacks
     void*                       _pUserData;      /// You can add your customed data here
     std::vector<std::string>    _headers;        /// custom http headers
+    int                         _priority;       /// higher priority requests leave the queue of HttpClient first
 };
 
 }
@@ -895,13 +895,19 @@ void PhysicsBody::beforeSimulation(const Mat4& parentToWorldTransform, const Mat
         setRotation(rotation);
     }
 
-    // set position
+    // set position, unless it only differs by the rounding of the node round trip:
+    // moving a body wakes it up, so resting bodies could never fall asleep
     auto worldPosition = _ownerCenterOffset;
     nodeToWorldTransform.transformVector(worldPosition.x, worldPosition.y, worldPosition.z, 1.f, &worldPosition);
-    setPosition(worldPosition.x, worldPosition.y);
+    auto position = getPosition();
+    if (!position.fuzzyEquals(Vec2(worldPosition.x, worldPosition.y), 0.001f))
+    {
+        setPosition(worldPosition.x, worldPosition.y);
+        position.set(worldPosition.x, worldPosition.y);
+    }
 
-    _recordPosX = worldPosition.x;
-    _recordPosY = worldPosition.y;
+    _recordPosX = position.x;
+    _recordPosY = position.y;
 
     if (_owner->getAnchorPoint() != Vec2::ANCHOR_MIDDLE)
     {
@@ -103,6 +103,13 @@ void PhysicsContact::generateContactData()
     _contactData->normal = _contactData->count > 0 ? PhysicsHelper::cpv2point(cpArbiterGetNormal(arb)) : Vec2::ZERO;
 }
 
+void PhysicsContact::setContactData(const PhysicsContactData& data)
+{
+    CC_SAFE_DELETE(_preContactData);
+    _preContactData = _contactData;
+    _contactData = new (std::nothrow) PhysicsContactData(data);
+}
+
 // PhysicsContactPreSolve implementation
 PhysicsContactPreSolve::PhysicsContactPreSolve(void* contactInfo)
 : _contactInfo(contactInfo)
@@ -121,6 +121,7 @@ private:
     bool resetResult() { bool ret = _result; _result = true; return ret; }
     
     void generateContactData();
+    void setContactData(const PhysicsContactData& data);
 
 private:
     PhysicsContact();
@@ -144,6 +145,25 @@ private:
     friend class PhysicsWorld;
 };
 
+/**
+ * @brief A contact event recorded while the world was stepping with contact buffering enabled.
+ *
+ * @see PhysicsWorld::setContactBufferingEnabled
+ */
+struct CC_DLL PhysicsContactRecord
+{
+    /** The contact the event belongs to. It is only valid until the next step. */
+    PhysicsContact* contact;
+    PhysicsShape* shapeA;
+    PhysicsShape* shapeB;
+    /** BEGIN, POSTSOLVE or SEPARATE. */
+    PhysicsContact::EventCode eventCode;
+    /** Contact points and normal at the time of the event. */
+    PhysicsContactData data;
+    /** Total impulse applied by the solver, only set for POSTSOLVE. */
+    Vec2 impulse;
+};
+
 /**
  * @brief Presolve value generated when onContactPreSolve called.
  */
@@ -0,0 +1,656 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "physics/CCPhysicsTMXLayerBaker.h"
+#if CC_USE_PHYSICS
+
+#include <algorithm>
+#include <climits>
+
+#include "xxhash.h"
+
+#include "2d/CCTMXLayer.h"
+#include "2d/CCTMXTiledMap.h"
+#include "physics/CCPhysicsBody.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+namespace
+{
+    const char TMX_BAKE_FILE_MAGIC[4] = { 'C', 'C', 'T', 'B' };
+    const uint32_t TMX_BAKE_FILE_VERSION = 1;
+
+    struct TMXBakeFileHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t mode;
+        int32_t rangeX;
+        int32_t rangeY;
+        int32_t rangeWidth;
+        int32_t rangeHeight;
+        int32_t chunkSize;
+        float tileWidth;
+        float tileHeight;
+        uint32_t solidHash;
+    };
+}
+
+PhysicsTMXLayerBaker* PhysicsTMXLayerBaker::create(TMXLayer* layer, Mode mode/* = Mode::SEGMENTS*/, const Rect& tileRange/* = Rect::ZERO*/)
+{
+    PhysicsTMXLayerBaker* baker = new (std::nothrow) PhysicsTMXLayerBaker();
+    if (baker && baker->init(layer, mode, tileRange))
+    {
+        baker->autorelease();
+        return baker;
+    }
+
+    CC_SAFE_DELETE(baker);
+    return nullptr;
+}
+
+PhysicsTMXLayerBaker::PhysicsTMXLayerBaker()
+: _layer(nullptr)
+, _mode(Mode::SEGMENTS)
+, _edgeBorder(1.0f)
+, _categoryBitmask(UINT_MAX)
+, _collisionBitmask(UINT_MAX)
+, _contactTestBitmask(0)
+, _group(0)
+, _rangeX(0)
+, _rangeY(0)
+, _rangeWidth(0)
+, _rangeHeight(0)
+, _chunkSize(32)
+, _chunksX(0)
+, _chunksY(0)
+, _layerHeight(0.0f)
+, _baked(false)
+, _hasDirtyChunks(false)
+{
+}
+
+PhysicsTMXLayerBaker::~PhysicsTMXLayerBaker()
+{
+    if (_layer)
+    {
+        // another baker may have replaced the callback since
+        auto forwarder = _layer->getTileChangedCallback().target<TileChangedForwarder>();
+        if (forwarder && forwarder->baker == this)
+        {
+            _layer->setTileChangedCallback(nullptr);
+        }
+        _layer->release();
+    }
+}
+
+bool PhysicsTMXLayerBaker::init(TMXLayer* layer, Mode mode, const Rect& tileRange)
+{
+    CCASSERT(layer != nullptr, "layer can not be nullptr");
+    CCASSERT(layer->getTiles() != nullptr, "the tile map of the layer has been released");
+
+    if (!Node::init())
+    {
+        return false;
+    }
+
+    if (layer->getLayerOrientation() != TMXOrientationOrtho)
+    {
+        CCLOG("PhysicsTMXLayerBaker: only orthogonal layers are supported");
+        return false;
+    }
+
+    _layer = layer;
+    _layer->retain();
+    _mode = mode;
+    _material = PHYSICSSHAPE_MATERIAL_DEFAULT;
+
+    const Size& layerSize = layer->getLayerSize();
+    Rect range = tileRange.equals(Rect::ZERO) ? Rect(0, 0, layerSize.width, layerSize.height) : tileRange;
+    _rangeX = std::max(0, (int)range.origin.x);
+    _rangeY = std::max(0, (int)range.origin.y);
+    _rangeWidth = std::min((int)layerSize.width, (int)(range.origin.x + range.size.width)) - _rangeX;
+    _rangeHeight = std::min((int)layerSize.height, (int)(range.origin.y + range.size.height)) - _rangeY;
+    if (_rangeWidth <= 0 || _rangeHeight <= 0)
+    {
+        CCLOG("PhysicsTMXLayerBaker: the tile range is outside of the layer");
+        return false;
+    }
+
+    // layer positions are computed in pixels and converted to points, see TMXLayer::getPositionAt()
+    _tileSize = CC_SIZE_PIXELS_TO_POINTS(layer->getMapTileSize());
+    _layerHeight = layerSize.height;
+
+    auto body = PhysicsBody::create();
+    body->setDynamic(false);
+    setPhysicsBody(body);
+
+    TileChangedForwarder forwarder = { this };
+    _layer->setTileChangedCallback(forwarder);
+
+    return true;
+}
+
+void PhysicsTMXLayerBaker::setSolidTileFilter(const std::function<bool(uint32_t gid)>& filter)
+{
+    _solidTileFilter = filter;
+    _baked = false;
+}
+
+void PhysicsTMXLayerBaker::setCategoryBitmask(int bitmask)
+{
+    _categoryBitmask = bitmask;
+    getPhysicsBody()->setCategoryBitmask(bitmask);
+}
+
+void PhysicsTMXLayerBaker::setCollisionBitmask(int bitmask)
+{
+    _collisionBitmask = bitmask;
+    getPhysicsBody()->setCollisionBitmask(bitmask);
+}
+
+void PhysicsTMXLayerBaker::setContactTestBitmask(int bitmask)
+{
+    _contactTestBitmask = bitmask;
+    getPhysicsBody()->setContactTestBitmask(bitmask);
+}
+
+void PhysicsTMXLayerBaker::setGroup(int group)
+{
+    _group = group;
+    getPhysicsBody()->setGroup(group);
+}
+
+void PhysicsTMXLayerBaker::setChunkSize(int tiles)
+{
+    CCASSERT(!_baked, "the chunk size must be set before baking");
+    if (tiles > 0)
+    {
+        _chunkSize = tiles;
+    }
+}
+
+int PhysicsTMXLayerBaker::getShapeCount() const
+{
+    int count = 0;
+    for (auto& chunk : _chunks)
+    {
+        count += (int)chunk.shapes.size();
+    }
+    return count;
+}
+
+void PhysicsTMXLayerBaker::onEnter()
+{
+    Node::onEnter();
+
+    if (!_baked)
+    {
+        bake();
+    }
+    else
+    {
+        syncWithLayer();
+        if (_hasDirtyChunks)
+        {
+            scheduleUpdate();
+        }
+    }
+}
+
+void PhysicsTMXLayerBaker::update(float /*delta*/)
+{
+    unscheduleUpdate();
+    rebakeDirtyChunks();
+}
+
+void PhysicsTMXLayerBaker::syncWithLayer()
+{
+    setPosition(_layer->getPosition());
+    setScaleX(_layer->getScaleX());
+    setScaleY(_layer->getScaleY());
+    setRotation(_layer->getRotation());
+}
+
+bool PhysicsTMXLayerBaker::readSolid(int x, int y) const
+{
+    uint32_t gid = _layer->getTiles()[(_rangeX + x) + (_rangeY + y) * (int)_layer->getLayerSize().width] & kTMXFlippedMask;
+    if (gid == 0)
+    {
+        return false;
+    }
+    return _solidTileFilter ? _solidTileFilter(gid) : true;
+}
+
+void PhysicsTMXLayerBaker::updateSolidTiles()
+{
+    CCASSERT(_layer->getTiles() != nullptr, "the tile map of the layer has been released");
+
+    _solid.resize(_rangeWidth * _rangeHeight);
+    for (int y = 0; y < _rangeHeight; ++y)
+    {
+        for (int x = 0; x < _rangeWidth; ++x)
+        {
+            _solid[y * _rangeWidth + x] = readSolid(x, y) ? 1 : 0;
+        }
+    }
+}
+
+uint32_t PhysicsTMXLayerBaker::getSolidTilesHash() const
+{
+    return XXH32(_solid.data(), _solid.size(), 0);
+}
+
+void PhysicsTMXLayerBaker::bake()
+{
+    syncWithLayer();
+    updateSolidTiles();
+
+    // drop the shapes of a previous bake
+    for (int i = 0; i < (int)_chunks.size(); ++i)
+    {
+        _chunks[i].primitives.clear();
+        rebuildShapes(i);
+    }
+
+    _chunksX = (_rangeWidth + _chunkSize - 1) / _chunkSize;
+    _chunksY = (_rangeHeight + _chunkSize - 1) / _chunkSize;
+    _chunks.clear();
+    _chunks.resize(_chunksX * _chunksY);
+    _hasDirtyChunks = false;
+    _baked = true;
+
+    bool loaded = !_cacheFile.empty() && loadCache();
+    for (int i = 0; i < (int)_chunks.size(); ++i)
+    {
+        if (!loaded)
+        {
+            bakeChunk(i);
+        }
+        _chunks[i].dirty = false;
+        rebuildShapes(i);
+    }
+
+    if (!loaded && !_cacheFile.empty())
+    {
+        saveCache();
+    }
+}
+
+void PhysicsTMXLayerBaker::markTileDirty(const Vec2& tileCoordinate)
+{
+    if (!_baked)
+    {
+        return;
+    }
+
+    int x = (int)tileCoordinate.x - _rangeX;
+    int y = (int)tileCoordinate.y - _rangeY;
+    if (x < 0 || y < 0 || x >= _rangeWidth || y >= _rangeHeight)
+    {
+        return;
+    }
+
+    unsigned char solid = readSolid(x, y) ? 1 : 0;
+    if (_solid[y * _rangeWidth + x] == solid)
+    {
+        return;
+    }
+    _solid[y * _rangeWidth + x] = solid;
+
+    markChunkDirty(x, y);
+    if (_mode == Mode::SEGMENTS)
+    {
+        // the right and bottom edges of the tile belong to the next chunks when it sits on a chunk border
+        markChunkDirty(x + 1, y);
+        markChunkDirty(x, y + 1);
+    }
+
+    if (!_hasDirtyChunks)
+    {
+        _hasDirtyChunks = true;
+        if (_running)
+        {
+            scheduleUpdate();
+        }
+    }
+}
+
+void PhysicsTMXLayerBaker::markChunkDirty(int x, int y)
+{
+    if (x < _rangeWidth && y < _rangeHeight)
+    {
+        _chunks[(y / _chunkSize) * _chunksX + x / _chunkSize].dirty = true;
+    }
+}
+
+void PhysicsTMXLayerBaker::rebakeDirtyChunks()
+{
+    for (int i = 0; i < (int)_chunks.size(); ++i)
+    {
+        if (_chunks[i].dirty)
+        {
+            bakeChunk(i);
+            _chunks[i].dirty = false;
+            rebuildShapes(i);
+        }
+    }
+    _hasDirtyChunks = false;
+}
+
+void PhysicsTMXLayerBaker::bakeChunk(int index)
+{
+    Chunk& chunk = _chunks[index];
+    chunk.primitives.clear();
+
+    int x0 = (index % _chunksX) * _chunkSize;
+    int y0 = (index / _chunksX) * _chunkSize;
+    int x1 = std::min(x0 + _chunkSize, _rangeWidth);
+    int y1 = std::min(y0 + _chunkSize, _rangeHeight);
+
+    if (_mode == Mode::SEGMENTS)
+    {
+        bakeSegments(chunk, x0, y0, x1, y1);
+    }
+    else
+    {
+        bakeBoxes(chunk, x0, y0, x1, y1);
+    }
+}
+
+void PhysicsTMXLayerBaker::bakeSegments(Chunk& chunk, int x0, int y0, int x1, int y1)
+{
+    // a chunk owns the top edge of its rows and the left edge of its columns,
+    // plus the bottom and right border of the range when it touches them
+    int lastRow = y1 == _rangeHeight ? y1 : y1 - 1;
+    for (int line = y0; line <= lastRow; ++line)
+    {
+        float y = (_layerHeight - _rangeY - line) * _tileSize.height;
+        int start = -1;
+        for (int x = x0; x <= x1; ++x)
+        {
+            bool edge = x < x1 && isSolid(x, line - 1) != isSolid(x, line);
+            if (edge && start < 0)
+            {
+                start = x;
+            }
+            else if (!edge && start >= 0)
+            {
+                Primitive segment = { (_rangeX + start) * _tileSize.width, y, (_rangeX + x) * _tileSize.width, y };
+                chunk.primitives.push_back(segment);
+                start = -1;
+            }
+        }
+    }
+
+    int lastColumn = x1 == _rangeWidth ? x1 : x1 - 1;
+    for (int line = x0; line <= lastColumn; ++line)
+    {
+        float x = (_rangeX + line) * _tileSize.width;
+        int start = -1;
+        for (int y = y0; y <= y1; ++y)
+        {
+            bool edge = y < y1 && isSolid(line - 1, y) != isSolid(line, y);
+            if (edge && start < 0)
+            {
+                start = y;
+            }
+            else if (!edge && start >= 0)
+            {
+                Primitive segment = { x, (_layerHeight - _rangeY - start) * _tileSize.height, x, (_layerHeight - _rangeY - y) * _tileSize.height };
+                chunk.primitives.push_back(segment);
+                start = -1;
+            }
+        }
+    }
+}
+
+void PhysicsTMXLayerBaker::bakeBoxes(Chunk& chunk, int x0, int y0, int x1, int y1)
+{
+    int width = x1 - x0;
+    std::vector<unsigned char> used(width * (y1 - y0), 0);
+    auto isFree = [&](int x, int y) {
+        return isSolid(x, y) && used[(y - y0) * width + (x - x0)] == 0;
+    };
+
+    // greedy merge: grow each box right as far as possible, then down while the whole span is free
+    for (int y = y0; y < y1; ++y)
+    {
+        for (int x = x0; x < x1; ++x)
+        {
+            if (!isFree(x, y))
+            {
+                continue;
+            }
+
+            int right = x + 1;
+            while (right < x1 && isFree(right, y))
+            {
+                ++right;
+            }
+
+            int bottom = y + 1;
+            for (; bottom < y1; ++bottom)
+            {
+                bool free = true;
+                for (int i = x; i < right && free; ++i)
+                {
+                    free = isFree(i, bottom);
+                }
+                if (!free)
+                {
+                    break;
+                }
+            }
+
+            for (int j = y; j < bottom; ++j)
+            {
+                std::fill(used.begin() + (j - y0) * width + (x - x0), used.begin() + (j - y0) * width + (right - x0), 1);
+            }
+
+            Primitive box = {
+                (_rangeX + x) * _tileSize.width,
+                (_layerHeight - _rangeY - bottom) * _tileSize.height,
+                (_rangeX + right) * _tileSize.width,
+                (_layerHeight - _rangeY - y) * _tileSize.height
+            };
+            chunk.primitives.push_back(box);
+        }
+    }
+}
+
+void PhysicsTMXLayerBaker::rebuildShapes(int index)
+{
+    Chunk& chunk = _chunks[index];
+    auto body = getPhysicsBody();
+
+    for (auto shape : chunk.shapes)
+    {
+        body->removeShape(shape, false);
+    }
+    chunk.shapes.clear();
+
+    for (auto& primitive : chunk.primitives)
+    {
+        PhysicsShape* shape = nullptr;
+        if (_mode == Mode::SEGMENTS)
+        {
+            shape = PhysicsShapeEdgeSegment::create(Vec2(primitive.x1, primitive.y1), Vec2(primitive.x2, primitive.y2), _material, _edgeBorder);
+        }
+        else
+        {
+            Size size(primitive.x2 - primitive.x1, primitive.y2 - primitive.y1);
+            Vec2 center(primitive.x1 + size.width / 2, primitive.y1 + size.height / 2);
+            shape = PhysicsShapeBox::create(size, _material, center);
+        }
+
+        if (shape)
+        {
+            shape->setCategoryBitmask(_categoryBitmask);
+            shape->setCollisionBitmask(_collisionBitmask);
+            shape->setContactTestBitmask(_contactTestBitmask);
+            shape->setGroup(_group);
+            body->addShape(shape, false);
+            chunk.shapes.push_back(shape);
+        }
+    }
+}
+
+bool PhysicsTMXLayerBaker::saveCache() const
+{
+    if (_cacheFile.empty() || !_baked)
+    {
+        return false;
+    }
+
+    TMXBakeFileHeader header;
+    memcpy(header.magic, TMX_BAKE_FILE_MAGIC, sizeof(header.magic));
+    header.version = TMX_BAKE_FILE_VERSION;
+    header.mode = (uint32_t)_mode;
+    header.rangeX = _rangeX;
+    header.rangeY = _rangeY;
+    header.rangeWidth = _rangeWidth;
+    header.rangeHeight = _rangeHeight;
+    header.chunkSize = _chunkSize;
+    header.tileWidth = _tileSize.width;
+    header.tileHeight = _tileSize.height;
+    header.solidHash = getSolidTilesHash();
+
+    ssize_t size = sizeof(header);
+    for (auto& chunk : _chunks)
+    {
+        size += sizeof(uint32_t) + chunk.primitives.size() * sizeof(Primitive);
+    }
+
+    auto bytes = (unsigned char*)malloc(size);
+    if (bytes == nullptr)
+    {
+        return false;
+    }
+
+    auto dest = bytes;
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    for (auto& chunk : _chunks)
+    {
+        uint32_t count = (uint32_t)chunk.primitives.size();
+        memcpy(dest, &count, sizeof(count));
+        dest += sizeof(count);
+        if (count > 0)
+        {
+            memcpy(dest, chunk.primitives.data(), count * sizeof(Primitive));
+            dest += count * sizeof(Primitive);
+        }
+    }
+
+    Data data;
+    data.fastSet(bytes, size);
+
+    // write to a temporary file first so an interrupted write never leaves a truncated cache behind
+    auto fileUtils = FileUtils::getInstance();
+    std::string tempFile = _cacheFile + ".tmp";
+    if (!fileUtils->writeDataToFile(data, tempFile))
+    {
+        return false;
+    }
+    if (!fileUtils->renameFile(tempFile, _cacheFile))
+    {
+        fileUtils->removeFile(tempFile);
+        return false;
+    }
+    return true;
+}
+
+bool PhysicsTMXLayerBaker::loadCache()
+{
+    auto fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isFileExist(_cacheFile))
+    {
+        return false;
+    }
+
+    Data data = fileUtils->getDataFromFile(_cacheFile);
+    TMXBakeFileHeader header;
+    if (data.getSize() < (ssize_t)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, data.getBytes(), sizeof(header));
+
+    if (memcmp(header.magic, TMX_BAKE_FILE_MAGIC, sizeof(header.magic)) != 0
+        || header.version != TMX_BAKE_FILE_VERSION
+        || header.mode != (uint32_t)_mode
+        || header.rangeX != _rangeX
+        || header.rangeY != _rangeY
+        || header.rangeWidth != _rangeWidth
+        || header.rangeHeight != _rangeHeight
+        || header.chunkSize != _chunkSize
+        || header.tileWidth != _tileSize.width
+        || header.tileHeight != _tileSize.height
+        || header.solidHash != getSolidTilesHash())
+    {
+        return false;
+    }
+
+    auto src = data.getBytes() + sizeof(header);
+    auto end = data.getBytes() + data.getSize();
+    for (auto& chunk : _chunks)
+    {
+        uint32_t count;
+        if (end - src < (ssize_t)sizeof(count))
+        {
+            break;
+        }
+        memcpy(&count, src, sizeof(count));
+        src += sizeof(count);
+
+        if ((size_t)(end - src) < count * sizeof(Primitive))
+        {
+            break;
+        }
+        chunk.primitives.resize(count);
+        if (count > 0)
+        {
+            memcpy(chunk.primitives.data(), src, count * sizeof(Primitive));
+        }
+        src += count * sizeof(Primitive);
+    }
+
+    if (src != end)
+    {
+        CCLOG("PhysicsTMXLayerBaker: %s is truncated, baking again", _cacheFile.c_str());
+        for (auto& chunk : _chunks)
+        {
+            chunk.primitives.clear();
+        }
+        return false;
+    }
+    return true;
+}
+
+NS_CC_END
+
+#endif // CC_USE_PHYSICS
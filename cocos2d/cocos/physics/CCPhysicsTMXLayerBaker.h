@@ -0,0 +1,260 @@
+/****************************************************************************
+ Copyright (c) 2013-2016 Chukong Technologies Inc.
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef __CCPHYSICS_TMXLAYER_BAKER_H__
+#define __CCPHYSICS_TMXLAYER_BAKER_H__
+
+#include "base/ccConfig.h"
+#if CC_USE_PHYSICS
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "2d/CCNode.h"
+#include "physics/CCPhysicsShape.h"
+
+NS_CC_BEGIN
+
+class TMXLayer;
+class PhysicsShape;
+
+/**
+ * @addtogroup physics
+ * @{
+ * @addtogroup physics_2d
+ * @{
+ */
+
+/**
+ * @brief Bakes the solid tiles of a TMXLayer into a few merged static colliders.
+ *
+ * Creating one box per solid tile gives thousands of shapes and lets bodies snag on the seams between tiles.
+ * The baker instead attaches a single static PhysicsBody to itself, whose shapes are either the outline of the
+ * solid areas, merged into the longest possible edge segments, or the solid areas merged greedily into boxes.
+ *
+ * The layer is split into chunks that are baked separately. Tiles changed through TMXLayer::setTileGID() or
+ * TMXLayer::removeTileAt() only rebake their chunks, on the next frame. Only orthogonal maps are supported.
+ *
+ * Add the baker to the parent of the layer; it copies the position, scale and rotation of the layer when it
+ * enters the scene and when it bakes. Set the bitmasks and group through the baker so that they also apply to
+ * rebaked shapes, the ones set on getPhysicsBody() only change the shapes baked so far.
+ */
+class CC_DLL PhysicsTMXLayerBaker : public Node
+{
+public:
+    enum class Mode
+    {
+        SEGMENTS,   ///< edge segments along the outline of the solid tiles, no seams
+        BOXES       ///< solid boxes, each covering a rectangle of solid tiles
+    };
+
+    /**
+     * Creates a baker for a layer.
+     *
+     * @param layer The layer to bake. Its tile map must not have been released.
+     * @param mode The kind of shapes to create.
+     * @param tileRange The range of tiles to bake, in tile coordinates. Rect::ZERO bakes the whole layer.
+     * @return An autoreleased PhysicsTMXLayerBaker object, or nullptr if the layer is not orthogonal.
+     */
+    static PhysicsTMXLayerBaker* create(TMXLayer* layer, Mode mode = Mode::SEGMENTS, const Rect& tileRange = Rect::ZERO);
+
+    /** Get the baked layer. */
+    TMXLayer* getLayer() const { return _layer; }
+
+    /** Get the mode. */
+    Mode getMode() const { return _mode; }
+
+    /**
+     * Set the function deciding whether a tile is solid.
+     *
+     * By default every non-empty tile is solid. The filter receives the gid without its flip flags.
+     * Changing the filter rebakes the whole layer on the next bake().
+     */
+    void setSolidTileFilter(const std::function<bool(uint32_t gid)>& filter);
+
+    /** Set the material of the baked shapes. Applies to shapes baked afterwards. */
+    void setMaterial(const PhysicsMaterial& material) { _material = material; }
+
+    /** Get the material of the baked shapes. */
+    const PhysicsMaterial& getMaterial() const { return _material; }
+
+    /** Set the category bitmask of the baked shapes, including the ones baked afterwards. @see PhysicsShape::setCategoryBitmask */
+    void setCategoryBitmask(int bitmask);
+
+    /** Get the category bitmask of the baked shapes. */
+    int getCategoryBitmask() const { return _categoryBitmask; }
+
+    /** Set the collision bitmask of the baked shapes, including the ones baked afterwards. @see PhysicsShape::setCollisionBitmask */
+    void setCollisionBitmask(int bitmask);
+
+    /** Get the collision bitmask of the baked shapes. */
+    int getCollisionBitmask() const { return _collisionBitmask; }
+
+    /** Set the contact test bitmask of the baked shapes, including the ones baked afterwards. @see PhysicsShape::setContactTestBitmask */
+    void setContactTestBitmask(int bitmask);
+
+    /** Get the contact test bitmask of the baked shapes. */
+    int getContactTestBitmask() const { return _contactTestBitmask; }
+
+    /** Set the group of the baked shapes, including the ones baked afterwards. @see PhysicsShape::setGroup */
+    void setGroup(int group);
+
+    /** Get the group of the baked shapes. */
+    int getGroup() const { return _group; }
+
+    /** Set the border of the edge segments, in points. Applies to shapes baked afterwards. Default is 1. */
+    void setEdgeBorder(float border) { _edgeBorder = border; }
+
+    /** Get the border of the edge segments. */
+    float getEdgeBorder() const { return _edgeBorder; }
+
+    /**
+     * Set the size of a chunk, in tiles. A tile change rebakes its chunk only, but shapes never span chunks.
+     * Must be called before the first bake. Default is 32.
+     */
+    void setChunkSize(int tiles);
+
+    /** Get the size of a chunk, in tiles. */
+    int getChunkSize() const { return _chunkSize; }
+
+    /**
+     * Set the file caching the baked geometry.
+     *
+     * When the file was baked from the same solid tiles, bake() loads it instead of baking; otherwise
+     * bake() writes it. Must be called before bake().
+     * @param fullPath The full path of the cache file, empty to disable the cache.
+     */
+    void setCacheFile(const std::string& fullPath) { _cacheFile = fullPath; }
+
+    /** Get the cache file. */
+    const std::string& getCacheFile() const { return _cacheFile; }
+
+    /**
+     * Write the current geometry, including incremental changes, to the cache file.
+     *
+     * @return True if the file has been written.
+     */
+    bool saveCache() const;
+
+    /**
+     * Bake the whole layer now.
+     *
+     * Called automatically the first time the baker enters the scene.
+     */
+    void bake();
+
+    /**
+     * Rebake the chunks around a tile on the next frame.
+     *
+     * Called automatically when the tile changes through the layer.
+     * @param tileCoordinate The tile coordinate in the layer.
+     */
+    void markTileDirty(const Vec2& tileCoordinate);
+
+    /** Get the number of shapes currently baked. */
+    int getShapeCount() const;
+
+    virtual void onEnter() override;
+    virtual void update(float delta) override;
+
+CC_CONSTRUCTOR_ACCESS:
+    PhysicsTMXLayerBaker();
+    virtual ~PhysicsTMXLayerBaker();
+
+    bool init(TMXLayer* layer, Mode mode, const Rect& tileRange);
+
+protected:
+    /** A baked segment (x1, y1) - (x2, y2), or a box from (x1, y1) to (x2, y2), in points. */
+    struct Primitive
+    {
+        float x1;
+        float y1;
+        float x2;
+        float y2;
+    };
+
+    /** Forwards the tile changes of the layer, lets the baker recognize its own callback. */
+    struct TileChangedForwarder
+    {
+        PhysicsTMXLayerBaker* baker;
+
+        void operator()(TMXLayer* /*layer*/, const Vec2& tileCoordinate) const { baker->markTileDirty(tileCoordinate); }
+    };
+
+    struct Chunk
+    {
+        std::vector<Primitive> primitives;
+        std::vector<PhysicsShape*> shapes;
+        bool dirty;
+    };
+
+    void syncWithLayer();
+    bool isSolid(int x, int y) const { return x >= 0 && y >= 0 && x < _rangeWidth && y < _rangeHeight && _solid[y * _rangeWidth + x] != 0; }
+    bool readSolid(int x, int y) const;
+    void updateSolidTiles();
+    void markChunkDirty(int x, int y);
+    void bakeChunk(int index);
+    void bakeSegments(Chunk& chunk, int x0, int y0, int x1, int y1);
+    void bakeBoxes(Chunk& chunk, int x0, int y0, int x1, int y1);
+    void rebuildShapes(int index);
+    void rebakeDirtyChunks();
+    uint32_t getSolidTilesHash() const;
+    bool loadCache();
+
+    TMXLayer* _layer;
+    Mode _mode;
+    std::function<bool(uint32_t)> _solidTileFilter;
+    PhysicsMaterial _material;
+    float _edgeBorder;
+    int _categoryBitmask;
+    int _collisionBitmask;
+    int _contactTestBitmask;
+    int _group;
+    std::string _cacheFile;
+
+    int _rangeX;
+    int _rangeY;
+    int _rangeWidth;
+    int _rangeHeight;
+    int _chunkSize;
+    int _chunksX;
+    int _chunksY;
+    Size _tileSize;
+    float _layerHeight;
+
+    std::vector<unsigned char> _solid;
+    std::vector<Chunk> _chunks;
+    bool _baked;
+    bool _hasDirtyChunks;
+};
+
+/** @} */
+/** @} */
+
+NS_CC_END
+
+#endif // CC_USE_PHYSICS
+#endif // __CCPHYSICS_TMXLAYER_BAKER_H__
@@ -26,7 +26,9 @@
 #include "physics/CCPhysicsWorld.h"
 #if CC_USE_PHYSICS
 #include <algorithm>
+#include <chrono>
 #include <climits>
+#include <unordered_map>
 
 #include "chipmunk/chipmunk_private.h"
 #include "physics/CCPhysicsBody.h"
@@ -40,6 +42,7 @@
 #include "base/CCDirector.h"
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventCustom.h"
+#include "base/CCJobSystem.h"
 
 NS_CC_BEGIN
 const float PHYSICS_INFINITY = FLT_MAX;
@@ -75,6 +78,217 @@ namespace
         PhysicsQueryPointCallbackFunc func;
         void* data;
     }PointQueryCallbackInfo;
+    
+    // state of one query of a batch, the spatial indexes are walked directly without locking the space,
+    // so that several threads can query the same frozen space
+    struct BatchQueryContext
+    {
+        int queryIndex;
+        int categoryMask;
+        bool allHits;
+        bool done;
+        cpVect point1;
+        cpVect point2;
+        cpSegmentQueryInfo closest;
+        std::vector<PhysicsQueryHit>* hits;
+    };
+    
+    const char PHYSICS_SNAPSHOT_MAGIC[4] = { 'C', 'C', 'P', 'S' };
+    const uint32_t PHYSICS_SNAPSHOT_VERSION = 2;
+    
+    struct SnapshotHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t bodyCount;
+        uint32_t shapeCount;
+        uint32_t constraintCount;
+        uint32_t arbiterCount;
+        uint32_t contactCount;
+        int32_t updateRateCount;
+        double updateTime;
+        double stepDelta;
+    };
+    
+    struct BodySnapshot
+    {
+        double positionX;
+        double positionY;
+        double angle;
+        double velocityX;
+        double velocityY;
+        double angularVelocity;
+        double velocityBiasX;
+        double velocityBiasY;
+        double angularVelocityBias;
+        double forceX;
+        double forceY;
+        double torque;
+        double idleTime;
+    };
+    
+    struct ConstraintSnapshot
+    {
+        double state[2];
+    };
+    
+    const uint32_t ARBITER_ACCEPTED = 0x01;
+    const uint32_t ARBITER_NOTIFIED = 0x02;
+    
+    struct ArbiterSnapshot
+    {
+        uint32_t shapeA;
+        uint32_t shapeB;
+        uint32_t contactCount;
+        uint32_t flags;
+    };
+    
+    template <typename ContactMap>
+    typename ContactMap::iterator findContactPair(ContactMap& contacts, const cpShape* a, const cpShape* b)
+    {
+        auto it = contacts.find(std::make_pair(a, b));
+        return it != contacts.end() ? it : contacts.find(std::make_pair(b, a));
+    }
+    
+    // the values a constraint carries from one step to the next: the impulse warm starting the solver,
+    // and the reference angle of a ratchet
+    int getConstraintState(cpConstraint* constraint, cpFloat* state[2])
+    {
+        if (cpConstraintIsPinJoint(constraint))
+        {
+            state[0] = &((cpPinJoint*)constraint)->jnAcc;
+            return 1;
+        }
+        if (cpConstraintIsSlideJoint(constraint))
+        {
+            state[0] = &((cpSlideJoint*)constraint)->jnAcc;
+            return 1;
+        }
+        if (cpConstraintIsPivotJoint(constraint))
+        {
+            state[0] = &((cpPivotJoint*)constraint)->jAcc.x;
+            state[1] = &((cpPivotJoint*)constraint)->jAcc.y;
+            return 2;
+        }
+        if (cpConstraintIsGrooveJoint(constraint))
+        {
+            state[0] = &((cpGrooveJoint*)constraint)->jAcc.x;
+            state[1] = &((cpGrooveJoint*)constraint)->jAcc.y;
+            return 2;
+        }
+        if (cpConstraintIsDampedSpring(constraint))
+        {
+            state[0] = &((cpDampedSpring*)constraint)->jAcc;
+            return 1;
+        }
+        if (cpConstraintIsDampedRotarySpring(constraint))
+        {
+            state[0] = &((cpDampedRotarySpring*)constraint)->jAcc;
+            return 1;
+        }
+        if (cpConstraintIsRotaryLimitJoint(constraint))
+        {
+            state[0] = &((cpRotaryLimitJoint*)constraint)->jAcc;
+            return 1;
+        }
+        if (cpConstraintIsRatchetJoint(constraint))
+        {
+            state[0] = &((cpRatchetJoint*)constraint)->angle;
+            state[1] = &((cpRatchetJoint*)constraint)->jAcc;
+            return 2;
+        }
+        if (cpConstraintIsGearJoint(constraint))
+        {
+            state[0] = &((cpGearJoint*)constraint)->jAcc;
+            return 1;
+        }
+        if (cpConstraintIsSimpleMotor(constraint))
+        {
+            state[0] = &((cpSimpleMotor*)constraint)->jAcc;
+            return 1;
+        }
+        return 0;
+    }
+    
+    inline PhysicsShape* acceptShape(const cpShape* shape, int categoryMask)
+    {
+        PhysicsShape* physicsShape = static_cast<PhysicsShape*>(cpShapeGetUserData(shape));
+        CC_ASSERT(physicsShape != nullptr);
+        return (physicsShape->getCategoryBitmask() & categoryMask) != 0 ? physicsShape : nullptr;
+    }
+    
+    cpFloat batchRayQueryFunc(BatchQueryContext* context, cpShape* shape, void* /*data*/)
+    {
+        cpSegmentQueryInfo info;
+        PhysicsShape* physicsShape = nullptr;
+        if (!cpShapeSegmentQuery(shape, context->point1, context->point2, 0.0f, &info)
+            || (physicsShape = acceptShape(shape, context->categoryMask)) == nullptr)
+        {
+            return context->allHits ? 1.0f : context->closest.alpha;
+        }
+        
+        if (context->allHits)
+        {
+            PhysicsQueryHit hit = {
+                context->queryIndex,
+                physicsShape,
+                PhysicsHelper::cpv2point(info.point),
+                PhysicsHelper::cpv2point(info.normal),
+                static_cast<float>(info.alpha)
+            };
+            context->hits->push_back(hit);
+            return 1.0f;
+        }
+        
+        if (info.alpha < context->closest.alpha)
+        {
+            context->closest = info;
+        }
+        // returning the closest fraction clips the rest of the traversal
+        return context->closest.alpha;
+    }
+    
+    cpCollisionID batchRectQueryFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+    {
+        if (context->done || !cpBBIntersects(cpBBNew(context->point1.x, context->point1.y, context->point2.x, context->point2.y), cpShapeGetBB(shape)))
+        {
+            return id;
+        }
+        
+        PhysicsShape* physicsShape = acceptShape(shape, context->categoryMask);
+        if (physicsShape != nullptr)
+        {
+            PhysicsQueryHit hit = { context->queryIndex, physicsShape, Vec2::ZERO, Vec2::ZERO, 0.0f };
+            context->hits->push_back(hit);
+            context->done = !context->allHits;
+        }
+        
+        return id;
+    }
+    
+    cpCollisionID batchPointQueryFunc(BatchQueryContext* context, cpShape* shape, cpCollisionID id, void* /*data*/)
+    {
+        if (context->done)
+        {
+            return id;
+        }
+        
+        cpPointQueryInfo info;
+        if (cpShapePointQuery(shape, context->point1, &info) >= 0.0f)
+        {
+            return id;
+        }
+        
+        PhysicsShape* physicsShape = acceptShape(shape, context->categoryMask);
+        if (physicsShape != nullptr)
+        {
+            PhysicsQueryHit hit = { context->queryIndex, physicsShape, PhysicsHelper::cpv2point(info.point), Vec2::ZERO, 0.0f };
+            context->hits->push_back(hit);
+            context->done = !context->allHits;
+        }
+        
+        return id;
+    }
 }
 
 class PhysicsWorldCallback
@@ -97,6 +311,7 @@ bool PhysicsWorldCallback::continues = true;
 
 cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct cpSpace* /*space*/, PhysicsWorld *world)
 {
+    CCASSERT(std::this_thread::get_id() == world->_stepThreadId, "contact callbacks must run on the thread stepping the world");
     CP_ARBITER_GET_SHAPES(arb, a, b);
     
     PhysicsShape *shapeA = static_cast<PhysicsShape*>(cpShapeGetUserData(a));
@@ -106,27 +321,46 @@ cpBool PhysicsWorldCallback::collisionBeginCallbackFunc(cpArbiter *arb, struct c
     auto contact = PhysicsContact::construct(shapeA, shapeB);
     cpArbiterSetUserData(arb, contact);
     contact->_contactInfo = arb;
+    world->_touchingArbiters.insert(arb);
+    
+    bool accepted = true;
+    if (!world->_resumedContacts.empty() && world->resumeContact(arb, accepted))
+    {
+        return accepted;
+    }
     
     return world->collisionBeginCallback(*contact);
 }
 
 cpBool PhysicsWorldCallback::collisionPreSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
+    CCASSERT(std::this_thread::get_id() == world->_stepThreadId, "contact callbacks must run on the thread stepping the world");
     return world->collisionPreSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
 }
 
 void PhysicsWorldCallback::collisionPostSolveCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
+    CCASSERT(std::this_thread::get_id() == world->_stepThreadId, "contact callbacks must run on the thread stepping the world");
     world->collisionPostSolveCallback(*static_cast<PhysicsContact*>(cpArbiterGetUserData(arb)));
 }
 
 void PhysicsWorldCallback::collisionSeparateCallbackFunc(cpArbiter *arb, cpSpace* /*space*/, PhysicsWorld *world)
 {
+    CCASSERT(std::this_thread::get_id() == world->_stepThreadId, "contact callbacks must run on the thread stepping the world");
     PhysicsContact* contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+    world->_touchingArbiters.erase(arb);
     
     world->collisionSeparateCallback(*contact);
     
-    delete contact;
+    if (world->_bufferingStep || !world->_contactRecords.empty())
+    {
+        // the contact may be referenced by a record, delete it when the next step starts
+        world->_separatedContacts.push_back(contact);
+    }
+    else
+    {
+        delete contact;
+    }
 }
 
 void PhysicsWorldCallback::rayCastCallbackFunc(cpShape *shape, cpVect point, cpVect normal, cpFloat alpha, RayCastCallbackInfo *info)
@@ -349,6 +583,12 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
     
     if (contact.isNotificationEnabled())
     {
+        if (_bufferingStep)
+        {
+            recordContact(contact, PhysicsContact::EventCode::BEGIN);
+            return ret;
+        }
+        
         contact.setEventCode(PhysicsContact::EventCode::BEGIN);
         contact.setWorld(this);
         _eventDispatcher->dispatchEvent(&contact);
@@ -359,7 +599,7 @@ bool PhysicsWorld::collisionBeginCallback(PhysicsContact& contact)
 
 bool PhysicsWorld::collisionPreSolveCallback(PhysicsContact& contact)
 {
-    if (!contact.isNotificationEnabled())
+    if (!contact.isNotificationEnabled() || _bufferingStep)
     {
         return true;
     }
@@ -378,6 +618,12 @@ void PhysicsWorld::collisionPostSolveCallback(PhysicsContact& contact)
         return;
     }
     
+    if (_bufferingStep)
+    {
+        recordContact(contact, PhysicsContact::EventCode::POSTSOLVE);
+        return;
+    }
+    
     contact.setEventCode(PhysicsContact::EventCode::POSTSOLVE);
     contact.setWorld(this);
     _eventDispatcher->dispatchEvent(&contact);
@@ -390,11 +636,103 @@ void PhysicsWorld::collisionSeparateCallback(PhysicsContact& contact)
         return;
     }
     
+    if (_bufferingStep)
+    {
+        recordContact(contact, PhysicsContact::EventCode::SEPARATE);
+        return;
+    }
+    
     contact.setEventCode(PhysicsContact::EventCode::SEPARATE);
     contact.setWorld(this);
     _eventDispatcher->dispatchEvent(&contact);
 }
 
+void PhysicsWorld::recordContact(PhysicsContact& contact, PhysicsContact::EventCode eventCode)
+{
+    PhysicsContactRecord record;
+    record.contact = &contact;
+    record.shapeA = contact.getShapeA();
+    record.shapeB = contact.getShapeB();
+    record.eventCode = eventCode;
+    
+    cpArbiter* arb = static_cast<cpArbiter*>(contact._contactInfo);
+    if (eventCode != PhysicsContact::EventCode::SEPARATE && arb != nullptr)
+    {
+        record.data.count = cpArbiterGetCount(arb);
+        for (int i = 0; i < record.data.count && i < PhysicsContactData::POINT_MAX; ++i)
+        {
+            record.data.points[i] = PhysicsHelper::cpv2point(cpArbiterGetPointA(arb, i));
+        }
+        record.data.normal = record.data.count > 0 ? PhysicsHelper::cpv2point(cpArbiterGetNormal(arb)) : Vec2::ZERO;
+    }
+    else if (contact.getContactData() != nullptr)
+    {
+        record.data = *contact.getContactData();
+    }
+    
+    if (eventCode == PhysicsContact::EventCode::POSTSOLVE && arb != nullptr)
+    {
+        record.impulse = PhysicsHelper::cpv2point(cpArbiterTotalImpulse(arb));
+    }
+    
+    _contactRecords.push_back(record);
+}
+
+void PhysicsWorld::dispatchContactRecords()
+{
+    if (_contactRecords.empty())
+    {
+        return;
+    }
+    
+    // bodies and joints removed by the listeners are delayed until every record has been delivered
+    _dispatchingContacts = true;
+    
+    PhysicsContact* delivered = nullptr;
+    void* deliveredInfo = nullptr;
+    auto restoreDelivered = [&delivered, &deliveredInfo]() {
+        if (delivered != nullptr)
+        {
+            delivered->resetResult();
+            delivered->_contactInfo = deliveredInfo;
+            delivered = nullptr;
+        }
+    };
+    
+    _eventDispatcher->dispatchEventBatch(PHYSICSCONTACT_EVENT_NAME, _contactRecords.size(), [&](ssize_t index) -> Event* {
+        restoreDelivered();
+        
+        auto& record = _contactRecords[index];
+        PhysicsContact* contact = record.contact;
+        delivered = contact;
+        deliveredInfo = contact->_contactInfo;
+        
+        // arbiters stay valid until the next step, but only the post-solve listener reads them
+        contact->_contactInfo = record.eventCode == PhysicsContact::EventCode::POSTSOLVE ? deliveredInfo : nullptr;
+        contact->setContactData(record.data);
+        contact->setEventCode(record.eventCode);
+        contact->setWorld(this);
+        return contact;
+    });
+    restoreDelivered();
+    
+    _dispatchingContacts = false;
+}
+
+bool PhysicsWorld::isSpaceLocked() const
+{
+    return cpSpaceIsLocked(_cpSpace) || _dispatchingContacts;
+}
+
+void PhysicsWorld::deleteSeparatedContacts()
+{
+    for (auto contact : _separatedContacts)
+    {
+        delete contact;
+    }
+    _separatedContacts.clear();
+}
+
 void PhysicsWorld::rayCast(PhysicsRayCastCallbackFunc func, const Vec2& point1, const Vec2& point2, void* data)
 {
     CCASSERT(func != nullptr, "func shouldn't be nullptr");
@@ -461,6 +799,122 @@ void PhysicsWorld::queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& po
     }
 }
 
+void PhysicsWorld::runBatchQuery(int count, std::vector<PhysicsQueryHit>& hits, bool parallel,
+                                 const std::function<void(int, std::vector<PhysicsQueryHit>&)>& query)
+{
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+    
+    // the spatial hash stamps its cells while querying, so it can only be queried from one thread
+    int threadCount = JobSystem::getInstance()->getThreadCount();
+    if (!parallel || _usingSpatialHash || threadCount == 0 || count < 2)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            query(i, hits);
+        }
+        return;
+    }
+    
+    // a few chunks per thread balances uneven queries, and keeps the hits ordered by query once concatenated
+    int chunkCount = std::min(count, (threadCount + 1) * 4);
+    std::vector<std::vector<PhysicsQueryHit>> chunkHits(chunkCount);
+    JobSystem::getInstance()->parallelFor(chunkCount, [&](int chunk) {
+        int begin = static_cast<int>(static_cast<long long>(count) * chunk / chunkCount);
+        int end = static_cast<int>(static_cast<long long>(count) * (chunk + 1) / chunkCount);
+        for (int i = begin; i < end; ++i)
+        {
+            query(i, chunkHits[chunk]);
+        }
+    });
+    
+    for (auto& chunk : chunkHits)
+    {
+        hits.insert(hits.end(), chunk.begin(), chunk.end());
+    }
+}
+
+void PhysicsWorld::rayCastBatch(const std::vector<PhysicsRay>& rays, std::vector<PhysicsQueryHit>& hits,
+                                bool allHits/* = false*/, int categoryMask/* = -1*/, bool parallel/* = false*/)
+{
+    runBatchQuery(static_cast<int>(rays.size()), hits, parallel, [&](int index, std::vector<PhysicsQueryHit>& out) {
+        BatchQueryContext context;
+        context.queryIndex = index;
+        context.categoryMask = categoryMask;
+        context.allHits = allHits;
+        context.done = false;
+        context.point1 = PhysicsHelper::point2cpv(rays[index].start);
+        context.point2 = PhysicsHelper::point2cpv(rays[index].end);
+        context.closest.shape = nullptr;
+        context.closest.alpha = 1.0f;
+        context.hits = &out;
+        
+        size_t first = out.size();
+        cpSpatialIndexSegmentQuery(_cpSpace->staticShapes, &context, context.point1, context.point2, 1.0f,
+                                   (cpSpatialIndexSegmentQueryFunc)batchRayQueryFunc, nullptr);
+        cpSpatialIndexSegmentQuery(_cpSpace->dynamicShapes, &context, context.point1, context.point2, context.closest.alpha,
+                                   (cpSpatialIndexSegmentQueryFunc)batchRayQueryFunc, nullptr);
+        
+        if (allHits)
+        {
+            std::sort(out.begin() + first, out.end(), [](const PhysicsQueryHit& a, const PhysicsQueryHit& b) {
+                return a.fraction < b.fraction;
+            });
+        }
+        else if (context.closest.shape != nullptr)
+        {
+            PhysicsQueryHit hit = {
+                index,
+                static_cast<PhysicsShape*>(cpShapeGetUserData(context.closest.shape)),
+                PhysicsHelper::cpv2point(context.closest.point),
+                PhysicsHelper::cpv2point(context.closest.normal),
+                static_cast<float>(context.closest.alpha)
+            };
+            out.push_back(hit);
+        }
+    });
+}
+
+void PhysicsWorld::queryRectBatch(const std::vector<Rect>& rects, std::vector<PhysicsQueryHit>& hits,
+                                  bool allHits/* = true*/, int categoryMask/* = -1*/, bool parallel/* = false*/)
+{
+    runBatchQuery(static_cast<int>(rects.size()), hits, parallel, [&](int index, std::vector<PhysicsQueryHit>& out) {
+        cpBB bb = PhysicsHelper::rect2cpbb(rects[index]);
+        
+        BatchQueryContext context;
+        context.queryIndex = index;
+        context.categoryMask = categoryMask;
+        context.allHits = allHits;
+        context.done = false;
+        context.point1 = cpv(bb.l, bb.b);
+        context.point2 = cpv(bb.r, bb.t);
+        context.hits = &out;
+        
+        cpSpatialIndexQuery(_cpSpace->staticShapes, &context, bb, (cpSpatialIndexQueryFunc)batchRectQueryFunc, nullptr);
+        cpSpatialIndexQuery(_cpSpace->dynamicShapes, &context, bb, (cpSpatialIndexQueryFunc)batchRectQueryFunc, nullptr);
+    });
+}
+
+void PhysicsWorld::queryPointBatch(const std::vector<Vec2>& points, std::vector<PhysicsQueryHit>& hits,
+                                   bool allHits/* = true*/, int categoryMask/* = -1*/, bool parallel/* = false*/)
+{
+    runBatchQuery(static_cast<int>(points.size()), hits, parallel, [&](int index, std::vector<PhysicsQueryHit>& out) {
+        BatchQueryContext context;
+        context.queryIndex = index;
+        context.categoryMask = categoryMask;
+        context.allHits = allHits;
+        context.done = false;
+        context.point1 = PhysicsHelper::point2cpv(points[index]);
+        context.hits = &out;
+        
+        cpBB bb = cpBBNewForCircle(context.point1, 0.0f);
+        cpSpatialIndexQuery(_cpSpace->staticShapes, &context, bb, (cpSpatialIndexQueryFunc)batchPointQueryFunc, nullptr);
+        cpSpatialIndexQuery(_cpSpace->dynamicShapes, &context, bb, (cpSpatialIndexQueryFunc)batchPointQueryFunc, nullptr);
+    });
+}
+
 Vector<PhysicsShape*> PhysicsWorld::getShapes(const Vec2& point) const
 {
     Vector<PhysicsShape*> arr;
@@ -565,7 +1019,7 @@ void PhysicsWorld::addBodyOrDelay(PhysicsBody* body)
 
 void PhysicsWorld::updateBodies()
 {
-    if (cpSpaceIsLocked(_cpSpace))
+    if (isSpaceLocked())
     {
         return;
     }
@@ -627,7 +1081,7 @@ void PhysicsWorld::removeBodyOrDelay(PhysicsBody* body)
         return;
     }
     
-    if (cpSpaceIsLocked(_cpSpace))
+    if (isSpaceLocked())
     {
         if (_delayRemoveBodies.getIndex(body) == CC_INVALID_INDEX)
         {
@@ -659,7 +1113,7 @@ void PhysicsWorld::removeJoint(PhysicsJoint* joint, bool destroy)
             removedFromDelayAdd = true;
         }
 
-        if (cpSpaceIsLocked(_cpSpace))
+        if (isSpaceLocked())
         {
             if (removedFromDelayAdd)
                 return;
@@ -677,7 +1131,7 @@ void PhysicsWorld::removeJoint(PhysicsJoint* joint, bool destroy)
 
 void PhysicsWorld::updateJoints()
 {
-    if (cpSpaceIsLocked(_cpSpace))
+    if (isSpaceLocked())
     {
         return;
     }
@@ -715,6 +1169,10 @@ void PhysicsWorld::removeShape(PhysicsShape* shape)
         {
             if (cpSpaceContainsShape(_cpSpace, cps))
             {
+                if (!_resumedContacts.empty())
+                {
+                    endResumedContacts(cps);
+                }
                 cpSpaceRemoveShape(_cpSpace, cps);
             }
         }
@@ -850,6 +1308,99 @@ void PhysicsWorld::setGravity(const Vec2& gravity)
     cpSpaceSetGravity(_cpSpace, PhysicsHelper::point2cpv(gravity));
 }
 
+void PhysicsWorld::setSolverThreadCount(int count)
+{
+    CCASSERT(count >= 0, "the thread count can not be negative");
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    if (count > 1)
+    {
+        CCLOG("PhysicsWorld::setSolverThreadCount: the threaded solver is not supported on this platform");
+    }
+#else
+    cpHastySpaceSetThreads(_cpSpace, count);
+#endif
+}
+
+int PhysicsWorld::getSolverThreadCount() const
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    return 1;
+#else
+    return static_cast<int>(cpHastySpaceGetThreads(_cpSpace));
+#endif
+}
+
+void PhysicsWorld::setSleepTimeThreshold(float seconds)
+{
+    cpSpaceSetSleepTimeThreshold(_cpSpace, seconds);
+}
+
+float PhysicsWorld::getSleepTimeThreshold() const
+{
+    return PhysicsHelper::cpfloat2float(cpSpaceGetSleepTimeThreshold(_cpSpace));
+}
+
+void PhysicsWorld::setIdleSpeedThreshold(float speed)
+{
+    cpSpaceSetIdleSpeedThreshold(_cpSpace, speed);
+}
+
+float PhysicsWorld::getIdleSpeedThreshold() const
+{
+    return PhysicsHelper::cpfloat2float(cpSpaceGetIdleSpeedThreshold(_cpSpace));
+}
+
+void PhysicsWorld::setIterations(int iterations)
+{
+    CCASSERT(iterations > 0, "the iteration count must be positive");
+    cpSpaceSetIterations(_cpSpace, iterations);
+}
+
+int PhysicsWorld::getIterations() const
+{
+    return cpSpaceGetIterations(_cpSpace);
+}
+
+void PhysicsWorld::setCollisionSlop(float slop)
+{
+    cpSpaceSetCollisionSlop(_cpSpace, slop);
+}
+
+float PhysicsWorld::getCollisionSlop() const
+{
+    return PhysicsHelper::cpfloat2float(cpSpaceGetCollisionSlop(_cpSpace));
+}
+
+void PhysicsWorld::useSpatialHash(float cellSize, int count)
+{
+    CCASSERT(!cpSpaceIsLocked(_cpSpace), "can not change the broadphase while the world is stepping");
+    CCASSERT(cellSize > 0 && count > 0, "invalid spatial hash parameters");
+    cpSpaceUseSpatialHash(_cpSpace, cellSize, count);
+    _usingSpatialHash = true;
+    _spatialHashCellSize = cellSize;
+    _spatialHashCount = count;
+}
+
+PhysicsWorldStatistics PhysicsWorld::getStatistics() const
+{
+    PhysicsWorldStatistics statistics;
+    statistics.activeBodies = _cpSpace->dynamicBodies->num;
+    statistics.sleepingBodies = 0;
+    for (int i = 0; i < _cpSpace->sleepingComponents->num; ++i)
+    {
+        auto root = static_cast<cpBody*>(_cpSpace->sleepingComponents->arr[i]);
+        for (cpBody* body = root; body != nullptr; body = body->sleeping.next)
+        {
+            ++statistics.sleepingBodies;
+        }
+    }
+    statistics.contactPairs = _cpSpace->arbiters->num;
+    statistics.steps = _statisticsSteps;
+    statistics.stepTime = _statisticsStepTime;
+    
+    return statistics;
+}
+
 void PhysicsWorld::setSubsteps(int steps)
 {
     if(steps > 0)
@@ -901,13 +1452,11 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
         return;
     }
 
+    _resetStepStatistics = true;
+
     if (userCall)
     {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-		cpSpaceStep(_cpSpace, delta);
-#else
-		cpHastySpaceStep(_cpSpace, delta);
-#endif
+        stepSpace(delta);
     }
     else
     {
@@ -919,12 +1468,8 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
             while(_updateTime>step)
             {
                 _updateTime-=step;
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-				cpSpaceStep(_cpSpace, dt);
-#else
-				cpHastySpaceStep(_cpSpace, dt);
-#endif
-			}
+                stepSpace(dt);
+            }
         }
         else
         {
@@ -933,12 +1478,8 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
                 const float dt = _updateTime * _speed / _substeps;
                 for (int i = 0; i < _substeps; ++i)
                 {
-#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
-					cpSpaceStep(_cpSpace, dt);
-#else
-					cpHastySpaceStep(_cpSpace, dt);
-#endif 
-					for (auto& body : _bodies)
+                    stepSpace(dt);
+                    for (auto& body : _bodies)
                     {
                         body->update(dt);
                     }
@@ -961,6 +1502,531 @@ void PhysicsWorld::update(float delta, bool userCall/* = false*/)
     if(_postUpdateCallback) _postUpdateCallback(); //fix #11154
 }
 
+void PhysicsWorld::getSnapshotShapes(std::vector<cpShape*>& shapes) const
+{
+    for (auto body : _bodies)
+    {
+        for (auto shape : body->getShapes())
+        {
+            shapes.insert(shapes.end(), shape->_cpShapes.begin(), shape->_cpShapes.end());
+        }
+    }
+}
+
+void PhysicsWorld::getSnapshotConstraints(std::vector<cpConstraint*>& constraints) const
+{
+    for (auto joint : _joints)
+    {
+        constraints.insert(constraints.end(), joint->_cpConstraints.begin(), joint->_cpConstraints.end());
+    }
+}
+
+Data PhysicsWorld::saveSnapshot()
+{
+    CCASSERT(!isSpaceLocked(), "can not take a snapshot while the world is stepping or delivering contacts");
+    
+    Data data;
+    if (isSpaceLocked())
+    {
+        return data;
+    }
+    
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+    if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
+    {
+        updateJoints();
+    }
+    
+    std::vector<cpShape*> shapes;
+    getSnapshotShapes(shapes);
+    std::vector<cpConstraint*> constraints;
+    getSnapshotConstraints(constraints);
+    std::unordered_map<const cpShape*, uint32_t> shapeIds;
+    shapeIds.reserve(shapes.size());
+    for (uint32_t i = 0; i < (uint32_t)shapes.size(); ++i)
+    {
+        shapeIds[shapes[i]] = i;
+    }
+    
+    // the touching contacts, sorted by their shapes so that the snapshot does not depend on addresses
+    typedef std::pair<ArbiterSnapshot, cpArbiter*> ArbiterEntry;
+    std::vector<ArbiterEntry> arbiters;
+    uint32_t contactCount = 0;
+    for (auto arb : _touchingArbiters)
+    {
+        auto a = shapeIds.find(arb->a);
+        auto b = shapeIds.find(arb->b);
+        if (a == shapeIds.end() || b == shapeIds.end())
+        {
+            continue;
+        }
+        
+        auto contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+        ArbiterSnapshot snapshot = {
+            a->second, b->second, (uint32_t)arb->count,
+            (arb->state != CP_ARBITER_STATE_IGNORE ? ARBITER_ACCEPTED : 0u)
+                | (contact->isNotificationEnabled() ? ARBITER_NOTIFIED : 0u)
+        };
+        arbiters.push_back(std::make_pair(snapshot, arb));
+        contactCount += snapshot.contactCount;
+    }
+    std::sort(arbiters.begin(), arbiters.end(), [](const ArbiterEntry& a, const ArbiterEntry& b) {
+        return a.first.shapeA != b.first.shapeA ? a.first.shapeA < b.first.shapeA : a.first.shapeB < b.first.shapeB;
+    });
+    
+    SnapshotHeader header;
+    memcpy(header.magic, PHYSICS_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = PHYSICS_SNAPSHOT_VERSION;
+    header.bodyCount = (uint32_t)_bodies.size();
+    header.shapeCount = (uint32_t)shapes.size();
+    header.constraintCount = (uint32_t)constraints.size();
+    header.arbiterCount = (uint32_t)arbiters.size();
+    header.contactCount = contactCount;
+    header.updateRateCount = _updateRateCount;
+    header.updateTime = _updateTime;
+    header.stepDelta = _cpSpace->curr_dt;
+    
+    ssize_t size = sizeof(header)
+        + header.bodyCount * sizeof(BodySnapshot)
+        + header.constraintCount * sizeof(ConstraintSnapshot)
+        + header.arbiterCount * sizeof(ArbiterSnapshot)
+        + header.contactCount * (sizeof(uint64_t) + 2 * sizeof(double));
+    auto bytes = (unsigned char*)malloc(size);
+    if (bytes == nullptr)
+    {
+        return data;
+    }
+    
+    auto dest = bytes;
+    memcpy(dest, &header, sizeof(header));
+    dest += sizeof(header);
+    for (auto body : _bodies)
+    {
+        cpBody* cpBody = body->_cpBody;
+        BodySnapshot snapshot = {
+            cpBody->p.x, cpBody->p.y, cpBody->a,
+            cpBody->v.x, cpBody->v.y, cpBody->w,
+            cpBody->v_bias.x, cpBody->v_bias.y, cpBody->w_bias,
+            cpBody->f.x, cpBody->f.y, cpBody->t,
+            cpBody->sleeping.idleTime
+        };
+        memcpy(dest, &snapshot, sizeof(snapshot));
+        dest += sizeof(snapshot);
+    }
+    for (auto constraint : constraints)
+    {
+        ConstraintSnapshot snapshot = { { 0.0, 0.0 } };
+        cpFloat* state[2];
+        int count = getConstraintState(constraint, state);
+        for (int i = 0; i < count; ++i)
+        {
+            snapshot.state[i] = *state[i];
+        }
+        memcpy(dest, &snapshot, sizeof(snapshot));
+        dest += sizeof(snapshot);
+    }
+    for (auto& arbiter : arbiters)
+    {
+        memcpy(dest, &arbiter.first, sizeof(ArbiterSnapshot));
+        dest += sizeof(ArbiterSnapshot);
+    }
+    auto impulseDest = dest + contactCount * sizeof(uint64_t);
+    for (auto& arbiter : arbiters)
+    {
+        cpArbiter* arb = arbiter.second;
+        for (int i = 0; i < arb->count; ++i)
+        {
+            uint64_t hash = arb->contacts[i].hash;
+            double impulses[2] = { arb->contacts[i].jnAcc, arb->contacts[i].jtAcc };
+            memcpy(dest, &hash, sizeof(hash));
+            memcpy(impulseDest, impulses, sizeof(impulses));
+            dest += sizeof(hash);
+            impulseDest += sizeof(impulses);
+        }
+    }
+    
+    data.fastSet(bytes, size);
+    
+    // continue from the same rebuilt space as a resimulation from this snapshot does
+    restoreSnapshot(data);
+    
+    return data;
+}
+
+bool PhysicsWorld::restoreSnapshot(const Data& snapshot)
+{
+    CCASSERT(!isSpaceLocked(), "can not restore a snapshot while the world is stepping or delivering contacts");
+    if (isSpaceLocked())
+    {
+        return false;
+    }
+    
+    if (!_delayAddBodies.empty() || !_delayRemoveBodies.empty())
+    {
+        updateBodies();
+    }
+    if (!_delayAddJoints.empty() || !_delayRemoveJoints.empty())
+    {
+        updateJoints();
+    }
+    
+    SnapshotHeader header;
+    if (snapshot.getSize() < (ssize_t)sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, snapshot.getBytes(), sizeof(header));
+    
+    std::vector<cpShape*> shapes;
+    getSnapshotShapes(shapes);
+    std::vector<cpConstraint*> constraints;
+    getSnapshotConstraints(constraints);
+    
+    ssize_t size = sizeof(header)
+        + header.bodyCount * sizeof(BodySnapshot)
+        + header.constraintCount * sizeof(ConstraintSnapshot)
+        + header.arbiterCount * sizeof(ArbiterSnapshot)
+        + header.contactCount * (sizeof(uint64_t) + 2 * sizeof(double));
+    if (memcmp(header.magic, PHYSICS_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.version != PHYSICS_SNAPSHOT_VERSION
+        || header.bodyCount != (uint32_t)_bodies.size()
+        || header.shapeCount != (uint32_t)shapes.size()
+        || header.constraintCount != (uint32_t)constraints.size()
+        || snapshot.getSize() != size)
+    {
+        CCLOG("PhysicsWorld::restoreSnapshot: the snapshot does not match this world");
+        return false;
+    }
+    
+    auto bodySrc = snapshot.getBytes() + sizeof(header);
+    auto constraintSrc = bodySrc + header.bodyCount * sizeof(BodySnapshot);
+    auto arbiterSrc = constraintSrc + header.constraintCount * sizeof(ConstraintSnapshot);
+    auto hashSrc = arbiterSrc + header.arbiterCount * sizeof(ArbiterSnapshot);
+    auto impulseSrc = hashSrc + header.contactCount * sizeof(uint64_t);
+    
+    // validate the arbiters before touching the world
+    uint32_t contactCount = 0;
+    for (uint32_t i = 0; i < header.arbiterCount; ++i)
+    {
+        ArbiterSnapshot arbiter;
+        memcpy(&arbiter, arbiterSrc + i * sizeof(ArbiterSnapshot), sizeof(arbiter));
+        if (arbiter.shapeA >= header.shapeCount || arbiter.shapeB >= header.shapeCount)
+        {
+            return false;
+        }
+        contactCount += arbiter.contactCount;
+    }
+    if (contactCount != header.contactCount)
+    {
+        return false;
+    }
+    
+    // sleeping bodies keep their shapes in the static index and their contacts out of the cache,
+    // they fall asleep again during the next step
+    for (auto body : _bodies)
+    {
+        if (cpBodyIsSleeping(body->_cpBody))
+        {
+            cpBodyActivate(body->_cpBody);
+        }
+    }
+    
+    int dynamicBodyCount = 0;
+    int staticBodyCount = 0;
+    for (auto body : _bodies)
+    {
+        if (!cpSpaceContainsBody(_cpSpace, body->_cpBody))
+        {
+            continue;
+        }
+        if (cpBodyGetType(body->_cpBody) == CP_BODY_TYPE_STATIC)
+        {
+            ++staticBodyCount;
+        }
+        else
+        {
+            ++dynamicBodyCount;
+        }
+    }
+    int shapeCount = 0;
+    for (auto shape : shapes)
+    {
+        shapeCount += cpSpaceContainsShape(_cpSpace, shape) ? 1 : 0;
+    }
+    if (dynamicBodyCount != _cpSpace->dynamicBodies->num || staticBodyCount != _cpSpace->staticBodies->num
+        || shapeCount != cpSpatialIndexCount(_cpSpace->staticShapes) + cpSpatialIndexCount(_cpSpace->dynamicShapes))
+    {
+        CCASSERT(false, "the space holds bodies or shapes which do not belong to the physics world");
+        return false;
+    }
+    
+    std::map<std::pair<const cpShape*, const cpShape*>, ResumedContact> resumedContacts;
+    for (uint32_t i = 0; i < header.arbiterCount; ++i)
+    {
+        ArbiterSnapshot arbiter;
+        memcpy(&arbiter, arbiterSrc, sizeof(arbiter));
+        arbiterSrc += sizeof(arbiter);
+        
+        auto& resumed = resumedContacts[std::make_pair(shapes[arbiter.shapeA], shapes[arbiter.shapeB])];
+        resumed.accepted = (arbiter.flags & ARBITER_ACCEPTED) != 0;
+        resumed.notificationEnabled = (arbiter.flags & ARBITER_NOTIFIED) != 0;
+        resumed.impulses.resize(arbiter.contactCount);
+        for (auto& impulse : resumed.impulses)
+        {
+            memcpy(&impulse.hash, hashSrc, sizeof(uint64_t));
+            memcpy(&impulse.normalImpulse, impulseSrc, sizeof(double));
+            memcpy(&impulse.tangentImpulse, impulseSrc + sizeof(double), sizeof(double));
+            hashSrc += sizeof(uint64_t);
+            impulseSrc += 2 * sizeof(double);
+        }
+    }
+    
+    // the contacts touching now go away with the cache, those missing from the snapshot separate
+    std::vector<PhysicsContact*> endedContacts;
+    for (auto arb : _touchingArbiters)
+    {
+        auto contact = static_cast<PhysicsContact*>(cpArbiterGetUserData(arb));
+        contact->_contactInfo = nullptr;
+        endedContacts.push_back(contact);
+        if (!contact->isNotificationEnabled() || findContactPair(resumedContacts, arb->a, arb->b) != resumedContacts.end())
+        {
+            contact->setNotificationEnable(false);
+        }
+    }
+    _touchingArbiters.clear();
+    
+    // rebuild the space in the order of the world, so that its broadphase, contact cache and solver order
+    // no longer depend on the history of the simulation
+    std::vector<cpConstraint*> addedConstraints;
+    for (auto constraint : constraints)
+    {
+        if (cpSpaceContainsConstraint(_cpSpace, constraint))
+        {
+            cpSpaceRemoveConstraint(_cpSpace, constraint);
+            addedConstraints.push_back(constraint);
+        }
+    }
+    
+    cpSpace* fresh = cpSpaceNew();
+    if (_usingSpatialHash)
+    {
+        cpSpaceUseSpatialHash(fresh, _spatialHashCellSize, _spatialHashCount);
+    }
+    std::swap(_cpSpace->staticShapes, fresh->staticShapes);
+    std::swap(_cpSpace->dynamicShapes, fresh->dynamicShapes);
+    std::swap(_cpSpace->cachedArbiters, fresh->cachedArbiters);
+    std::swap(_cpSpace->arbiters, fresh->arbiters);
+    std::swap(_cpSpace->pooledArbiters, fresh->pooledArbiters);
+    std::swap(_cpSpace->allocatedBuffers, fresh->allocatedBuffers);
+    std::swap(_cpSpace->contactBuffersHead, fresh->contactBuffersHead);
+    cpSpaceFree(fresh);
+    _cpSpace->staticBody->arbiterList = nullptr;
+    
+    dynamicBodyCount = 0;
+    staticBodyCount = 0;
+    for (auto body : _bodies)
+    {
+        cpBody* cpBody = body->_cpBody;
+        if (cpSpaceContainsBody(_cpSpace, cpBody))
+        {
+            cpBody->arbiterList = nullptr;
+            if (cpBodyGetType(cpBody) == CP_BODY_TYPE_STATIC)
+            {
+                _cpSpace->staticBodies->arr[staticBodyCount++] = cpBody;
+            }
+            else
+            {
+                _cpSpace->dynamicBodies->arr[dynamicBodyCount++] = cpBody;
+            }
+        }
+    }
+    
+    // adding a constraint wakes its bodies, so the joints come back before the idle times
+    for (auto constraint : constraints)
+    {
+        ConstraintSnapshot state;
+        memcpy(&state, constraintSrc, sizeof(state));
+        constraintSrc += sizeof(state);
+        
+        cpFloat* values[2];
+        int count = getConstraintState(constraint, values);
+        for (int i = 0; i < count; ++i)
+        {
+            *values[i] = state.state[i];
+        }
+    }
+    for (auto constraint : addedConstraints)
+    {
+        cpSpaceAddConstraint(_cpSpace, constraint);
+    }
+    
+    for (auto body : _bodies)
+    {
+        BodySnapshot state;
+        memcpy(&state, bodySrc, sizeof(state));
+        bodySrc += sizeof(state);
+        
+        cpBody* cpBody = body->_cpBody;
+        if (cpBodyGetType(cpBody) == CP_BODY_TYPE_STATIC)
+        {
+            continue;
+        }
+        
+        // the position first, setting the angle updates the transform from both
+        cpBody->p = cpv(state.positionX, state.positionY);
+        cpBodySetAngle(cpBody, state.angle);
+        cpBody->v = cpv(state.velocityX, state.velocityY);
+        cpBody->w = state.angularVelocity;
+        cpBody->v_bias = cpv(state.velocityBiasX, state.velocityBiasY);
+        cpBody->w_bias = state.angularVelocityBias;
+        cpBody->f = cpv(state.forceX, state.forceY);
+        cpBody->t = state.torque;
+        cpBody->sleeping.idleTime = state.idleTime;
+    }
+    
+    _cpSpace->shapeIDCounter = 0;
+    for (auto shape : shapes)
+    {
+        if (shape->space == _cpSpace)
+        {
+            shape->hashid = _cpSpace->shapeIDCounter++;
+            cpShapeUpdate(shape, shape->body->transform);
+            bool isStatic = cpBodyGetType(shape->body) == CP_BODY_TYPE_STATIC;
+            cpSpatialIndexInsert(isStatic ? _cpSpace->staticShapes : _cpSpace->dynamicShapes, shape, shape->hashid);
+        }
+    }
+    
+    _cpSpace->curr_dt = header.stepDelta;
+    _updateTime = header.updateTime;
+    _updateRateCount = header.updateRateCount;
+    _resumedContacts.swap(resumedContacts);
+    
+    // listeners removing bodies are delayed like during the delivery of buffered contacts
+    _dispatchingContacts = true;
+    for (auto contact : endedContacts)
+    {
+        collisionSeparateCallback(*contact);
+    }
+    _dispatchingContacts = false;
+    for (auto contact : endedContacts)
+    {
+        if (_contactRecords.empty())
+        {
+            delete contact;
+        }
+        else
+        {
+            _separatedContacts.push_back(contact);
+        }
+    }
+    
+    // move the nodes, otherwise the next update would move the bodies back
+    afterSimulation(_scene, _scene->getNodeToParentTransform(), 0.f);
+    
+    return true;
+}
+
+bool PhysicsWorld::resumeContact(cpArbiter* arb, bool& accepted)
+{
+    auto it = findContactPair(_resumedContacts, arb->a, arb->b);
+    if (it == _resumedContacts.end())
+    {
+        return false;
+    }
+    
+    auto& resumed = it->second;
+    for (int i = 0; i < arb->count; ++i)
+    {
+        for (auto& impulse : resumed.impulses)
+        {
+            if (impulse.hash == (uint64_t)arb->contacts[i].hash)
+            {
+                arb->contacts[i].jnAcc = impulse.normalImpulse;
+                arb->contacts[i].jtAcc = impulse.tangentImpulse;
+                break;
+            }
+        }
+    }
+    static_cast<PhysicsContact*>(cpArbiterGetUserData(arb))->setNotificationEnable(resumed.notificationEnabled);
+    
+    accepted = resumed.accepted;
+    if (accepted)
+    {
+        // Chipmunk does not warm start a first collision
+        arb->state = CP_ARBITER_STATE_NORMAL;
+    }
+    _resumedContacts.erase(it);
+    return true;
+}
+
+void PhysicsWorld::endResumedContacts(const cpShape* shape)
+{
+    for (auto it = _resumedContacts.begin(); it != _resumedContacts.end();)
+    {
+        if (shape != nullptr && it->first.first != shape && it->first.second != shape)
+        {
+            ++it;
+            continue;
+        }
+        
+        if (it->second.notificationEnabled)
+        {
+            auto contact = PhysicsContact::construct(static_cast<PhysicsShape*>(cpShapeGetUserData(it->first.first)),
+                                                     static_cast<PhysicsShape*>(cpShapeGetUserData(it->first.second)));
+            collisionSeparateCallback(*contact);
+            if (_bufferingStep || !_contactRecords.empty())
+            {
+                _separatedContacts.push_back(contact);
+            }
+            else
+            {
+                delete contact;
+            }
+        }
+        it = _resumedContacts.erase(it);
+    }
+}
+
+void PhysicsWorld::stepSpace(float dt)
+{
+    _stepThreadId = std::this_thread::get_id();
+    _bufferingStep = _contactBuffering;
+    _contactRecords.clear();
+    deleteSeparatedContacts();
+    
+    if (_resetStepStatistics)
+    {
+        _resetStepStatistics = false;
+        _statisticsSteps = 0;
+        _statisticsStepTime = 0.0f;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+#if CC_TARGET_PLATFORM == CC_PLATFORM_WINRT || CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    cpSpaceStep(_cpSpace, dt);
+#else
+    cpHastySpaceStep(_cpSpace, dt);
+#endif
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    
+    // contacts of a rebuilt space which were not found again have separated
+    if (!_resumedContacts.empty())
+    {
+        endResumedContacts(nullptr);
+    }
+    ++_statisticsSteps;
+    _statisticsStepTime += elapsed.count() / 1000.0f;
+    
+    if (_bufferingStep)
+    {
+        _bufferingStep = false;
+        dispatchContactRecords();
+    }
+}
+
 PhysicsWorld* PhysicsWorld::construct(Scene* scene)
 {
     PhysicsWorld * world = new (std::nothrow) PhysicsWorld();
@@ -990,6 +2056,15 @@ PhysicsWorld::PhysicsWorld()
 , _debugDraw(nullptr)
 , _debugDrawMask(DEBUGDRAW_NONE)
 , _eventDispatcher(nullptr)
+, _usingSpatialHash(false)
+, _spatialHashCellSize(0.0f)
+, _spatialHashCount(0)
+, _resetStepStatistics(true)
+, _statisticsSteps(0)
+, _statisticsStepTime(0.0f)
+, _contactBuffering(false)
+, _bufferingStep(false)
+, _dispatchingContacts(false)
 {
     
 }
@@ -1007,6 +2082,8 @@ PhysicsWorld::~PhysicsWorld()
 #endif 
     }
     CC_SAFE_RELEASE_NULL(_debugDraw);
+    
+    deleteSeparatedContacts();
 }
 
 void PhysicsWorld::beforeSimulation(Node *node, const Mat4& parentToWorldTransform, float nodeParentScaleX, float nodeParentScaleY, float parentRotation)
@@ -30,11 +30,19 @@
 #if CC_USE_PHYSICS
 
 #include <list>
+#include <map>
+#include <thread>
+#include <unordered_set>
+#include "base/CCData.h"
 #include "base/CCVector.h"
 #include "math/CCGeometry.h"
 #include "physics/CCPhysicsBody.h"
+#include "physics/CCPhysicsContact.h"
 
 struct cpSpace;
+struct cpShape;
+struct cpArbiter;
+struct cpConstraint;
 
 NS_CC_BEGIN
 
@@ -53,6 +61,23 @@ class EventDispatcher;
 
 class PhysicsWorld;
 
+/**
+ * @brief Statistics of a physics world, returned by PhysicsWorld::getStatistics().
+ */
+struct CC_DLL PhysicsWorldStatistics
+{
+    /** Number of dynamic bodies that are awake. */
+    int activeBodies;
+    /** Number of dynamic bodies that are sleeping. */
+    int sleepingBodies;
+    /** Number of colliding shape pairs found by the broadphase and narrowphase in the last step. */
+    int contactPairs;
+    /** Number of steps taken during the last update that stepped the world. */
+    int steps;
+    /** Time spent stepping the space during those steps, in milliseconds. */
+    float stepTime;
+};
+
 typedef struct PhysicsRayCastInfo
 {
     PhysicsShape* shape;
@@ -85,6 +110,27 @@ typedef std::function<bool(PhysicsWorld& world, const PhysicsRayCastInfo& info,
 typedef std::function<bool(PhysicsWorld&, PhysicsShape&, void*)> PhysicsQueryRectCallbackFunc;
 typedef PhysicsQueryRectCallbackFunc PhysicsQueryPointCallbackFunc;
 
+/** A ray of a batched ray cast, see PhysicsWorld::rayCastBatch(). */
+struct CC_DLL PhysicsRay
+{
+    Vec2 start;
+    Vec2 end;
+};
+
+/** A hit reported by the batched queries of PhysicsWorld. */
+struct CC_DLL PhysicsQueryHit
+{
+    /** Index of the ray, rect or point in the batch. */
+    int queryIndex;
+    PhysicsShape* shape;
+    /** Ray casts: the point of intersection. Point queries: the closest point on the shape surface. */
+    Vec2 point;
+    /** Ray casts: the surface normal at the point of intersection. */
+    Vec2 normal;
+    /** Ray casts: the position of the intersection along the ray, from 0 to 1. */
+    float fraction;
+};
+
 /**
  * @addtogroup physics
  * @{
@@ -188,6 +234,48 @@ public:
     * @param   data   User defined data, it is passed to func. 
     */
     void queryPoint(PhysicsQueryPointCallbackFunc func, const Vec2& point, void* data);
+
+    /**
+     * Casts a batch of rays.
+     *
+     * Hits are appended to hits, grouped by ray in the order of rays, and sorted by fraction within a ray.
+     * No callback is involved, and the spatial index is walked directly, so hundreds of probes per frame stay cheap.
+     * With parallel set, the rays are split across the JobSystem workers; this is ignored when the broadphase
+     * is a spatial hash, whose queries are not thread safe.
+     * @param rays The rays to cast.
+     * @param hits The array receiving the hits. It is not cleared.
+     * @param allHits If false, only the closest hit of each ray is reported.
+     * @param categoryMask Only shapes whose category bitmask intersects this mask are reported.
+     * @param parallel Whether to run the queries on the JobSystem workers.
+     */
+    void rayCastBatch(const std::vector<PhysicsRay>& rays, std::vector<PhysicsQueryHit>& hits,
+                      bool allHits = false, int categoryMask = -1, bool parallel = false);
+
+    /**
+     * Searches for the shapes whose bounding box overlaps each rect of a batch.
+     *
+     * Works like rayCastBatch(); when allHits is false, at most one shape is reported per rect.
+     * @param rects The rects to query.
+     * @param hits The array receiving the hits. It is not cleared.
+     * @param allHits If false, the query of a rect stops at the first shape found.
+     * @param categoryMask Only shapes whose category bitmask intersects this mask are reported.
+     * @param parallel Whether to run the queries on the JobSystem workers.
+     */
+    void queryRectBatch(const std::vector<Rect>& rects, std::vector<PhysicsQueryHit>& hits,
+                        bool allHits = true, int categoryMask = -1, bool parallel = false);
+
+    /**
+     * Searches for the shapes containing each point of a batch.
+     *
+     * Works like rayCastBatch(); when allHits is false, at most one shape is reported per point.
+     * @param points The points to query.
+     * @param hits The array receiving the hits. It is not cleared.
+     * @param allHits If false, the query of a point stops at the first shape found.
+     * @param categoryMask Only shapes whose category bitmask intersects this mask are reported.
+     * @param parallel Whether to run the queries on the JobSystem workers.
+     */
+    void queryPointBatch(const std::vector<Vec2>& points, std::vector<PhysicsQueryHit>& hits,
+                         bool allHits = true, int categoryMask = -1, bool parallel = false);
     
     /**
     * Get physics shapes that contains the point. 
@@ -302,6 +390,140 @@ public:
     /** get the number of substeps */
     int getFixedUpdateRate() const { return _fixedRate; }
 
+    /**
+     * Set the number of threads the Chipmunk solver uses while stepping.
+     *
+     * Only the impulse solver is spread over the threads. Collision detection and the contact callbacks still run
+     * on the thread stepping the world, in the same order as with one thread. Chipmunk uses at most 2 threads, and
+     * results are no longer bit-exact between runs with more than one thread.
+     * Not supported on Win32 and WinRT, which use a plain cpSpace.
+     * @param count The number of threads, 0 (the default) lets Chipmunk decide: automatic on iOS and Mac, 1 elsewhere.
+     */
+    void setSolverThreadCount(int count);
+
+    /**
+     * Get the number of threads the Chipmunk solver is using.
+     *
+     * @return An integer number.
+     */
+    int getSolverThreadCount() const;
+
+    /**
+     * Enable or disable buffered contact delivery.
+     *
+     * When enabled, the contact callbacks no longer dispatch an event from inside the solver. Contacts that pass
+     * the bitmask test are recorded into a flat array during the step, and delivered to the contact listeners in
+     * one batch once the step has finished, the listeners being looked up only once per step. Listeners added
+     * during the batch receive the contacts of later steps. Bodies and joints removed by a listener are removed
+     * after the batch.
+     * Pre-solve events are not delivered in this mode, and the value returned by onContactBegin is ignored, since
+     * the solver has already run; use the collision bitmasks and groups to filter collisions instead.
+     * @param enabled A bool object, default value is false.
+     */
+    void setContactBufferingEnabled(bool enabled) { _contactBuffering = enabled; }
+
+    /**
+     * Whether buffered contact delivery is enabled.
+     *
+     * @return A bool object.
+     */
+    bool isContactBufferingEnabled() const { return _contactBuffering; }
+
+    /**
+     * Get the contacts recorded during the last step.
+     *
+     * Only filled when contact buffering is enabled. Code that only needs aggregate data, like the number of
+     * contacts or the total impulse, can walk this array after the step instead of registering a listener.
+     * @return The records of the last step, valid until the next step.
+     */
+    const std::vector<PhysicsContactRecord>& getContactRecords() const { return _contactRecords; }
+
+    /**
+     * Set the time a group of bodies must stay idle before it falls asleep.
+     *
+     * Sleeping bodies are not simulated until something touches them or they are moved, which saves most of the
+     * cost of large, mostly static worlds.
+     * @param seconds A float number, default value is infinity, which disables sleeping.
+     */
+    void setSleepTimeThreshold(float seconds);
+
+    /**
+     * Get the time a group of bodies must stay idle before it falls asleep.
+     *
+     * @return A float number.
+     */
+    float getSleepTimeThreshold() const;
+
+    /**
+     * Set the speed below which a body is considered idle.
+     *
+     * @param speed A float number, default value is 0, which derives the threshold from the gravity.
+     */
+    void setIdleSpeedThreshold(float speed);
+
+    /**
+     * Get the speed below which a body is considered idle.
+     *
+     * @return A float number.
+     */
+    float getIdleSpeedThreshold() const;
+
+    /**
+     * Set the number of solver iterations per step.
+     *
+     * Fewer iterations are cheaper but make stacks and joints softer.
+     * @param iterations An integer number, default value is 10.
+     */
+    void setIterations(int iterations);
+
+    /**
+     * Get the number of solver iterations per step.
+     *
+     * @return An integer number.
+     */
+    int getIterations() const;
+
+    /**
+     * Set the amount of overlap allowed between shapes.
+     *
+     * A little overlap keeps contacts persistent and reduces jitter.
+     * @param slop A float number, default value is 0.1.
+     */
+    void setCollisionSlop(float slop);
+
+    /**
+     * Get the amount of overlap allowed between shapes.
+     *
+     * @return A float number.
+     */
+    float getCollisionSlop() const;
+
+    /**
+     * Switch the broadphase from the default bounding box tree to a spatial hash.
+     *
+     * A spatial hash can be faster for many shapes of roughly the same size, such as tiles or particles.
+     * Calling it again rebuilds the hash with the new parameters. It can not be called while the world is stepping.
+     * @param cellSize The size of a hash cell, close to the size of the typical shape.
+     * @param count The minimal number of cells, at least about 10 times the number of shapes.
+     */
+    void useSpatialHash(float cellSize, int count);
+
+    /**
+     * Whether the broadphase is a spatial hash.
+     *
+     * @return A bool object.
+     */
+    bool isUsingSpatialHash() const { return _usingSpatialHash; }
+
+    /**
+     * Get the statistics of this physics world.
+     *
+     * Body counts and contact pairs reflect the current state; steps and step time cover the last update
+     * that stepped the world.
+     * @return A PhysicsWorldStatistics object.
+     */
+    PhysicsWorldStatistics getStatistics() const;
+
     /**
     * Set the debug draw mask of this physics world.
     * 
@@ -352,6 +574,41 @@ public:
      * @param   delta   A float number.
      */
     void step(float delta);
+
+    /**
+     * Capture the simulation state of this physics world into a compact binary snapshot.
+     *
+     * The snapshot holds the position, angle, velocities, forces and idle time of every body, the accumulated
+     * impulses of the joints and of the touching contacts, which Chipmunk uses to warm start the solver, and the
+     * time accumulated by update(). Bodies, shapes and joints themselves are not part of it: restoreSnapshot()
+     * only works on a world holding the same bodies, shapes and joints, added in the same order.
+     *
+     * Saving rebuilds the broadphase and the contact cache of the space in the order of the world, as restoring
+     * does, so that the run continuing from here and any later resimulation from the snapshot start from the
+     * same state. This costs about as much as adding every shape again, and the warm start of the contacts which
+     * separated during the last steps is lost.
+     * @attention Can not be called while the world is stepping or delivering buffered contacts.
+     * @return The snapshot, or an empty Data object on failure.
+     */
+    Data saveSnapshot();
+
+    /**
+     * Restore a snapshot taken by saveSnapshot().
+     *
+     * Stepping with the same time steps and the same inputs then reproduces the simulation which followed
+     * saveSnapshot() bit for bit, including the order of the contact events, provided that the solver runs on a
+     * single thread (see setSolverThreadCount()) and the binary is the same. The nodes owning the bodies are
+     * moved to the restored positions.
+     *
+     * Contacts touching in the snapshot continue during the next step without a new begin event, and separate
+     * in that step if their shapes no longer touch. Contacts touching now which are not in the snapshot separate
+     * during the restore. Bodies sleeping in the snapshot are awake after it and fall asleep again during the
+     * next step.
+     * @attention Can not be called while the world is stepping or delivering buffered contacts.
+     * @param snapshot A snapshot returned by saveSnapshot().
+     * @return False if the snapshot is invalid or does not match the bodies of this world.
+     */
+    bool restoreSnapshot(const Data& snapshot);
     
 protected:
     static PhysicsWorld* construct(Scene* scene);
@@ -377,6 +634,17 @@ protected:
     virtual void removeBodyOrDelay(PhysicsBody* body);
     virtual void updateBodies();
     virtual void updateJoints();
+    void stepSpace(float dt);
+    void getSnapshotShapes(std::vector<cpShape*>& shapes) const;
+    void getSnapshotConstraints(std::vector<cpConstraint*>& constraints) const;
+    bool resumeContact(cpArbiter* arb, bool& accepted);
+    void endResumedContacts(const cpShape* shape);
+    void runBatchQuery(int count, std::vector<PhysicsQueryHit>& hits, bool parallel,
+                       const std::function<void(int, std::vector<PhysicsQueryHit>&)>& query);
+    void recordContact(PhysicsContact& contact, PhysicsContact::EventCode eventCode);
+    void dispatchContactRecords();
+    void deleteSeparatedContacts();
+    bool isSpaceLocked() const;
 
 protected:
     Vec2 _gravity;
@@ -398,6 +666,36 @@ protected:
     int _debugDrawMask;
     
     EventDispatcher* _eventDispatcher;
+    std::thread::id _stepThreadId;
+
+    bool _usingSpatialHash;
+    float _spatialHashCellSize;
+    int _spatialHashCount;
+    bool _resetStepStatistics;
+    int _statisticsSteps;
+    float _statisticsStepTime;
+
+    bool _contactBuffering;
+    bool _bufferingStep;
+    bool _dispatchingContacts;  // bodies and joints are removed after the buffered contacts have been delivered
+    std::vector<PhysicsContactRecord> _contactRecords;
+    std::vector<PhysicsContact*> _separatedContacts;   // referenced by the records until the next step
+
+    struct ContactImpulse
+    {
+        uint64_t hash;
+        double normalImpulse;
+        double tangentImpulse;
+    };
+    struct ResumedContact
+    {
+        bool accepted;
+        bool notificationEnabled;
+        std::vector<ContactImpulse> impulses;
+    };
+    std::unordered_set<cpArbiter*> _touchingArbiters;  // between the begin and the separate callbacks
+    // contacts touching when the space was rebuilt for a snapshot, continued without a begin event in the next step
+    std::map<std::pair<const cpShape*, const cpShape*>, ResumedContact> _resumedContacts;
 
     Vector<PhysicsBody*> _delayAddBodies;
     Vector<PhysicsBody*> _delayRemoveBodies;
@@ -271,7 +271,7 @@ public:
             if (SAX_ARRAY == curState)
             {
                 if (sName == "string")
-                    _curArray->push_back(Value(_curValue));
+                    _curArray->push_back(Value(std::move(_curValue)));
                 else if (sName == "integer")
                     _curArray->push_back(Value(atoi(_curValue.c_str())));
                 else
@@ -280,7 +280,7 @@ public:
             else if (SAX_DICT == curState)
             {
                 if (sName == "string")
-                    (*_curDict)[_curKey] = Value(_curValue);
+                    (*_curDict)[_curKey] = Value(std::move(_curValue));
                 else if (sName == "integer")
                     (*_curDict)[_curKey] = Value(atoi(_curValue.c_str()));
                 else
@@ -396,6 +396,11 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        // The file may have been looked up before it existed
+        clearFullPathCache(true);
+    }
 
     delete doc;
     return ret;
@@ -436,6 +441,11 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+    {
+        // The file may have been looked up before it existed
+        clearFullPathCache(true);
+    }
 
     delete doc;
     return ret;
@@ -599,6 +609,9 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath) c
 
         fclose(fp);
 
+        // The file may have been looked up before it existed
+        clearFullPathCache(true);
+
         return true;
     } while (0);
 
@@ -623,10 +636,41 @@ bool FileUtils::init()
 void FileUtils::purgeCachedEntries()
 {
     DECLARE_GUARD;
-    _fullPathCache.clear();
+    clearFullPathCache();
     _fullPathCacheDir.clear();
 }
 
+FileUtils::FullPathCacheShard& FileUtils::getFullPathCacheShard(const std::string& filename) const
+{
+    return _fullPathCacheShards[std::hash<std::string>()(filename) % FULL_PATH_CACHE_SHARD_COUNT];
+}
+
+void FileUtils::clearFullPathCache(bool missingOnly) const
+{
+    // Hold _mutex so that a lookup running concurrently can't cache a stale result afterwards
+    DECLARE_GUARD;
+    for (auto& shard : _fullPathCacheShards)
+    {
+        std::lock_guard<std::mutex> shardGuard(shard.mutex);
+        if (!missingOnly)
+        {
+            shard.found.clear();
+        }
+        shard.missing.clear();
+    }
+}
+
+const std::unordered_map<std::string, std::string> FileUtils::getFullPathCache() const
+{
+    std::unordered_map<std::string, std::string> ret;
+    for (auto& shard : _fullPathCacheShards)
+    {
+        std::lock_guard<std::mutex> shardGuard(shard.mutex);
+        ret.insert(shard.found.begin(), shard.found.end());
+    }
+    return ret;
+}
+
 std::string FileUtils::getStringFromFile(const std::string& filename) const
 {
     std::string s;
@@ -651,6 +695,21 @@ Data FileUtils::getDataFromFile(const std::string& filename) const
     return d;
 }
 
+FileView FileUtils::getFileView(const std::string& filename) const
+{
+    std::string fullPath = fullPathForFilename(filename);
+    if (fullPath.empty())
+        return FileView();
+
+    FileView view = FileView::map(getSuitableFOpen(fullPath));
+    if (view.isNull())
+    {
+        // Packed or archived sources can't be mapped, read them in a buffer
+        view = FileView(getDataFromFile(fullPath));
+    }
+    return view;
+}
+
 void FileUtils::getDataFromFile(const std::string& filename, std::function<void(Data)> callback) const
 {
     auto fullPath = fullPathForFilename(filename);
@@ -816,9 +875,6 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
 
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
-    
-    DECLARE_GUARD;
-
     if (filename.empty())
     {
         return "";
@@ -829,13 +885,25 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    auto& shard = getFullPathCacheShard(filename);
+
+    // Already Cached ? Only the shard is locked, so that cache hits from several threads don't contend.
     {
-        return cacheIter->second;
+        std::lock_guard<std::mutex> shardGuard(shard.mutex);
+        auto cacheIter = shard.found.find(filename);
+        if (cacheIter != shard.found.end())
+        {
+            return cacheIter->second;
+        }
+        if (shard.missing.find(filename) != shard.missing.end())
+        {
+            return "";
+        }
     }
 
+    // Search paths may only change while _mutex is held, results are added to the cache under it too.
+    DECLARE_GUARD;
+
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
 
@@ -845,12 +913,20 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
     {
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
-            fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            if (!_fileIndex.empty() && isPathInDefaultResourceRoot(searchIt))
+            {
+                fullpath = getPathForFilenameInFileIndex(newFilename, resolutionIt, searchIt);
+            }
+            else
+            {
+                fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
+            }
 
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.emplace(filename, fullpath);
+                std::lock_guard<std::mutex> shardGuard(shard.mutex);
+                shard.found.emplace(filename, fullpath);
                 return fullpath;
             }
 
@@ -861,10 +937,65 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
 
+    // Files under the writable path are also created without FileUtils (downloads, unzipped archives),
+    // so a miss there can't be trusted to last.
+    const std::string writablePath = getWritablePath();
+    bool searchesWritablePath = false;
+    if (!writablePath.empty())
+    {
+        for (const auto& searchIt : _searchPathArray)
+        {
+            if (searchIt.compare(0, writablePath.length(), writablePath) == 0)
+            {
+                searchesWritablePath = true;
+                break;
+            }
+        }
+    }
+
+    if (!searchesWritablePath)
+    {
+        std::lock_guard<std::mutex> shardGuard(shard.mutex);
+        shard.missing.insert(filename);
+    }
+
     // The file wasn't found, return empty string.
     return "";
 }
 
+bool FileUtils::isPathInDefaultResourceRoot(const std::string& path) const
+{
+    return !_defaultResRootPath.empty() && path.compare(0, _defaultResRootPath.length(), _defaultResRootPath) == 0;
+}
+
+std::string FileUtils::getPathForFilenameInFileIndex(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const
+{
+    std::string file = filename;
+    std::string file_path = "";
+    size_t pos = filename.find_last_of("/");
+    if (pos != std::string::npos)
+    {
+        file_path = filename.substr(0, pos+1);
+        file = filename.substr(pos+1);
+    }
+
+    // searchPath + file_path + resourceDirectory + file, like getPathForFilename
+    std::string path = searchPath;
+    path += file_path;
+    path += resolutionDirectory;
+    if (!path.empty() && path[path.length()-1] != '/')
+    {
+        path += '/';
+    }
+    path += file;
+
+    if (_fileIndex.find(path.substr(_defaultResRootPath.length())) == _fileIndex.end())
+    {
+        return "";
+    }
+    return path;
+}
+
 
 std::string FileUtils::fullPathForDirectory(const std::string &dir) const
 {
@@ -935,7 +1066,7 @@ void FileUtils::setSearchResolutionsOrder(const std::vector<std::string>& search
 
     bool existDefault = false;
 
-    _fullPathCache.clear();
+    clearFullPathCache();
     _fullPathCacheDir.clear();
     _searchResolutionsOrderArray.clear();
     for(const auto& iter : searchResolutionsOrder)
@@ -974,6 +1105,9 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     } else {
         _searchResolutionsOrderArray.push_back(resOrder);
     }
+
+    // Files not found so far may be in the new resolution directory
+    clearFullPathCache(true);
 }
 
 const std::vector<std::string> FileUtils::getSearchResolutionsOrder() const
@@ -1011,7 +1145,7 @@ void FileUtils::setDefaultResourceRootPath(const std::string& path)
     DECLARE_GUARD;
     if (_defaultResRootPath != path)
     {
-        _fullPathCache.clear();
+        clearFullPathCache();
         _fullPathCacheDir.clear();
         _defaultResRootPath = path;
         if (!_defaultResRootPath.empty() && _defaultResRootPath[_defaultResRootPath.length()-1] != '/')
@@ -1030,7 +1164,7 @@ void FileUtils::setSearchPaths(const std::vector<std::string>& searchPaths)
     bool existDefaultRootPath = false;
     _originalSearchPaths = searchPaths;
 
-    _fullPathCache.clear();
+    clearFullPathCache();
     _fullPathCacheDir.clear();
     _searchPathArray.clear();
 
@@ -1082,12 +1216,61 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         _originalSearchPaths.push_back(searchpath);
         _searchPathArray.push_back(path);
     }
+
+    // Files not found so far may be in the new search path
+    clearFullPathCache(true);
+}
+
+void FileUtils::loadFileIndexFromFile(const std::string &filename)
+{
+    std::string content = getStringFromFile(filename);
+    if (content.empty())
+    {
+        CCLOG("cocos2d: ERROR: Can't load the file index: %s", filename.c_str());
+        return;
+    }
+
+    std::vector<std::string> files;
+    size_t start = 0;
+    while (start < content.length())
+    {
+        size_t end = content.find('\n', start);
+        if (end == std::string::npos)
+        {
+            end = content.length();
+        }
+
+        std::string line = content.substr(start, end - start);
+        if (!line.empty() && line[line.length()-1] == '\r')
+        {
+            line.pop_back();
+        }
+        if (!line.empty())
+        {
+            files.push_back(std::move(line));
+        }
+        start = end + 1;
+    }
+
+    setFileIndex(files);
+}
+
+void FileUtils::setFileIndex(const std::vector<std::string>& files)
+{
+    DECLARE_GUARD;
+    clearFullPathCache();
+    _fileIndex.clear();
+    _fileIndex.reserve(files.size());
+    for (const auto& file : files)
+    {
+        _fileIndex.insert(file.compare(0, 2, "./") == 0 ? file.substr(2) : file);
+    }
 }
 
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     DECLARE_GUARD;
-    _fullPathCache.clear();
+    clearFullPathCache();
     _fullPathCacheDir.clear();
     _filenameLookupDict = filenameLookupDict;
 }
@@ -1406,6 +1589,8 @@ bool FileUtils::createDirectory(const std::string& path) const
             closedir(dir);
         }
     }
+    // Files may have been looked up in the new directory before it existed
+    clearFullPathCache(true);
     return true;
 }
 
@@ -1453,6 +1638,7 @@ bool FileUtils::removeFile(const std::string &path) const
     if (remove(path.c_str())) {
         return false;
     } else {
+        clearFullPathCache(true);
         return true;
     }
 }
@@ -1469,6 +1655,8 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    // The new file may have been looked up before it existed
+    clearFullPathCache(true);
     return true;
 }
 
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <type_traits>
 #include <mutex>
 
@@ -36,6 +37,7 @@ THE SOFTWARE.
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
 #include "base/CCData.h"
+#include "platform/CCFileView.h"
 #include "base/CCAsyncTaskPool.h"
 #include "base/CCScheduler.h"
 #include "base/CCDirector.h"
@@ -162,6 +164,8 @@ public:
 
     /**
      *  Purges full path caches.
+     *  Call it if files were added under the search paths without using FileUtils,
+     *  since file names which were not found are cached as well.
      */
     virtual void purgeCachedEntries();
 
@@ -195,6 +199,17 @@ public:
      */
     virtual void getDataFromFile(const std::string& filename, std::function<void(Data)> callback) const;
 
+    /**
+     *  Gets a read-only view of the contents of a file, without copying them when possible.
+     *  Files on the file system are memory mapped, the others (e.g. packed in the APK on Android)
+     *  are read in a buffer owned by the view, like getDataFromFile.
+     *
+     *  @param filename The file name, it could be a relative or an absolute path.
+     *  @return A view of the file contents, a null view if the file can't be read.
+     *  @since v3.17.1
+     */
+    virtual FileView getFileView(const std::string& filename) const;
+
     enum class Status
     {
         OK = 0,
@@ -387,6 +402,30 @@ public:
      */
     virtual void setFilenameLookupDictionary(const ValueMap& filenameLookupDict);
 
+    /**
+     *  Loads the index of all the files packaged under the default resource root path.
+     *  Once an index is set, the search paths below the default resource root path are resolved
+     *  with the index instead of checking the file system, so that fullPathForFilename() does no syscalls.
+     *  The index must list every packaged file, the files missing from it are considered not found.
+     *
+     *  The index is a text file with one path per line, relative to the default resource root path.
+     *  It can be generated from the resources folder with `find . -type f | sed 's|^\./||' > files.index`.
+     *
+     *  @param filename The index file, it could be a relative or an absolute path.
+     *  @since v3.17.1
+     */
+    virtual void loadFileIndexFromFile(const std::string &filename);
+
+    /**
+     *  Sets the index of all the files packaged under the default resource root path.
+     *
+     *  @param files The paths of the packaged files, relative to the default resource root path.
+     *               An empty vector removes the index.
+     *  @see loadFileIndexFromFile
+     *  @since v3.17.1
+     */
+    virtual void setFileIndex(const std::vector<std::string>& files);
+
     /**
      *  Gets full path from a file name and the path of the relative file.
      *  @param filename The file name.
@@ -845,7 +884,7 @@ public:
     virtual void listFilesRecursivelyAsync(const std::string& dirPath, std::function<void(std::vector<std::string>)> callback) const;
 
     /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache; }
+    const std::unordered_map<std::string, std::string> getFullPathCache() const;
 
     /**
      *  Gets the new filename from the filename lookup dictionary.
@@ -908,6 +947,15 @@ protected:
      */
     virtual std::string getFullPathForFilenameWithinDirectory(const std::string& directory, const std::string& filename) const;
 
+    /** Whether a search path is below the default resource root path, and so covered by the file index. */
+    bool isPathInDefaultResourceRoot(const std::string& path) const;
+
+    /**
+     *  Gets full path for filename, resolution directory and search path from the file index.
+     *  @return The full path of the file. It will return an empty string if the file isn't in the index.
+     */
+    std::string getPathForFilenameInFileIndex(const std::string& filename, const std::string& resolutionDirectory, const std::string& searchPath) const;
+
 
     /**
      * Returns the fullpath for a given dirname.
@@ -957,10 +1005,43 @@ protected:
     std::string _defaultResRootPath;
 
     /**
-     *  The full path cache for normal files. When a file is found, it will be added into this cache.
+     *  A slice of the full path cache for normal files, guarded by its own mutex instead of _mutex,
+     *  so that threads resolving cached file names don't wait for each other.
+     */
+    struct FullPathCacheShard
+    {
+        std::mutex mutex;
+        /** When a file is found, it will be added into this cache. */
+        std::unordered_map<std::string, std::string> found;
+        /**
+         *  When a file isn't found, it will be added into this cache until the search paths change or a file
+         *  is created through FileUtils. Lookups which search the writable path are never added.
+         */
+        std::unordered_set<std::string> missing;
+    };
+
+    static const int FULL_PATH_CACHE_SHARD_COUNT = 16;
+
+    /** Returns the shard of the full path cache a file name belongs to. */
+    FullPathCacheShard& getFullPathCacheShard(const std::string& filename) const;
+
+    /**
+     *  Clears the full path cache for normal files.
+     *  @param missingOnly Whether to clear only the file names which were not found.
+     */
+    void clearFullPathCache(bool missingOnly = false) const;
+
+    /**
+     *  The full path cache for normal files.
      *  This variable is used for improving the performance of file search.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCache;
+    mutable FullPathCacheShard _fullPathCacheShards[FULL_PATH_CACHE_SHARD_COUNT];
+
+    /**
+     *  The files packaged under the default resource root path, relative to it.
+     *  When not empty, it is used instead of the file system to look up files below the default resource root path.
+     */
+    std::unordered_set<std::string> _fileIndex;
 
     /**
      *  The full path cache for directories. When a diretory is found, it will be added into this cache.
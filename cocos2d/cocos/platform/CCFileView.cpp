@@ -0,0 +1,131 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "platform/CCFileView.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CC_FILEVIEW_USE_MMAP 1
+#endif
+
+NS_CC_BEGIN
+
+FileView::FileView()
+: _bytes(nullptr)
+, _size(0)
+, _isMapped(false)
+{
+}
+
+FileView::FileView(Data&& data)
+: _bytes(nullptr)
+, _size(0)
+, _isMapped(false)
+, _data(std::move(data))
+{
+    _bytes = _data.getBytes();
+    _size = _data.getSize();
+}
+
+FileView::FileView(FileView&& other)
+: _bytes(nullptr)
+, _size(0)
+, _isMapped(false)
+{
+    move(other);
+}
+
+FileView& FileView::operator= (FileView&& other)
+{
+    if (this != &other)
+    {
+        clear();
+        move(other);
+    }
+    return *this;
+}
+
+FileView::~FileView()
+{
+    clear();
+}
+
+void FileView::move(FileView& other)
+{
+    _data = std::move(other._data);
+    _bytes = other._bytes;
+    _size = other._size;
+    _isMapped = other._isMapped;
+
+    other._bytes = nullptr;
+    other._size = 0;
+    other._isMapped = false;
+}
+
+FileView FileView::map(const std::string& fullPath)
+{
+    FileView view;
+#if CC_FILEVIEW_USE_MMAP
+    int fd = open(fullPath.c_str(), O_RDONLY);
+    if (fd == -1)
+        return view;
+
+    struct stat statBuf;
+    if (fstat(fd, &statBuf) == 0 && S_ISREG(statBuf.st_mode) && statBuf.st_size > 0)
+    {
+        void* address = mmap(nullptr, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED)
+        {
+            view._bytes = static_cast<const unsigned char*>(address);
+            view._size = statBuf.st_size;
+            view._isMapped = true;
+        }
+    }
+
+    // The mapping stays valid after closing the file
+    close(fd);
+#else
+    (void)fullPath;
+#endif
+    return view;
+}
+
+void FileView::clear()
+{
+#if CC_FILEVIEW_USE_MMAP
+    if (_isMapped)
+    {
+        munmap(const_cast<unsigned char*>(_bytes), _size);
+    }
+#endif
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+    _isMapped = false;
+}
+
+NS_CC_END
@@ -0,0 +1,101 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_FILEVIEW_H__
+#define __CC_FILEVIEW_H__
+
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * @addtogroup platform
+ * @{
+ */
+
+/**
+ * A read-only view of the whole contents of a file.
+ *
+ * When possible the file is memory mapped, so that reading it doesn't allocate nor copy anything,
+ * otherwise (e.g. files packed in the APK on Android, or Windows) it holds a buffer read with FileUtils::getDataFromFile.
+ * The contents stay valid until the view is destroyed, cleared or moved from.
+ *
+ * @see FileUtils::getFileView
+ */
+class CC_DLL FileView
+{
+public:
+    /** Creates a null view. */
+    FileView();
+
+    /** Creates a view owning a buffer read in memory. */
+    explicit FileView(Data&& data);
+
+    FileView(FileView&& other);
+    FileView& operator= (FileView&& other);
+
+    ~FileView();
+
+    /**
+     * Maps a file in memory.
+     * @param fullPath The absolute path of the file, suitable for the platform file APIs.
+     * @return The view, or a null view if the file can't be mapped.
+     */
+    static FileView map(const std::string& fullPath);
+
+    /** Gets the contents of the file, never write to them. */
+    const unsigned char* getBytes() const { return _bytes; }
+
+    /** Gets the size of the file. */
+    ssize_t getSize() const { return _size; }
+
+    /** Whether the view is empty. */
+    bool isNull() const { return _bytes == nullptr || _size == 0; }
+
+    /** Whether the contents are memory mapped rather than read in a buffer. */
+    bool isMapped() const { return _isMapped; }
+
+    /** Unmaps or frees the contents. */
+    void clear();
+
+private:
+    void move(FileView& other);
+
+    const unsigned char* _bytes;
+    ssize_t _size;
+    bool _isMapped;
+    Data _data;
+
+    CC_DISALLOW_COPY_AND_ASSIGN(FileView);
+};
+
+// end of platform group
+/// @}
+
+NS_CC_END
+
+#endif // __CC_FILEVIEW_H__
@@ -29,10 +29,17 @@ THE SOFTWARE.
 
 #include <string>
 #include <ctype.h>
+#include <mutex>
+#include <vector>
 
 #include "base/CCData.h"
 #include "base/ccConfig.h" // CC_USE_JPEG, CC_USE_TIFF, CC_USE_WEBP
 
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
+
 extern "C"
 {
     // To resolve link error when building 32bits with Xcode 6.
@@ -108,7 +115,9 @@ extern "C"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
+#include "base/ccUTF8.h"
 #include "base/ZipUtils.h"
+#include "md5/md5.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
@@ -127,6 +136,32 @@ namespace
     static const int PVR_TEXTURE_FLAG_TYPE_MASK = 0xff;
     
     static bool _PVRHaveAlphaPremultiplied = false;
+
+    static std::mutex _transcodedImageCachePathMutex;
+    static std::string _transcodedImageCachePath;
+
+    static bool isNinePatchImage(const std::string& filepath)
+    {
+        static const std::string suffix = ".9.png";
+        return filepath.size() >= suffix.size() &&
+            filepath.compare(filepath.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    static std::string getTranscodedImageCacheKey(const unsigned char* data, ssize_t dataLen)
+    {
+        md5_state_t state;
+        md5_byte_t digest[16];
+        char hexOutput[33] = { 0 };
+
+        md5_init(&state);
+        md5_append(&state, (const md5_byte_t *)data, (int)dataLen);
+        md5_finish(&state, digest);
+
+        for (int di = 0; di < 16; ++di)
+            sprintf(hexOutput + di * 2, "%02x", digest[di]);
+
+        return hexOutput;
+    }
     
     // Values taken from PVRTexture.h from http://www.imgtec.com
     enum class PVR2TextureFlag
@@ -480,6 +515,7 @@ Texture2D::PixelFormat getDevicePixelFormat(Texture2D::PixelFormat format)
 // Implement Image
 //////////////////////////////////////////////////////////////////////////
 bool Image::PNG_PREMULTIPLIED_ALPHA_ENABLED = true;
+bool Image::ETC1_TRANSCODING_ENABLED = false;
 
 Image::Image()
 : _data(nullptr)
@@ -511,7 +547,7 @@ bool Image::initWithImageFile(const std::string& path)
     bool ret = false;
     _filePath = FileUtils::getInstance()->fullPathForFilename(path);
 
-    Data data = FileUtils::getInstance()->getDataFromFile(_filePath);
+    FileView data = FileUtils::getInstance()->getFileView(_filePath);
 
     if (!data.isNull())
     {
@@ -526,7 +562,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     bool ret = false;
     _filePath = fullpath;
 
-    Data data = FileUtils::getInstance()->getDataFromFile(fullpath);
+    FileView data = FileUtils::getInstance()->getFileView(fullpath);
 
     if (!data.isNull())
     {
@@ -536,6 +572,140 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
     return ret;
 }
 
+bool Image::initWithImageFileTranscoded(const std::string& fullpath)
+{
+    if (!ETC1_TRANSCODING_ENABLED || isNinePatchImage(fullpath) || !Configuration::getInstance()->supportsETC())
+    {
+        return initWithImageFileThreadSafe(fullpath);
+    }
+
+    _filePath = fullpath;
+
+    auto fileUtils = FileUtils::getInstance();
+    FileView data = fileUtils->getFileView(fullpath);
+    if (data.isNull())
+    {
+        return false;
+    }
+
+    // transcoded before, use the cached file
+    std::string cachePath = getTranscodedImageCachePath();
+    std::string cacheFile = cachePath + getTranscodedImageCacheKey(data.getBytes(), data.getSize()) + ".etc1.pkm";
+    if (fileUtils->isFileExist(cacheFile))
+    {
+        FileView cached = fileUtils->getFileView(cacheFile);
+        if (!cached.isNull() && initWithETCData(cached.getBytes(), cached.getSize()))
+        {
+            _fileType = Format::ETC;
+            return true;
+        }
+    }
+
+    if (!initWithImageData(data.getBytes(), data.getSize()))
+    {
+        return false;
+    }
+
+    Data pkm;
+    if (!encodeToETC1(&pkm))
+    {
+        // has alpha or unsupported format, keep the decoded image
+        return true;
+    }
+
+    // write to a temporary file first, other threads may be transcoding the same image
+    fileUtils->createDirectory(cachePath);
+    std::string tempFile = StringUtils::format("%s.%p.tmp", cacheFile.c_str(), this);
+    if (fileUtils->writeDataToFile(pkm, tempFile) && !fileUtils->renameFile(tempFile, cacheFile))
+    {
+        fileUtils->removeFile(tempFile);
+    }
+
+    unsigned char* decodedData = _data;
+    ssize_t decodedDataLen = _dataLen;
+    Texture2D::PixelFormat decodedFormat = _renderFormat;
+    if (initWithETCData(pkm.getBytes(), pkm.getSize()))
+    {
+        free(decodedData);
+        _fileType = Format::ETC;
+        _hasPremultipliedAlpha = false;
+    }
+    else
+    {
+        _data = decodedData;
+        _dataLen = decodedDataLen;
+        _renderFormat = decodedFormat;
+    }
+
+    return true;
+}
+
+bool Image::encodeToETC1(Data* outData) const
+{
+    if (_data == nullptr || _numberOfMipmaps > 1 || _width <= 0 || _height <= 0)
+    {
+        return false;
+    }
+
+    const unsigned char* rgb = _data;
+    std::vector<unsigned char> opaque;
+    if (_renderFormat == Texture2D::PixelFormat::RGBA8888)
+    {
+        // only opaque images, ETC1 has no alpha channel
+        ssize_t pixels = static_cast<ssize_t>(_width) * _height;
+        opaque.resize(pixels * 3);
+        for (ssize_t i = 0; i < pixels; ++i)
+        {
+            if (_data[i * 4 + 3] != 0xFF)
+            {
+                return false;
+            }
+            opaque[i * 3]     = _data[i * 4];
+            opaque[i * 3 + 1] = _data[i * 4 + 1];
+            opaque[i * 3 + 2] = _data[i * 4 + 2];
+        }
+        rgb = opaque.data();
+    }
+    else if (_renderFormat != Texture2D::PixelFormat::RGB888)
+    {
+        return false;
+    }
+
+    etc1_uint32 encodedSize = etc1_get_encoded_data_size(_width, _height);
+    ssize_t size = ETC_PKM_HEADER_SIZE + encodedSize;
+    unsigned char* pkm = static_cast<unsigned char*>(malloc(size));
+    if (pkm == nullptr)
+    {
+        return false;
+    }
+
+    etc1_pkm_format_header(pkm, _width, _height);
+    if (etc1_encode_image(rgb, _width, _height, 3, _width * 3, pkm + ETC_PKM_HEADER_SIZE) != 0)
+    {
+        free(pkm);
+        return false;
+    }
+
+    outData->fastSet(pkm, size);
+    return true;
+}
+
+void Image::setTranscodedImageCachePath(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(_transcodedImageCachePathMutex);
+    _transcodedImageCachePath = path;
+}
+
+std::string Image::getTranscodedImageCachePath()
+{
+    std::lock_guard<std::mutex> lock(_transcodedImageCachePathMutex);
+    if (_transcodedImageCachePath.empty())
+    {
+        _transcodedImageCachePath = FileUtils::getInstance()->getWritablePath() + "transcoded/";
+    }
+    return _transcodedImageCachePath;
+}
+
 bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
 {
     bool ret = false;
@@ -2454,7 +2624,26 @@ void Image::premultipliedAlpha()
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
     unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
+    int i = 0;
+#ifdef USE_SSE2
+    // same as CC_RGB_PREMULTIPLY_ALPHA, 4 pixels at a time: c * (a + 1) >> 8 fits in 16 bits
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alphaMask = _mm_set1_epi32(0xFF000000);
+    for (int l = _width * _height - 3; i < l; i += 4)
+    {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(fourBytes + i));
+        __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+        __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+        __m128i alphaLo = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)), one);
+        __m128i alphaHi = _mm_add_epi16(_mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)), one);
+        lo = _mm_srli_epi16(_mm_mullo_epi16(lo, alphaLo), 8);
+        hi = _mm_srli_epi16(_mm_mullo_epi16(hi, alphaHi), 8);
+        __m128i result = _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_packus_epi16(lo, hi)), _mm_and_si128(alphaMask, pixels));
+        _mm_storeu_si128((__m128i*)(fourBytes + i), result);
+    }
+#endif
+    for(; i < _width * _height; i++)
     {
         unsigned char* p = _data + i * 4;
         fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
@@ -45,6 +45,8 @@ THE SOFTWARE.
 
 NS_CC_BEGIN
 
+class Data;
+
 /**
  * @addtogroup platform
  * @{
@@ -116,6 +118,24 @@ public:
      */
     static void setPVRImagesHavePremultipliedAlpha(bool haveAlphaPremultiplied);
 
+    /** Enables or disables transcoding of opaque images to ETC1 in initWithImageFileTranscoded().
+     When enabled and the device supports ETC1, opaque PNG/JPG/WebP images are encoded to ETC1 the first time
+     they are loaded, which uses 1/8 of the GPU memory of RGBA8888. The result is cached on disk, keyed by the
+     content of the source file, so the encoding is only done once.
+     Images with alpha and 9-patch images are never transcoded.
+
+     By default it is disabled.
+     */
+    static void setETC1TranscodingEnabled(bool enabled) { ETC1_TRANSCODING_ENABLED = enabled; }
+    static bool isETC1TranscodingEnabled() { return ETC1_TRANSCODING_ENABLED; }
+
+    /** Sets the directory where transcoded images are cached.
+     By default it is FileUtils::getWritablePath() + "transcoded/".
+     @param path The absolute directory path, ending with '/'.
+     */
+    static void setTranscodedImageCachePath(const std::string& path);
+    static std::string getTranscodedImageCachePath();
+
     /**
     @brief Load the image from the specified path.
     @param path   the absolute file path.
@@ -123,6 +143,14 @@ public:
     */
     bool initWithImageFile(const std::string& path);
 
+    /**
+    @brief Load the image like initWithImageFileThreadSafe(), transcoding it to ETC1 if enabled.
+    @param fullpath   the absolute file path.
+    @return true if loaded correctly.
+    @see setETC1TranscodingEnabled
+    */
+    bool initWithImageFileTranscoded(const std::string& fullpath);
+
     /**
     @brief Load image from stream buffer.
     @param data  stream buffer which holds the image data.
@@ -183,6 +211,9 @@ protected:
     bool saveImageToJPG(const std::string& filePath);
     
     void premultipliedAlpha();
+
+    // encode opaque RGB888/RGBA8888 data to a pkm file, returns false if the image can't be transcoded
+    bool encodeToETC1(Data* outData) const;
     
 protected:
     /**
@@ -194,6 +225,10 @@ protected:
      @brief Determine whether we premultiply alpha for png files.
      */
     static bool PNG_PREMULTIPLIED_ALPHA_ENABLED;
+    /**
+     @brief Determine whether opaque images are transcoded to ETC1.
+     */
+    static bool ETC1_TRANSCODING_ENABLED;
     unsigned char *_data;
     ssize_t _dataLen;
     int _width;
@@ -487,6 +487,12 @@ bool FileUtilsApple::createDirectory(const std::string& path) const
         CCLOGERROR("Fail to create directory \"%s\": %s", path.c_str(), [error.localizedDescription UTF8String]);
     }
     
+    if (result)
+    {
+        // Files may have been looked up in the new directory before it existed
+        clearFullPathCache(true);
+    }
+    
     return result;
 }
 
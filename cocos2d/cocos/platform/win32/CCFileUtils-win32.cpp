@@ -395,6 +395,8 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
 
     if (MoveFile(_wOld.c_str(), _wNew.c_str()))
     {
+        // The new file may have been looked up before it existed
+        clearFullPathCache(true);
         return true;
     }
     else
@@ -471,6 +473,8 @@ bool FileUtilsWin32::createDirectory(const std::string& dirPath) const
             }
         }
     }
+    // Files may have been looked up in the new directory before it existed
+    clearFullPathCache(true);
     return true;
 }
 
@@ -481,6 +485,7 @@ bool FileUtilsWin32::removeFile(const std::string &filepath) const
 
     if (DeleteFile(StringUtf8ToWideChar(win32path).c_str()))
     {
+        clearFullPathCache(true);
         return true;
     }
     else
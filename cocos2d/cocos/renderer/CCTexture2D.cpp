@@ -53,6 +53,12 @@ THE SOFTWARE.
     #include "renderer/CCTextureCache.h"
 #endif
 
+//#define USE_SSE2          : SSE2 code used by the RGBA8888 converters
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define USE_SSE2
+#include <emmintrin.h>
+#endif
+
 NS_CC_BEGIN
 
 
@@ -124,6 +130,16 @@ static Texture2D::PixelFormat g_defaultAlphaPixelFormat = Texture2D::PixelFormat
 //////////////////////////////////////////////////////////////////////////
 //convertor function
 
+#ifdef USE_SSE2
+// pack the low 16 bits of each 32 bits lane, _mm_packs_epi32 saturates so sign extend them first
+static inline __m128i packUnsigned32To16(__m128i lo, __m128i hi)
+{
+    lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+    hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+    return _mm_packs_epi32(lo, hi);
+}
+#endif
+
 // IIIIIIII -> RRRRRRRRGGGGGGGGGBBBBBBBB
 void Texture2D::convertI8ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
@@ -314,7 +330,25 @@ void Texture2D::convertRGB888ToRGB565(const unsigned char* data, ssize_t dataLen
 void Texture2D::convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+    ssize_t i = 0;
+#ifdef USE_SSE2
+    for (ssize_t l = dataLen - 31; i < l; i += 32)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(data + i + 16));
+        lo = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x000000F8)), 8),
+            _mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x0000FC00)), 5)),
+            _mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x00F80000)), 19));
+        hi = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x000000F8)), 8),
+            _mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x0000FC00)), 5)),
+            _mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x00F80000)), 19));
+        _mm_storeu_si128((__m128i*)out16, packUnsigned32To16(lo, hi));
+        out16 += 8;
+    }
+#endif
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00FC) << 3     //G
@@ -352,7 +386,20 @@ void Texture2D::convertRGBA8888ToI8(const unsigned char* data, ssize_t dataLen,
 // RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
 void Texture2D::convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
-    for (ssize_t i = 0, l = dataLen -3; i < l; i += 4)
+    ssize_t i = 0;
+#ifdef USE_SSE2
+    for (ssize_t l = dataLen - 63; i < l; i += 64)
+    {
+        __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(data + i)), 24);
+        __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(data + i + 16)), 24);
+        __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(data + i + 32)), 24);
+        __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*)(data + i + 48)), 24);
+        __m128i a = _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3));
+        _mm_storeu_si128((__m128i*)outData, a);
+        outData += 16;
+    }
+#endif
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
     {
         *outData++ = data[i + 3]; //A
     }
@@ -396,7 +443,27 @@ void Texture2D::convertRGB888ToRGBA4444(const unsigned char* data, ssize_t dataL
 void Texture2D::convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 3; i < l; i += 4)
+    ssize_t i = 0;
+#ifdef USE_SSE2
+    for (ssize_t l = dataLen - 31; i < l; i += 32)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(data + i + 16));
+        lo = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x000000F0)), 8),
+            _mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x0000F000)), 4)),
+            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x00F00000)), 16),
+            _mm_srli_epi32(lo, 28)));
+        hi = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x000000F0)), 8),
+            _mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x0000F000)), 4)),
+            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x00F00000)), 16),
+            _mm_srli_epi32(hi, 28)));
+        _mm_storeu_si128((__m128i*)out16, packUnsigned32To16(lo, hi));
+        out16 += 8;
+    }
+#endif
+    for (ssize_t l = dataLen - 3; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F0) << 8    //R
         | (data[i + 1] & 0x00F0) << 4         //G
@@ -422,7 +489,27 @@ void Texture2D::convertRGB888ToRGB5A1(const unsigned char* data, ssize_t dataLen
 void Texture2D::convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
 {
     unsigned short* out16 = (unsigned short*)outData;
-    for (ssize_t i = 0, l = dataLen - 2; i < l; i += 4)
+    ssize_t i = 0;
+#ifdef USE_SSE2
+    for (ssize_t l = dataLen - 31; i < l; i += 32)
+    {
+        __m128i lo = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i hi = _mm_loadu_si128((const __m128i*)(data + i + 16));
+        lo = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x000000F8)), 8),
+            _mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x0000F800)), 5)),
+            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(lo, _mm_set1_epi32(0x00F80000)), 18),
+            _mm_srli_epi32(lo, 31)));
+        hi = _mm_or_si128(_mm_or_si128(
+            _mm_slli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x000000F8)), 8),
+            _mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x0000F800)), 5)),
+            _mm_or_si128(_mm_srli_epi32(_mm_and_si128(hi, _mm_set1_epi32(0x00F80000)), 18),
+            _mm_srli_epi32(hi, 31)));
+        _mm_storeu_si128((__m128i*)out16, packUnsigned32To16(lo, hi));
+        out16 += 8;
+    }
+#endif
+    for (ssize_t l = dataLen - 2; i < l; i += 4)
     {
         *out16++ = (data[i] & 0x00F8) << 8    //R
             | (data[i + 1] & 0x00F8) << 3     //G
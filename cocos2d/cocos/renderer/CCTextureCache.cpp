@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <chrono>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -50,6 +52,9 @@ NS_CC_BEGIN
 
 std::string TextureCache::s_etc1AlphaFileSuffix = "@alpha";
 
+// evicted paths remembered to count the reloads
+static const size_t MAX_EVICTED_TEXTURE_PATHS = 1024;
+
 // implementation TextureCache
 
 void TextureCache::setETC1AlphaFileSuffix(const std::string& suffix)
@@ -68,10 +73,18 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _asyncLoadingThreadCount(1)
+, _asyncUploadBudget(0)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _textureMemoryBudget(0)
+, _evictedTextureBytes(0)
+, _evictedTextureCount(0)
+, _reloadedTextureCount(0)
 {
+    // keep a core for the main thread
+    int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+    _asyncLoadingThreadCount = std::min(std::max(hardwareThreads - 1, 1), 4);
 }
 
 TextureCache::~TextureCache()
@@ -81,7 +94,8 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    for (auto& thread : _loadingThreads)
+        CC_SAFE_DELETE(thread);
 }
 
 void TextureCache::destroyInstance()
@@ -105,27 +119,34 @@ std::string TextureCache::getDescription() const
 struct TextureCache::AsyncStruct
 {
 public:
+    struct Callback
+    {
+        std::string key;
+        std::function<void(Texture2D*)> func;
+    };
+
     AsyncStruct
     ( const std::string& fn,const std::function<void(Texture2D*)>& f,
-      const std::string& key )
-      : filename(fn), callback(f),callbackKey( key ),
-        pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
-    {}
+      const std::string& key, int p )
+      : filename(fn), pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
+        loadSuccess(false), priority(p)
+    {
+        callbacks.push_back({ key, f });
+    }
 
     std::string filename;
-    std::function<void(Texture2D*)> callback;
-    std::string callbackKey;
+    std::vector<Callback> callbacks;
     Image image;
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
     bool loadSuccess;
+    int priority;
 };
 
 /**
  The addImageAsync logic follow the steps:
  - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
+ - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load threads)
  - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
 
  the Critical Area include these members:
@@ -137,59 +158,40 @@ public:
  - image data: new in Load thread, delete in GL thread(by Image instance)
 
  Note:
- - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
+ - all pending AsyncStruct are referenced in _asyncStructs by full path, for unbind and cancel function use.
+ - _requestQueue is sorted by priority, several load threads pop from it, so the responses
+   come back in any order.
 
  How to deal add image many times?
- - At first, this situation is abnormal, we only ensure the logic is correct.
  - If the image has been loaded, the after load image call will return immediately.
- - If the image request is in queue already, there will be more than one request in queue,
- - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
+ - If the image request is pending already, the callback is added to the pending AsyncStruct,
+   so the image is only decoded once.
 
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+ - Convert image to texture is faster than load image from disk, but uploading many big
+ textures in one frame may still cause a hitch, use setAsyncUploadBudget() to spread them
+ over several frames.
 
  Call unbindImageAsync(path) to prevent the call to the callback when the
- texture is loaded.
+ texture is loaded, or cancelImageAsync(path) to drop the request as well.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback)
 {
-    addImageAsync( path, callback, path );
+    addImageAsync( path, callback, path, 0 );
 }
 
-/**
- The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
- 
- the Critical Area include these members:
- - _requestQueue: locked by _requestMutex
- - _responseQueue: locked by _responseMutex
- 
- the object's life time:
- - AsyncStruct: construct and destruct in GL thread
- - image data: new in Load thread, delete in GL thread(by Image instance)
- 
- Note:
- - all AsyncStruct referenced in _asyncStructQueue, for unbind function use.
- 
- How to deal add image many times?
- - At first, this situation is abnormal, we only ensure the logic is correct.
- - If the image has been loaded, the after load image call will return immediately.
- - If the image request is in queue already, there will be more than one request in queue,
- - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
- 
- Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync( path, callback, callbackKey, 0 );
+}
 
+/**
  The callbackKey allows to unbind the callback in cases where the loading of
  path is requested by several sources simultaneously. Each source can then
  unbind the callback independently as needed whilst a call to
  unbindImageAsync(path) would be ambiguous.
  */
-void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, int priority)
 {
     Texture2D *texture = nullptr;
 
@@ -211,12 +213,36 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
         return;
     }
 
+    // already pending, share the decoding
+    auto pending = _asyncStructs.find(fullpath);
+    if (pending != _asyncStructs.end())
+    {
+        AsyncStruct* data = pending->second;
+        data->callbacks.push_back({ callbackKey, callback });
+
+        if (priority > data->priority)
+        {
+            std::unique_lock<std::mutex> ul(_requestMutex);
+            auto queued = std::find(_requestQueue.begin(), _requestQueue.end(), data);
+            if (queued != _requestQueue.end())
+            {
+                _requestQueue.erase(queued);
+                data->priority = priority;
+                pushAsyncRequest(data);
+            }
+        }
+        return;
+    }
+
     // lazy init
-    if (_loadingThread == nullptr)
+    if (_loadingThreads.empty())
     {
-        // create a new thread to load images
         _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+    }
+    while (static_cast<int>(_loadingThreads.size()) < _asyncLoadingThreadCount)
+    {
+        // create new threads to load images
+        _loadingThreads.push_back(new (std::nothrow) std::thread(&TextureCache::loadImage, this));
     }
 
     if (0 == _asyncRefCount)
@@ -228,44 +254,138 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     // generate async struct
     AsyncStruct *data =
-      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+      new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey, priority);
     
     // add async struct into queue
-    _asyncStructQueue.push_back(data);
+    _asyncStructs.emplace(fullpath, data);
     std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
+    pushAsyncRequest(data);
+}
+
+void TextureCache::pushAsyncRequest(AsyncStruct* asyncStruct)
+{
+    // _requestMutex must be locked, keep FIFO order for the same priority
+    auto pos = std::find_if(_requestQueue.begin(), _requestQueue.end(), [asyncStruct](AsyncStruct* queued) {
+        return queued->priority < asyncStruct->priority;
+    });
+    _requestQueue.insert(pos, asyncStruct);
     _sleepCondition.notify_one();
 }
 
-void TextureCache::unbindImageAsync(const std::string& callbackKey)
+void TextureCache::releaseAsyncStruct(AsyncStruct* asyncStruct)
 {
-    if (_asyncStructQueue.empty())
+    delete asyncStruct;
+    --_asyncRefCount;
+
+    if (0 == _asyncRefCount)
     {
-        return;
+        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
     }
+}
 
-    for (auto& asyncStruct : _asyncStructQueue)
+void TextureCache::unbindImageAsync(const std::string& callbackKey)
+{
+    for (auto& asyncStruct : _asyncStructs)
     {
-        if (asyncStruct->callbackKey == callbackKey)
+        for (auto& callback : asyncStruct.second->callbacks)
         {
-            asyncStruct->callback = nullptr;
+            if (callback.key == callbackKey)
+            {
+                callback.func = nullptr;
+            }
         }
     }
 }
 
 void TextureCache::unbindAllImageAsync()
 {
-    if (_asyncStructQueue.empty())
+    for (auto& asyncStruct : _asyncStructs)
+    {
+        for (auto& callback : asyncStruct.second->callbacks)
+        {
+            callback.func = nullptr;
+        }
+    }
+}
+
+void TextureCache::cancelImageAsync(const std::string& callbackKey)
+{
+    std::vector<AsyncStruct*> candidates;
+    for (auto& asyncStruct : _asyncStructs)
+    {
+        bool matched = false;
+        bool bound = false;
+        for (auto& callback : asyncStruct.second->callbacks)
+        {
+            if (callback.key == callbackKey)
+            {
+                callback.func = nullptr;
+                matched = true;
+            }
+            else if (callback.func)
+            {
+                bound = true;
+            }
+        }
+
+        if (matched && !bound)
+        {
+            candidates.push_back(asyncStruct.second);
+        }
+    }
+
+    dropAsyncRequests(candidates);
+}
+
+void TextureCache::cancelAllImageAsync()
+{
+    std::vector<AsyncStruct*> candidates;
+    candidates.reserve(_asyncStructs.size());
+    for (auto& asyncStruct : _asyncStructs)
+    {
+        for (auto& callback : asyncStruct.second->callbacks)
+        {
+            callback.func = nullptr;
+        }
+        candidates.push_back(asyncStruct.second);
+    }
+
+    dropAsyncRequests(candidates);
+}
+
+void TextureCache::dropAsyncRequests(const std::vector<AsyncStruct*>& candidates)
+{
+    if (candidates.empty())
     {
         return;
+    }
 
+    // only requests which are still queued can be dropped, the others are being decoded
+    std::vector<AsyncStruct*> dropped;
+    std::unique_lock<std::mutex> ul(_requestMutex);
+    for (auto& asyncStruct : candidates)
+    {
+        auto queued = std::find(_requestQueue.begin(), _requestQueue.end(), asyncStruct);
+        if (queued != _requestQueue.end())
+        {
+            _requestQueue.erase(queued);
+            dropped.push_back(asyncStruct);
+        }
     }
-    for (auto& asyncStruct : _asyncStructQueue)
+    ul.unlock();
+
+    for (auto& asyncStruct : dropped)
     {
-        asyncStruct->callback = nullptr;
+        _asyncStructs.erase(asyncStruct->filename);
+        releaseAsyncStruct(asyncStruct);
     }
 }
 
+void TextureCache::setAsyncLoadingThreadCount(int count)
+{
+    _asyncLoadingThreadCount = std::max(count, 1);
+}
+
 void TextureCache::loadImage()
 {
     AsyncStruct *asyncStruct = nullptr;
@@ -293,7 +413,7 @@ void TextureCache::loadImage()
         ul.unlock();
 
         // load image
-        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
+        asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileTranscoded(asyncStruct->filename);
 
         // ETC1 ALPHA supports.
         if (asyncStruct->loadSuccess && asyncStruct->image.getFileType() == Image::Format::ETC && !s_etc1AlphaFileSuffix.empty())
@@ -313,6 +433,8 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
+    bool budgetChecked = true;
+    auto startTime = std::chrono::steady_clock::now();
     while (true)
     {
         // pop an AsyncStruct from response queue
@@ -325,10 +447,6 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         {
             asyncStruct = _responseQueue.front();
             _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
         }
         _responseMutex.unlock();
 
@@ -336,6 +454,9 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             break;
         }
 
+        // not pending anymore, requests made from the callbacks start a new load
+        _asyncStructs.erase(asyncStruct->filename);
+
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
         if (it != _textures.end())
@@ -361,6 +482,10 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                 // cache the texture. retain it, since it is added in the map
                 _textures.emplace(asyncStruct->filename, texture);
                 texture->retain();
+                _textureLastUsedFrames[texture] = Director::getInstance()->getTotalFrames();
+                budgetChecked = false;
+                if (_evictedTextures.erase(asyncStruct->filename))
+                    ++_reloadedTextureCount;
 
                 texture->autorelease();
                 // ETC1 ALPHA supports.
@@ -378,20 +503,30 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             }
         }
 
-        // call callback function
-        if (asyncStruct->callback)
+        // call callback functions
+        auto callbacks = std::move(asyncStruct->callbacks);
+        for (auto& callback : callbacks)
         {
-            (asyncStruct->callback)(texture);
+            if (callback.func)
+            {
+                (callback.func)(texture);
+            }
         }
 
         // release the asyncStruct
-        delete asyncStruct;
-        --_asyncRefCount;
+        releaseAsyncStruct(asyncStruct);
+
+        // leave the remaining textures to the next frames
+        if (_asyncUploadBudget > 0 &&
+            std::chrono::duration<float>(std::chrono::steady_clock::now() - startTime).count() >= _asyncUploadBudget)
+        {
+            break;
+        }
     }
 
-    if (0 == _asyncRefCount)
+    if (!budgetChecked)
     {
-        Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
+        enforceTextureMemoryBudget();
     }
 }
 
@@ -410,7 +545,12 @@ Texture2D * TextureCache::addImage(const std::string &path)
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        // protect it from the budget until the caller retains it
+        if (_textureMemoryBudget > 0)
+            _textureLastUsedFrames[texture] = Director::getInstance()->getTotalFrames();
+    }
 
     if (!texture)
     {
@@ -420,7 +560,7 @@ Texture2D * TextureCache::addImage(const std::string &path)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            bool bRet = image->initWithImageFileTranscoded(fullpath);
             CC_BREAK_IF(!bRet);
 
             texture = new (std::nothrow) Texture2D();
@@ -433,6 +573,8 @@ Texture2D * TextureCache::addImage(const std::string &path)
 #endif
                 // texture already retained, no need to re-retain it
                 _textures.emplace(fullpath, texture);
+                if (_evictedTextures.erase(fullpath))
+                    ++_reloadedTextureCount;
 
                 //-- ANDROID ETC1 ALPHA SUPPORTS.
                 std::string alphaFullPath = path + s_etc1AlphaFileSuffix;
@@ -451,6 +593,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
+
+                _textureLastUsedFrames[texture] = Director::getInstance()->getTotalFrames();
+                enforceTextureMemoryBudget();
             }
             else
             {
@@ -499,6 +644,8 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
             if (texture->initWithImage(image))
             {
                 _textures.emplace(key, texture);
+                _textureLastUsedFrames[texture] = Director::getInstance()->getTotalFrames();
+                enforceTextureMemoryBudget();
             }
             else
             {
@@ -548,7 +695,7 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             image = new (std::nothrow) Image();
             CC_BREAK_IF(nullptr == image);
 
-            bool bRet = image->initWithImageFile(fullpath);
+            bool bRet = image->initWithImageFileTranscoded(fullpath);
             CC_BREAK_IF(!bRet);
 
             ret = texture->initWithImage(image);
@@ -568,6 +715,8 @@ void TextureCache::removeAllTextures()
         texture.second->release();
     }
     _textures.clear();
+    _textureLastUsedFrames.clear();
+    _evictedTextures.clear();
 }
 
 void TextureCache::removeUnusedTextures()
@@ -577,6 +726,7 @@ void TextureCache::removeUnusedTextures()
         if (tex->getReferenceCount() == 1) {
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
+            _textureLastUsedFrames.erase(tex);
             tex->release();
             it = _textures.erase(it);
         }
@@ -587,6 +737,92 @@ void TextureCache::removeUnusedTextures()
     }
 }
 
+void TextureCache::setTextureMemoryBudget(size_t bytes)
+{
+    _textureMemoryBudget = bytes;
+    enforceTextureMemoryBudget();
+}
+
+size_t TextureCache::getTextureMemoryUsage() const
+{
+    size_t totalBytes = 0;
+    for (auto& texture : _textures)
+    {
+        Texture2D* tex = texture.second;
+        totalBytes += static_cast<size_t>(tex->getPixelsWide()) * tex->getPixelsHigh() * tex->getBitsPerPixelForFormat() / 8;
+    }
+    return totalBytes;
+}
+
+void TextureCache::enforceTextureMemoryBudget()
+{
+    if (0 == _textureMemoryBudget)
+    {
+        return;
+    }
+
+    // textures retained outside the cache are in use, refresh their frame
+    unsigned int frame = Director::getInstance()->getTotalFrames();
+    std::unordered_map<Texture2D*, unsigned int> lastUsedFrames;
+    lastUsedFrames.reserve(_textures.size());
+
+    typedef std::pair<unsigned int, decltype(_textures)::iterator> Candidate;
+    std::vector<Candidate> candidates;
+    size_t totalBytes = 0;
+
+    for (auto it = _textures.begin(); it != _textures.end(); ++it)
+    {
+        Texture2D* tex = it->second;
+        totalBytes += static_cast<size_t>(tex->getPixelsWide()) * tex->getPixelsHigh() * tex->getBitsPerPixelForFormat() / 8;
+
+        auto found = _textureLastUsedFrames.find(tex);
+        unsigned int lastUsed = (found == _textureLastUsedFrames.end() || tex->getReferenceCount() > 1) ? frame : found->second;
+        lastUsedFrames[tex] = lastUsed;
+
+        if (tex->getReferenceCount() == 1 && lastUsed != frame)
+        {
+            candidates.push_back(Candidate(lastUsed, it));
+        }
+    }
+    _textureLastUsedFrames.swap(lastUsedFrames);
+
+    if (totalBytes <= _textureMemoryBudget)
+    {
+        return;
+    }
+
+    // least recently used first
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.first < b.first;
+    });
+
+    for (auto& candidate : candidates)
+    {
+        if (totalBytes <= _textureMemoryBudget)
+        {
+            break;
+        }
+
+        Texture2D* tex = candidate.second->second;
+        size_t bytes = static_cast<size_t>(tex->getPixelsWide()) * tex->getPixelsHigh() * tex->getBitsPerPixelForFormat() / 8;
+        CCLOG("cocos2d: TextureCache: evicting texture: %s", candidate.second->first.c_str());
+
+        totalBytes -= bytes;
+        _evictedTextureBytes += bytes;
+        ++_evictedTextureCount;
+        // only tells reloads apart, forgetting old evictions merely misses some of them
+        if (_evictedTextures.size() >= MAX_EVICTED_TEXTURE_PATHS)
+        {
+            _evictedTextures.clear();
+        }
+        _evictedTextures.insert(candidate.second->first);
+        _textureLastUsedFrames.erase(tex);
+
+        tex->release();
+        _textures.erase(candidate.second);
+    }
+}
+
 void TextureCache::removeTexture(Texture2D* texture)
 {
     if (!texture)
@@ -596,6 +832,7 @@ void TextureCache::removeTexture(Texture2D* texture)
 
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         if (it->second == texture) {
+            _textureLastUsedFrames.erase(texture);
             it->second->release();
             it = _textures.erase(it);
             break;
@@ -616,6 +853,7 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     }
 
     if (it != _textures.end()) {
+        _textureLastUsedFrames.erase(it->second);
         it->second->release();
         _textures.erase(it);
     }
@@ -662,9 +900,12 @@ void TextureCache::waitForQuit()
     // notify sub thread to quick
     std::unique_lock<std::mutex> ul(_requestMutex);
     _needQuit = true;
-    _sleepCondition.notify_one();
+    _sleepCondition.notify_all();
     ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    for (auto& thread : _loadingThreads)
+    {
+        if (thread) thread->join();
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -701,6 +942,17 @@ std::string TextureCache::getCachedTextureInfo() const
     snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
 
+    if (_textureMemoryBudget > 0 || _evictedTextureCount > 0)
+    {
+        snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache budget: %.2f MB, resident %.2f MB, evicted %u textures for %.2f MB, reloaded %u\n",
+            _textureMemoryBudget / (1024.0f*1024.0f),
+            totalBytes / (1024.0f*1024.0f),
+            _evictedTextureCount,
+            _evictedTextureBytes / (1024.0f*1024.0f),
+            _reloadedTextureCount);
+        buffer += buftmp;
+    }
+
     return buffer;
 }
 
@@ -35,7 +35,9 @@ THE SOFTWARE.
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "renderer/CCTexture2D.h"
@@ -127,6 +129,16 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Same as addImageAsync(path, callback, callbackKey), with a decode priority.
+     * Requests with a higher priority are decoded first, requests with the same priority are decoded in order.
+     * Use a high priority for textures that are needed on screen right away.
+     * Requesting a path that is already being loaded doesn't decode it twice, the callback is attached to the
+     * pending request and the request is promoted to the higher priority.
+     * @param priority The decode priority, 0 by default.
+     * @since v3.17
+     */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, int priority);
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -140,6 +152,38 @@ public:
      */
     virtual void unbindAllImageAsync();
 
+    /** Cancel a pending image asynchronous load.
+     * The callback is unbound like unbindImageAsync(). Besides, if no other callback is bound to the same image
+     * and the image isn't being decoded yet, the request is dropped and the image won't be added to the cache.
+     * @param callbackKey The key the callback was bound with, the related/absolute path of the file image by default.
+     * @since v3.17
+     */
+    void cancelImageAsync(const std::string &callbackKey);
+
+    /** Cancel all pending image asynchronous loads which haven't started decoding yet and unbind all callbacks.
+     * @since v3.17
+     */
+    void cancelAllImageAsync();
+
+    /** Set the number of threads used to decode images for addImageAsync.
+     * By default it is the number of hardware threads minus one, between 1 and 4.
+     * Raising the count starts the extra threads on the next asynchronous load. Lowering it doesn't stop
+     * threads which are already running, so it should be set before the first asynchronous load.
+     * @param count The number of decode threads, at least 1.
+     * @since v3.17
+     */
+    void setAsyncLoadingThreadCount(int count);
+    int getAsyncLoadingThreadCount() const { return _asyncLoadingThreadCount; }
+
+    /** Set the time the main thread may spend per frame creating textures of asynchronously loaded images.
+     * Once the budget is used up, the remaining images are uploaded on the next frames.
+     * At least one image is uploaded per frame.
+     * @param seconds The budget in seconds, 0 means unlimited (default).
+     * @since v3.17
+     */
+    void setAsyncUploadBudget(float seconds) { _asyncUploadBudget = seconds; }
+    float getAsyncUploadBudget() const { return _asyncUploadBudget; }
+
     /** Returns a Texture2D object given an Image.
     * If the image was not previously loaded, it will create a new Texture2D object and it will return it.
     * Otherwise it will return a reference of a previously loaded image.
@@ -196,6 +240,21 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Set the memory budget of the cached textures.
+    * When a texture is added and the cache goes over the budget, the least recently used textures which
+    * are only retained by the cache are removed until it fits again. Textures used in the current frame
+    * are never removed. A removed texture is loaded again by the next addImage or addImageAsync call.
+    * @param bytes The budget in bytes, 0 means unlimited (default).
+    * @since v3.17
+    */
+    void setTextureMemoryBudget(size_t bytes);
+    size_t getTextureMemoryBudget() const { return _textureMemoryBudget; }
+
+    /** Returns the memory used by the cached textures, in bytes.
+    * @since v3.17
+    */
+    size_t getTextureMemoryUsage() const;
+
     //Wait for texture cache to quit before destroy instance.
     /**Called by director, please do not called outside.*/
     void waitForQuit();
@@ -224,13 +283,21 @@ private:
     void addImageAsyncCallBack(float dt);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
+    void enforceTextureMemoryBudget();
 public:
 protected:
     struct AsyncStruct;
-    
-    std::thread* _loadingThread;
 
-    std::deque<AsyncStruct*> _asyncStructQueue;
+    void pushAsyncRequest(AsyncStruct* asyncStruct);
+    void releaseAsyncStruct(AsyncStruct* asyncStruct);
+    void dropAsyncRequests(const std::vector<AsyncStruct*>& candidates);
+
+    std::vector<std::thread*> _loadingThreads;
+    int _asyncLoadingThreadCount;
+    float _asyncUploadBudget;
+
+    // pending requests keyed by full path, only accessed from GL thread
+    std::unordered_map<std::string, AsyncStruct*> _asyncStructs;
     std::deque<AsyncStruct*> _requestQueue;
     std::deque<AsyncStruct*> _responseQueue;
 
@@ -245,6 +312,14 @@ protected:
 
     std::unordered_map<std::string, Texture2D*> _textures;
 
+    size_t _textureMemoryBudget;
+    // frame in which the texture was last seen retained outside the cache
+    std::unordered_map<Texture2D*, unsigned int> _textureLastUsedFrames;
+    std::unordered_set<std::string> _evictedTextures;
+    size_t _evictedTextureBytes;
+    unsigned int _evictedTextureCount;
+    unsigned int _reloadedTextureCount;
+
     static std::string s_etc1AlphaFileSuffix;
 };
 
@@ -0,0 +1,12 @@
+const char* ccParticleGPU_frag = R"(
+
+in vec4 v_fragmentColor;
+in vec2 v_texCoord;
+
+out vec4 fragColor;
+
+void main()
+{
+    fragColor = v_fragmentColor * texture(CC_Texture0, v_texCoord);
+}
+)";
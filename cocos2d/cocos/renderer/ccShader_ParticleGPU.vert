@@ -0,0 +1,41 @@
+const char* ccParticleGPU_vert = R"(
+
+// Expands one particle of a ParticleSystemGPU into a quad, one instance per particle.
+
+uniform vec2 u_origin;
+uniform mat4 u_startTransform;
+uniform vec4 u_texRect;
+uniform float u_opacityModifyRGB;
+
+in vec4 a_position;
+in vec4 a_particlePosDir;
+in vec4 a_particleColor;
+in vec4 a_particleSizeRot;
+in vec4 a_particleLife;
+in vec2 a_particleStart;
+
+out vec4 v_fragmentColor;
+out vec2 v_texCoord;
+
+void main()
+{
+    // dead particles collapse into a degenerate quad
+    float size = a_particleLife.x > 0.0 ? a_particleSizeRot.x : 0.0;
+
+    // same as ParticleSystemQuad::fillParticleQuads for the three position types
+    vec2 startInNode = (u_startTransform * vec4(a_particleStart, 0.0, 1.0)).xy;
+    vec2 center = a_particlePosDir.xy - (u_origin - startInNode);
+
+    float r = - radians(a_particleSizeRot.z);
+    float cr = cos(r);
+    float sr = sin(r);
+    vec2 corner = a_position.xy * size;
+    vec2 position = vec2(corner.x * cr - corner.y * sr, corner.x * sr + corner.y * cr) + center;
+    gl_Position = CC_MVPMatrix * vec4(position, 0.0, 1.0);
+
+    vec4 color = clamp(a_particleColor, 0.0, 1.0);
+    color.rgb *= mix(1.0, color.a, u_opacityModifyRGB);
+    v_fragmentColor = color;
+    v_texCoord = mix(u_texRect.xy, u_texRect.zw, a_position.xy + 0.5);
+}
+)";
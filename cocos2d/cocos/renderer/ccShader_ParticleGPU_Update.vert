@@ -0,0 +1,59 @@
+const char* ccParticleGPU_Update_vert = R"(
+
+// Steps one particle of a ParticleSystemGPU, the output is captured with transform feedback.
+// The layout mirrors ParticleData: see GPUParticle in CCParticleSystemGPU.cpp.
+
+uniform float u_dt;
+uniform vec2 u_gravity;
+uniform float u_yCoordFlipped;
+uniform int u_radiusMode;
+
+in vec4 a_particlePosDir;
+in vec4 a_particleColor;
+in vec4 a_particleDeltaColor;
+in vec4 a_particleSizeRot;
+in vec4 a_particleLife;
+in vec2 a_particleStart;
+
+out vec4 v_posDir;
+out vec4 v_color;
+out vec4 v_deltaColor;
+out vec4 v_sizeRot;
+out vec4 v_life;
+out vec2 v_start;
+
+void main()
+{
+    vec4 posDir = a_particlePosDir;
+    if (u_radiusMode == 0)
+    {
+        // xy: position, zw: direction, life.yz: radial and tangential acceleration
+        vec2 radial = vec2(0.0, 0.0);
+        if (posDir.x != 0.0 || posDir.y != 0.0)
+        {
+            radial = normalize(posDir.xy);
+        }
+        vec2 tangential = vec2(-radial.y, radial.x) * a_particleLife.z;
+        radial *= a_particleLife.y;
+        posDir.zw += (radial + tangential + u_gravity) * u_dt;
+        posDir.xy += posDir.zw * u_dt * u_yCoordFlipped;
+    }
+    else
+    {
+        // xy: position, zw: angle and radius, life.yz: degrees per second and delta radius
+        posDir.z += a_particleLife.y * u_dt;
+        posDir.w += a_particleLife.z * u_dt;
+        posDir.x = - cos(posDir.z) * posDir.w;
+        posDir.y = - sin(posDir.z) * posDir.w * u_yCoordFlipped;
+    }
+
+    v_posDir = posDir;
+    v_color = a_particleColor + a_particleDeltaColor * u_dt;
+    v_deltaColor = a_particleDeltaColor;
+    v_sizeRot = vec4(max(0.0, a_particleSizeRot.x + a_particleSizeRot.y * u_dt), a_particleSizeRot.y,
+                     a_particleSizeRot.z + a_particleSizeRot.w * u_dt, a_particleSizeRot.w);
+    v_life = vec4(a_particleLife.x - u_dt, a_particleLife.yzw);
+    v_start = a_particleStart;
+    gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+}
+)";
@@ -98,6 +98,9 @@ NS_CC_BEGIN
 #include "renderer/ccShader_ETC1AS_PositionTextureGray.frag"
 
 #include "renderer/ccShader_Position.vert"
+#include "renderer/ccShader_ParticleGPU_Update.vert"
+#include "renderer/ccShader_ParticleGPU.vert"
+#include "renderer/ccShader_ParticleGPU.frag"
 #include "renderer/ccShader_LayerRadialGradient.frag"
 
 NS_CC_END
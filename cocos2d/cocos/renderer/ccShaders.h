@@ -98,6 +98,10 @@ extern CC_DLL const GLchar* ccETC1ASPositionTextureColor_frag;
 extern CC_DLL const GLchar* ccETC1ASPositionTextureGray_frag;
 
 extern CC_DLL const GLchar* ccPosition_vert;
+// GLSL 1.40, see ParticleSystemGPU
+extern CC_DLL const GLchar* ccParticleGPU_Update_vert;
+extern CC_DLL const GLchar* ccParticleGPU_vert;
+extern CC_DLL const GLchar* ccParticleGPU_frag;
 extern CC_DLL const GLchar* ccShader_LayerRadialGradient_frag;
 
 NS_CC_END
@@ -48,6 +48,10 @@ NS_CC_EXT_BEGIN
 
 #define DEFAULT_CONNECTION_TIMEOUT 45
 
+// large archives are fetched as parallel byte ranges that survive an interruption
+#define DEFAULT_CHUNKS_PER_FILE 4
+#define MIN_SIZE_OF_CHUNK (1024 * 1024)
+
 #define SAVE_POINT_INTERVAL 0.1
 
 const std::string AssetsManagerEx::VERSION_ID = "@version";
@@ -88,7 +92,9 @@ AssetsManagerEx::AssetsManagerEx(const std::string& manifestUrl, const std::stri
     {
         static_cast<uint32_t>(_maxConcurrentTask),
         DEFAULT_CONNECTION_TIMEOUT,
-        ".tmp"
+        ".tmp",
+        DEFAULT_CHUNKS_PER_FILE,
+        MIN_SIZE_OF_CHUNK
     };
     _downloader = std::shared_ptr<network::Downloader>(new network::Downloader(hints));
     _downloader->onTaskError = std::bind(&AssetsManagerEx::onError, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, std::placeholders::_4);